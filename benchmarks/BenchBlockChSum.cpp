@@ -0,0 +1,72 @@
+/* Microbenchmark of block checksum kernels
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "../src/reader/BlockChSum.h"
+
+using OpenLogReplicator::BlockChSum;
+
+namespace {
+    constexpr uint64_t ROUNDS = 256;
+
+    typedef void (* ChSumKernel)(const uint8_t* buffer, uint64_t blockSize, uint64_t blocks, uint64_t* bitmap);
+
+    uint64_t speedMbs(ChSumKernel kernel, const uint8_t* buffer, uint64_t blockSize, uint64_t blocks, uint64_t* bitmap) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t round = 0; round < ROUNDS; ++round)
+            kernel(buffer, blockSize, blocks, bitmap);
+        auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        if (time <= 0)
+            return 0;
+        return ROUNDS * blocks * blockSize / static_cast<uint64_t>(time);
+    }
+}
+
+int main() {
+    static constexpr uint64_t BLOCK_SIZES[] = {512, 1024, 4096};
+    int ret = 0;
+
+    std::cout << "kernel: " << BlockChSum::getKernelName() << std::endl;
+    if (BlockChSum::getRejectedKernelName() != nullptr)
+        std::cout << "rejected by self-test: " << BlockChSum::getRejectedKernelName() << std::endl;
+
+    for (uint64_t blockSize: BLOCK_SIZES) {
+        // One read buffer of blocks, at most BLOCKS_MAX of them
+        uint64_t blocks = BlockChSum::BLOCKS_MAX * 512 / blockSize;
+        std::vector<uint8_t> buffer(blocks * blockSize);
+        std::vector<uint64_t> bitmapScalar(BlockChSum::BITMAP_SIZE);
+        std::vector<uint64_t> bitmapKernel(BlockChSum::BITMAP_SIZE);
+        BlockChSum::fillBlocks(buffer.data(), blockSize, blocks);
+
+        uint64_t scalar = speedMbs(BlockChSum::checkScalar, buffer.data(), blockSize, blocks, bitmapScalar.data());
+        uint64_t kernel = speedMbs(BlockChSum::check, buffer.data(), blockSize, blocks, bitmapKernel.data());
+        bool same = (bitmapScalar == bitmapKernel);
+        if (!same)
+            ret = 1;
+
+        std::cout << "block size " << blockSize << ": scalar " << scalar << " MB/s, " << BlockChSum::getKernelName() << " " << kernel <<
+                " MB/s, results " << (same ? "equal" : "DIFFERENT") << std::endl;
+    }
+
+    return ret;
+}
@@ -0,0 +1,145 @@
+/* Output of transactions formatted by the workers compared with the sequential output
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../src/builder/Builder.h"
+#include "../src/builder/BuilderBuffer.h"
+#include "../src/builder/BuilderJson.h"
+#include "../src/common/Ctx.h"
+#include "../src/common/exception/RuntimeException.h"
+#ifdef LINK_LIBRARY_PROTOBUF
+#include "../src/builder/BuilderProtobuf.h"
+#endif /* LINK_LIBRARY_PROTOBUF */
+
+using OpenLogReplicator::Builder;
+using OpenLogReplicator::BuilderChunkHeader;
+using OpenLogReplicator::BuilderJson;
+using OpenLogReplicator::BuilderMessageHeader;
+using OpenLogReplicator::BuilderSettings;
+using OpenLogReplicator::Ctx;
+#ifdef LINK_LIBRARY_PROTOBUF
+using OpenLogReplicator::BuilderProtobuf;
+#endif /* LINK_LIBRARY_PROTOBUF */
+
+namespace {
+    constexpr uint64_t LWNS = 2000;
+    constexpr uint64_t TRANSACTIONS = 12;
+    constexpr uint64_t WORKERS = 3;
+
+    enum class Format {JSON, PROTOBUF};
+
+    Builder* newBuilder(Ctx* ctx, Format format __attribute__((unused))) {
+        BuilderSettings formats{};
+        Builder* builder;
+#ifdef LINK_LIBRARY_PROTOBUF
+        if (format == Format::PROTOBUF)
+            builder = new BuilderProtobuf(ctx, nullptr, nullptr, formats, Builder::UNKNOWN_TYPE_HIDE, 0);
+        else
+#endif /* LINK_LIBRARY_PROTOBUF */
+            builder = new BuilderJson(ctx, nullptr, nullptr, formats, Builder::UNKNOWN_TYPE_HIDE, 0);
+        builder->initialize();
+        return builder;
+    }
+
+    // The messages carrying c_idx which can be created without redo log records, one to three per transaction
+    void formatTransaction(Builder* builder, typeScn lwnScn, uint64_t transaction) {
+        for (uint64_t i = 0; i <= transaction % 3; ++i)
+            builder->processCheckpoint(lwnScn, static_cast<typeSeq>(transaction), 0, i * 512, false);
+    }
+
+    // Every 4th transaction is not formatted by a worker, like a system transaction
+    bool isParallel(uint64_t transaction) {
+        return transaction % 4 != 3;
+    }
+
+    // The output as read by the writer: header fields and data of all messages
+    std::string output(Builder* builder, uint64_t& messages) {
+        std::string out;
+        messages = 0;
+        for (BuilderChunkHeader* chunk = builder->firstBuilderQueue(); chunk != nullptr; chunk = chunk->next) {
+            uint64_t pos = 0;
+            while (pos < chunk->size) {
+                const auto* header = reinterpret_cast<const BuilderMessageHeader*>(chunk->data + pos);
+                pos += sizeof(struct BuilderMessageHeader);
+                out += std::to_string(header->id) + "/" + std::to_string(header->lwnScn) + "/" + std::to_string(header->lwnIdx) + "/" +
+                       std::to_string(header->scn) + "/" + std::to_string(header->flags) + ":";
+                out.append(reinterpret_cast<const char*>(chunk->data + pos), header->size);
+                out += "\n";
+                pos += (header->size + 7) & 0xFFFFFFFFFFFFFFF8;
+                ++messages;
+            }
+        }
+        return out;
+    }
+
+    bool check(Ctx* ctx, Format format, const char* name) {
+        Builder* sequential = newBuilder(ctx, format);
+        Builder* parallel = newBuilder(ctx, format);
+        std::vector<Builder*> workers;
+        for (uint64_t i = 0; i < WORKERS; ++i)
+            workers.push_back(newBuilder(ctx, format));
+
+        for (uint64_t lwn = 1; lwn <= LWNS; ++lwn) {
+            for (uint64_t transaction = 0; transaction < TRANSACTIONS; ++transaction)
+                formatTransaction(sequential, lwn, transaction);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t worker = 0;
+        for (uint64_t lwn = 1; lwn <= LWNS; ++lwn) {
+            for (uint64_t transaction = 0; transaction < TRANSACTIONS; ++transaction) {
+                if (isParallel(transaction)) {
+                    // The worker keeps the LWN index of its previous transaction, like after formatting a transaction of another LWN
+                    Builder* formatBuilder = workers[worker++ % WORKERS];
+                    formatTransaction(formatBuilder, lwn, transaction);
+                    parallel->appendMessages(formatBuilder);
+                } else
+                    formatTransaction(parallel, lwn, transaction);
+            }
+        }
+        auto time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+        uint64_t sequentialMessages;
+        uint64_t parallelMessages;
+        bool identical = output(sequential, sequentialMessages) == output(parallel, parallelMessages);
+        std::cout << name << ": " << sequentialMessages << "/" << parallelMessages << " messages in " << LWNS << " LWNs, " <<
+                (identical ? "identical" : "DIFFERENT") << ", formatted with workers in " << time << " ms" << std::endl;
+
+        for (Builder* formatBuilder: workers)
+            delete formatBuilder;
+        delete parallel;
+        delete sequential;
+        return identical;
+    }
+}
+
+int main() {
+    Ctx ctx;
+    ctx.initialize(32, 256, 16);
+
+    bool identical = check(&ctx, Format::JSON, "json");
+#ifdef LINK_LIBRARY_PROTOBUF
+    identical = check(&ctx, Format::PROTOBUF, "protobuf") && identical;
+#endif /* LINK_LIBRARY_PROTOBUF */
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+/* Microbenchmark of ordering of LWN members
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../src/common/Ctx.h"
+#include "../src/parser/Parser.h"
+
+using OpenLogReplicator::Ctx;
+using OpenLogReplicator::LwnMember;
+using OpenLogReplicator::LwnMembersManager;
+
+namespace {
+    // Close to MAX_RECORDS_IN_LWN of LwnMembersManager
+    constexpr uint64_t MEMBERS = 1048000;
+    constexpr uint64_t ROUNDS = 3;
+
+    // The binary heap used before ordered runs were detected, as a baseline
+    class HeapBaseline {
+    public:
+        explicit HeapBaseline(uint64_t size) :
+                members(size + 1),
+                records(0) {
+        }
+
+        void add(LwnMember* member) {
+            uint64_t pos = ++records;
+            while (pos > 1 && *member < *members[pos / 2]) {
+                members[pos] = members[pos / 2];
+                pos = pos / 2;
+            }
+            members[pos] = member;
+        }
+
+        LwnMember* getMin() {
+            return members[1];
+        }
+
+        void dropMin() {
+            uint64_t pos = 1;
+            while (true) {
+                uint64_t left = pos * 2;
+                uint64_t right = pos * 2 + 1;
+                if (left < records && *members[left] < *members[records]) {
+                    if (right < records && *members[right] < *members[left]) {
+                        members[pos] = members[right];
+                        pos = right;
+                    } else {
+                        members[pos] = members[left];
+                        pos = left;
+                    }
+                } else if (right < records && *members[right] < *members[records]) {
+                    members[pos] = members[right];
+                    pos = right;
+                } else
+                    break;
+            }
+            members[pos] = members[records];
+            --records;
+        }
+
+        void reset() {
+            records = 0;
+        }
+
+    private:
+        std::vector<LwnMember*> members;
+        uint64_t records;
+    };
+
+    void setKey(LwnMember& member, uint64_t key) {
+        member.data = nullptr;
+        member.size = 0;
+        member.scn = 1;
+        member.subScn = 0;
+        member.block = static_cast<typeBlk>(key / 16);
+        member.offset = (key % 16) * 32;
+    }
+
+    // Layouts of arrival order, the keys are 0..MEMBERS-1
+    std::vector<uint64_t> layoutSorted() {
+        std::vector<uint64_t> keys(MEMBERS);
+        for (uint64_t i = 0; i < MEMBERS; ++i)
+            keys[i] = i;
+        return keys;
+    }
+
+    // Ordered with 8 short groups arriving late, each one starts a new run
+    std::vector<uint64_t> layoutFewTails() {
+        static constexpr uint64_t TAILS = 8;
+        static constexpr uint64_t TAIL_SIZE = 64;
+        std::vector<uint64_t> keys;
+        std::vector<uint64_t> tails;
+        for (uint64_t i = 0; i < MEMBERS; ++i) {
+            if ((i / TAIL_SIZE) % (MEMBERS / TAIL_SIZE / TAILS) == 1 && tails.size() < TAILS * TAIL_SIZE)
+                tails.push_back(i);
+            else
+                keys.push_back(i);
+        }
+        keys.insert(keys.end(), tails.begin(), tails.end());
+        return keys;
+    }
+
+    // Four ordered strands written one after another
+    std::vector<uint64_t> layoutStrands() {
+        static constexpr uint64_t STRANDS = 4;
+        std::vector<uint64_t> keys;
+        for (uint64_t strand = 0; strand < STRANDS; ++strand)
+            for (uint64_t i = strand; i < MEMBERS; i += STRANDS)
+                keys.push_back(i);
+        return keys;
+    }
+
+    std::vector<uint64_t> layoutRandom() {
+        std::vector<uint64_t> keys = layoutSorted();
+        std::mt19937_64 random(1);
+        std::shuffle(keys.begin(), keys.end(), random);
+        return keys;
+    }
+
+    template<typename Manager>
+    uint64_t timeMs(Manager& manager, std::vector<LwnMember>& members, bool& ordered) {
+        uint64_t best = UINT64_MAX;
+        ordered = true;
+        for (uint64_t round = 0; round < ROUNDS; ++round) {
+            manager.reset();
+            auto start = std::chrono::steady_clock::now();
+            for (auto& member: members)
+                manager.add(&member);
+
+            const LwnMember* last = nullptr;
+            for (uint64_t i = 0; i < members.size(); ++i) {
+                const LwnMember* member = manager.getMin();
+                if (last != nullptr && *member < *last)
+                    ordered = false;
+                last = member;
+                manager.dropMin();
+            }
+            auto time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+            best = std::min(best, static_cast<uint64_t>(time));
+        }
+        return best;
+    }
+
+    class RunsManager {
+    public:
+        explicit RunsManager(Ctx* ctx) :
+                manager(new LwnMembersManager(ctx)) {
+        }
+
+        void add(LwnMember* member) {
+            manager->addLwnMember(member);
+        }
+
+        LwnMember* getMin() {
+            return manager->getMinLwnMember();
+        }
+
+        void dropMin() {
+            manager->dropMin();
+        }
+
+        void reset() {
+            manager->reset();
+        }
+
+    private:
+        std::unique_ptr<LwnMembersManager> manager;
+    };
+}
+
+int main() {
+    Ctx ctx;
+    ctx.initialize(16, 16, 4);
+
+    HeapBaseline heap(MEMBERS);
+    RunsManager runs(&ctx);
+    struct Layout {
+        const char* name;
+        std::vector<uint64_t> (* make)();
+    };
+    const Layout layouts[] = {
+            {"sorted", layoutSorted},
+            {"few tails", layoutFewTails},
+            {"4 strands", layoutStrands},
+            {"random", layoutRandom}
+    };
+
+    int ret = 0;
+    std::cout << "members: " << MEMBERS << ", best of " << ROUNDS << std::endl;
+    for (const auto& layout: layouts) {
+        std::vector<uint64_t> keys = layout.make();
+        std::vector<LwnMember> members(keys.size());
+        for (uint64_t i = 0; i < keys.size(); ++i)
+            setKey(members[i], keys[i]);
+
+        bool heapOrdered;
+        bool runsOrdered;
+        uint64_t heapMs = timeMs(heap, members, heapOrdered);
+        uint64_t runsMs = timeMs(runs, members, runsOrdered);
+        if (!heapOrdered || !runsOrdered)
+            ret = 1;
+
+        std::cout << layout.name << ": heap " << heapMs << " ms, runs " << runsMs << " ms" << (heapOrdered && runsOrdered ? "" : ", NOT ORDERED") <<
+                std::endl;
+    }
+
+    return ret;
+}
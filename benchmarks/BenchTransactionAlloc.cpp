@@ -0,0 +1,133 @@
+/* Count of heap allocations per committed transaction
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#include "../src/common/Ctx.h"
+#include "../src/parser/Transaction.h"
+#include "../src/parser/TransactionBuffer.h"
+
+using OpenLogReplicator::Ctx;
+using OpenLogReplicator::Transaction;
+using OpenLogReplicator::TransactionBuffer;
+using OpenLogReplicator::typeXid;
+
+namespace {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<bool> counting{false};
+}
+
+// Every heap allocation of the program goes through these
+void* operator new(std::size_t size) {
+    if (counting.load(std::memory_order_relaxed))
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+    // Transactions open at the same time, each commit is followed by a begin of a new one
+    constexpr uint64_t OPEN = 512;
+    constexpr uint64_t WARMUP = 100000;
+    constexpr uint64_t COMMITS = 1000000;
+
+    // The transaction bookkeeping of Parser::appendToTransactionBegin, appendToTransactionCommit and the flush thread
+    uint64_t nextXid = 0;
+    uint64_t position = 0;
+
+    typeXid begin(TransactionBuffer& transactionBuffer) {
+        // Undo segment and slot differ for all open transactions
+        uint64_t n = nextXid++;
+        typeXid xid(static_cast<typeUsn>(n % 1024), static_cast<typeSlt>((n / 1024) % 64), static_cast<typeSqn>(n / 65536 + 1));
+        Transaction* transaction = transactionBuffer.findTransaction(nullptr, xid, 0, false, true, false);
+        transaction->begin = true;
+        transactionBuffer.setTransactionPosition(transaction, 1, 1, position);
+        position += 512;
+        return xid;
+    }
+
+    void commit(TransactionBuffer& transactionBuffer, typeXid xid) {
+        transactionBuffer.dropLobIds(xid, 0);
+        Transaction* transaction = transactionBuffer.findTransaction(nullptr, xid, 0, true, false, false);
+        transaction->commitScn = position;
+        transactionBuffer.dropTransaction(xid, 0);
+        transaction->purge(&transactionBuffer);
+        transactionBuffer.releaseTransaction(transaction);
+    }
+
+    uint64_t run(TransactionBuffer& transactionBuffer, std::vector<typeXid>& open, uint64_t commits) {
+        uint64_t start = allocations.load();
+        for (uint64_t i = 0; i < commits; ++i) {
+            uint64_t slot = i % OPEN;
+            commit(transactionBuffer, open[slot]);
+            open[slot] = begin(transactionBuffer);
+        }
+        return allocations.load() - start;
+    }
+}
+
+int main() {
+    Ctx ctx;
+    ctx.initialize(16, 16, 4);
+    auto transactionBuffer = new TransactionBuffer(&ctx);
+
+    counting = true;
+    std::vector<typeXid> open(OPEN);
+    for (uint64_t i = 0; i < OPEN; ++i)
+        open[i] = begin(*transactionBuffer);
+    uint64_t warmup = run(*transactionBuffer, open, WARMUP);
+    uint64_t steady = run(*transactionBuffer, open, COMMITS);
+    counting = false;
+
+    std::cout << "open transactions: " << OPEN << std::endl;
+    std::cout << "warm-up: " << warmup << " allocations in " << WARMUP << " commits" << std::endl;
+    std::cout << "steady state: " << steady << " allocations in " << COMMITS << " commits, " <<
+            static_cast<double>(steady) / static_cast<double>(COMMITS) << " per commit" << std::endl;
+
+    for (typeXid xid: open)
+        commit(*transactionBuffer, xid);
+    delete transactionBuffer;
+    return 0;
+}
@@ -19,6 +19,7 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 
 #include <algorithm>
 #include <cerrno>
+#include <dirent.h>
 #include <fcntl.h>
 #include <regex>
 #include <sys/file.h>
@@ -216,9 +217,11 @@ namespace OpenLogReplicator {
 
             if (!ctx->disableChecksSet(Ctx::DISABLE_CHECKS_JSON_TAGS)) {
                 static const char* sourceNames[] = {"alias", "memory", "name", "reader", "flags", "skip-rollback", "state", "debug",
-                                                    "transaction-max-mb", "metrics", "format", "redo-read-sleep-us", "arch-read-sleep-us",
-                                                    "arch-read-tries", "redo-verify-delay-us", "refresh-interval-us", "arch",
-                                                    "filter", nullptr};
+                                                    "transaction-max-mb", "metrics", "format", "redo-read-sleep-us", "arch-prefetch-logs",
+                                                    "arch-read-sleep-us", "arch-read-tries", "arch-watch", "redo-verify-delay-us",
+                                                    "redo-verify-mode", "refresh-interval-us", "arch", "filter", "decode-workers", "flush-queue",
+                                                    "format-workers",
+                                                    nullptr};
                 Ctx::checkJsonFields(configFileName, sourceJson, sourceNames);
             }
 
@@ -234,7 +237,8 @@ namespace OpenLogReplicator {
                 const rapidjson::Value& memoryJson = Ctx::getJsonFieldO(configFileName, sourceJson, "memory");
 
                 if (!ctx->disableChecksSet(Ctx::DISABLE_CHECKS_JSON_TAGS)) {
-                    static const char* memoryNames[] = {"min-mb", "max-mb", "read-buffer-max-mb", nullptr};
+                    static const char* memoryNames[] = {"min-mb", "max-mb", "read-buffer-max-mb", "huge-pages", "spill-path", "spill-max-mb",
+                                                        "compress-idle-s", nullptr};
                     Ctx::checkJsonFields(configFileName, memoryJson, memoryNames);
                 }
 
@@ -269,6 +273,44 @@ namespace OpenLogReplicator {
                                                             std::to_string(readBufferMax) + ", expected: at least: " +
                                                             std::to_string(Ctx::MEMORY_CHUNK_SIZE_MB * 2));
                 }
+
+                if (memoryJson.HasMember("huge-pages")) {
+                    const char* hugePages = Ctx::getJsonFieldS(configFileName, Ctx::JSON_PARAMETER_LENGTH, memoryJson, "huge-pages");
+                    if (strcmp(hugePages, "none") == 0)
+                        ctx->hugePages = Ctx::HUGE_PAGES_NONE;
+                    else if (strcmp(hugePages, "2mb") == 0)
+                        ctx->hugePages = Ctx::HUGE_PAGES_2MB;
+                    else if (strcmp(hugePages, "1gb") == 0)
+                        ctx->hugePages = Ctx::HUGE_PAGES_1GB;
+                    else
+                        throw ConfigurationException(30001, "bad JSON, invalid \"huge-pages\" value: " + std::string(hugePages) +
+                                                            ", expected: one of {\"none\", \"2mb\", \"1gb\"}");
+                }
+
+                if (memoryJson.HasMember("spill-path")) {
+                    ctx->spillPath = Ctx::getJsonFieldS(configFileName, Ctx::MAX_PATH_LENGTH, memoryJson, "spill-path");
+                    DIR* dir = opendir(ctx->spillPath.c_str());
+                    if (dir == nullptr)
+                        throw RuntimeException(10012, "directory: " + ctx->spillPath + " - can't read");
+                    closedir(dir);
+                }
+
+                if (memoryJson.HasMember("spill-max-mb")) {
+                    uint64_t spillMaxMb = Ctx::getJsonFieldU64(configFileName, memoryJson, "spill-max-mb");
+                    if (ctx->spillPath.empty())
+                        throw ConfigurationException(30001, "bad JSON, invalid \"spill-max-mb\" value: " + std::to_string(spillMaxMb) +
+                                                            ", expected: not set when \"spill-path\" is not set");
+                    ctx->spillSizeMax = spillMaxMb * 1024 * 1024;
+                }
+
+                if (memoryJson.HasMember("compress-idle-s")) {
+                    ctx->compressIdleS = Ctx::getJsonFieldU64(configFileName, memoryJson, "compress-idle-s");
+#ifndef LINK_LZ4
+                    if (ctx->compressIdleS > 0)
+                        throw ConfigurationException(30001, "bad JSON, invalid \"compress-idle-s\" value: " +
+                                                            std::to_string(ctx->compressIdleS) + ", expected: 0 since the code is not compiled");
+#endif /* LINK_LZ4 */
+                }
             }
 
             const char* name = Ctx::getJsonFieldS(configFileName, Ctx::JSON_PARAMETER_LENGTH, sourceJson, "name");
@@ -278,6 +320,7 @@ namespace OpenLogReplicator {
                 static const char* readerNames[] = {"disable-checks", "start-scn", "start-seq", "start-time-rel", "start-time",
                                                     "con-id", "type", "redo-copy-path", "db-timezone", "host-timezone", "log-timezone",
                                                     "user", "password", "server", "redo-log", "path-mapping", "log-archive-format",
+                                                    "read-mode", "read-queue-depth", "redo-copy-fsync", "redo-copy-compress", "batch-workers",
                                                     nullptr};
                 Ctx::checkJsonFields(configFileName, readerJson, readerNames);
             }
@@ -340,7 +383,7 @@ namespace OpenLogReplicator {
 
                 if (!ctx->disableChecksSet(Ctx::DISABLE_CHECKS_JSON_TAGS)) {
                     static const char* stateNames[] = {"type", "path", "interval-s", "interval-mb", "keep-checkpoints",
-                                                       "schema-force-interval", nullptr};
+                                                       "schema-force-interval", "transactions", "transactions-max-mb", nullptr};
                     Ctx::checkJsonFields(configFileName, stateJson, stateNames);
                 }
 
@@ -366,6 +409,16 @@ namespace OpenLogReplicator {
 
                 if (stateJson.HasMember("schema-force-interval"))
                     ctx->schemaForceInterval = Ctx::getJsonFieldU64(configFileName, stateJson, "schema-force-interval");
+
+                if (stateJson.HasMember("transactions")) {
+                    ctx->checkpointTransactions = Ctx::getJsonFieldU64(configFileName, stateJson, "transactions");
+                    if (ctx->checkpointTransactions > 1)
+                        throw ConfigurationException(30001, "bad JSON, invalid \"transactions\" value: " +
+                                                            std::to_string(ctx->checkpointTransactions) + ", expected: one of {0, 1}");
+                }
+
+                if (stateJson.HasMember("transactions-max-mb"))
+                    ctx->checkpointTransactionsMaxMb = Ctx::getJsonFieldU64(configFileName, stateJson, "transactions-max-mb");
             }
 
             const char* debugOwner = nullptr;
@@ -682,6 +735,59 @@ namespace OpenLogReplicator {
             if (sourceJson.HasMember("redo-read-sleep-us"))
                 ctx->redoReadSleepUs = Ctx::getJsonFieldU64(configFileName, sourceJson, "redo-read-sleep-us");
 
+            if (sourceJson.HasMember("arch-prefetch-logs")) {
+                ctx->archPrefetchLogs = Ctx::getJsonFieldU64(configFileName, sourceJson, "arch-prefetch-logs");
+                if (ctx->archPrefetchLogs > 100)
+                    throw ConfigurationException(30001, "bad JSON, invalid \"arch-prefetch-logs\" value: " +
+                                                        std::to_string(ctx->archPrefetchLogs) + ", expected: one of: {0 .. 100}");
+            }
+
+            if (sourceJson.HasMember("decode-workers")) {
+                ctx->decodeWorkers = Ctx::getJsonFieldU64(configFileName, sourceJson, "decode-workers");
+                if (ctx->decodeWorkers > 64)
+                    throw ConfigurationException(30001, "bad JSON, invalid \"decode-workers\" value: " +
+                                                        std::to_string(ctx->decodeWorkers) + ", expected: one of: {0 .. 64}");
+            }
+
+            if (sourceJson.HasMember("flush-queue")) {
+                ctx->flushQueue = Ctx::getJsonFieldU64(configFileName, sourceJson, "flush-queue");
+                if (ctx->flushQueue > 4096)
+                    throw ConfigurationException(30001, "bad JSON, invalid \"flush-queue\" value: " +
+                                                        std::to_string(ctx->flushQueue) + ", expected: one of: {0 .. 4096}");
+            }
+
+            std::vector<Builder*> formatBuilders;
+            if (sourceJson.HasMember("format-workers")) {
+                ctx->formatWorkers = Ctx::getJsonFieldU64(configFileName, sourceJson, "format-workers");
+                if (ctx->formatWorkers > 64)
+                    throw ConfigurationException(30001, "bad JSON, invalid \"format-workers\" value: " +
+                                                        std::to_string(ctx->formatWorkers) + ", expected: one of: {0 .. 64}");
+                // The workers are driven by the flush thread
+                if (ctx->formatWorkers > 0 && ctx->flushQueue == 0)
+                    throw ConfigurationException(30001, "bad JSON, invalid \"format-workers\" value: " +
+                                                        std::to_string(ctx->formatWorkers) + ", expected: 0 when \"flush-queue\" is 0");
+                // Columns listed only once per table depend on the order of the transactions
+                if (ctx->formatWorkers > 0 && (builderFormats.schemaFormat & Builder::SCHEMA_FORMAT_FULL) != 0 &&
+                    (builderFormats.schemaFormat & Builder::SCHEMA_FORMAT_REPEATED) == 0)
+                    throw ConfigurationException(30001, "bad JSON, invalid \"format-workers\" value: " +
+                                                        std::to_string(ctx->formatWorkers) + ", expected: 0 when \"schema\" format is " +
+                                                        std::to_string(builderFormats.schemaFormat));
+            }
+
+            // Builders of the same format, private to the workers
+            for (uint64_t num = 0; num < ctx->formatWorkers; ++num) {
+                Builder* formatBuilder = nullptr;
+                if (strcmp("json", formatType) == 0)
+                    formatBuilder = new BuilderJson(ctx, locales, metadata, builderFormats, unknownType, flushBuffer);
+#ifdef LINK_LIBRARY_PROTOBUF
+                else
+                    formatBuilder = new BuilderProtobuf(ctx, locales, metadata, builderFormats, unknownType, flushBuffer);
+#endif /* LINK_LIBRARY_PROTOBUF */
+                builders.push_back(formatBuilder);
+                formatBuilder->initialize();
+                formatBuilders.push_back(formatBuilder);
+            }
+
             if (sourceJson.HasMember("arch-read-sleep-us"))
                 ctx->archReadSleepUs = Ctx::getJsonFieldU64(configFileName, sourceJson, "arch-read-sleep-us");
 
@@ -692,15 +798,86 @@ namespace OpenLogReplicator {
                                                         std::to_string(ctx->archReadTries) + ", expected: one of: {1 .. 1000000000}");
             }
 
+            if (sourceJson.HasMember("arch-watch")) {
+                ctx->archWatch = Ctx::getJsonFieldU64(configFileName, sourceJson, "arch-watch");
+                if (ctx->archWatch > 1)
+                    throw ConfigurationException(30001, "bad JSON, invalid \"arch-watch\" value: " + std::to_string(ctx->archWatch) +
+                                                        ", expected: one of {0, 1}");
+            }
+
             if (sourceJson.HasMember("redo-verify-delay-us"))
                 ctx->redoVerifyDelayUs = Ctx::getJsonFieldU64(configFileName, sourceJson, "redo-verify-delay-us");
 
+            if (sourceJson.HasMember("redo-verify-mode")) {
+                const char* redoVerifyMode = Ctx::getJsonFieldS(configFileName, Ctx::JSON_PARAMETER_LENGTH, sourceJson, "redo-verify-mode");
+                if (strcmp(redoVerifyMode, "full") == 0)
+                    ctx->redoVerifyMode = Ctx::REDO_VERIFY_MODE_FULL;
+                else if (strcmp(redoVerifyMode, "header") == 0)
+                    ctx->redoVerifyMode = Ctx::REDO_VERIFY_MODE_HEADER;
+                else
+                    throw ConfigurationException(30001, "bad JSON, invalid \"redo-verify-mode\" value: " + std::string(redoVerifyMode) +
+                                                        ", expected: one of {\"full\", \"header\"}");
+            }
+
             if (sourceJson.HasMember("refresh-interval-us"))
                 ctx->refreshIntervalUs = Ctx::getJsonFieldU64(configFileName, sourceJson, "refresh-interval-us");
 
             if (readerJson.HasMember("redo-copy-path"))
                 ctx->redoCopyPath = Ctx::getJsonFieldS(configFileName, Ctx::MAX_PATH_LENGTH, readerJson, "redo-copy-path");
 
+            if (readerJson.HasMember("redo-copy-fsync")) {
+                const char* redoCopyFsync = Ctx::getJsonFieldS(configFileName, Ctx::JSON_PARAMETER_LENGTH, readerJson, "redo-copy-fsync");
+                if (strcmp(redoCopyFsync, "none") == 0)
+                    ctx->redoCopyFsync = Ctx::REDO_COPY_FSYNC_NONE;
+                else if (strcmp(redoCopyFsync, "close") == 0)
+                    ctx->redoCopyFsync = Ctx::REDO_COPY_FSYNC_CLOSE;
+                else if (strcmp(redoCopyFsync, "batch") == 0)
+                    ctx->redoCopyFsync = Ctx::REDO_COPY_FSYNC_BATCH;
+                else
+                    throw ConfigurationException(30001, "bad JSON, invalid \"redo-copy-fsync\" value: " + std::string(redoCopyFsync) +
+                                                        ", expected: one of {\"none\", \"close\", \"batch\"}");
+            }
+
+            if (readerJson.HasMember("redo-copy-compress")) {
+                ctx->redoCopyCompress = Ctx::getJsonFieldU64(configFileName, readerJson, "redo-copy-compress");
+                if (ctx->redoCopyCompress > 9)
+                    throw ConfigurationException(30001, "bad JSON, invalid \"redo-copy-compress\" value: " +
+                                                        std::to_string(ctx->redoCopyCompress) + ", expected: one of {0 .. 9}");
+#ifndef LINK_ZLIB
+                if (ctx->redoCopyCompress > 0)
+                    throw ConfigurationException(30001, "bad JSON, invalid \"redo-copy-compress\" value: " +
+                                                        std::to_string(ctx->redoCopyCompress) + ", expected: 0 since the code is not compiled");
+#endif /* LINK_ZLIB */
+            }
+
+            if (readerJson.HasMember("read-mode")) {
+                const char* readMode = Ctx::getJsonFieldS(configFileName, Ctx::JSON_PARAMETER_LENGTH, readerJson, "read-mode");
+                if (strcmp(readMode, "pread") == 0)
+                    ctx->readMode = Ctx::READ_MODE_PREAD;
+                else if (strcmp(readMode, "uring") == 0) {
+#ifdef LINK_URING
+                    ctx->readMode = Ctx::READ_MODE_URING;
+#else
+                    throw ConfigurationException(30001, "bad JSON, invalid \"read-mode\" value: " + std::string(readMode) +
+                                                        ", expected: not \"uring\" since the code is not compiled");
+#endif /* LINK_URING */
+                } else if (strcmp(readMode, "mmap") == 0) {
+                    if (strcmp(readerType, "offline") != 0 && strcmp(readerType, "batch") != 0)
+                        throw ConfigurationException(30001, "bad JSON, invalid \"read-mode\" value: " + std::string(readMode) +
+                                                            ", expected: not \"mmap\" for \"" + std::string(readerType) + "\" reader type");
+                    ctx->readMode = Ctx::READ_MODE_MMAP;
+                } else
+                    throw ConfigurationException(30001, "bad JSON, invalid \"read-mode\" value: " + std::string(readMode) +
+                                                        ", expected: one of {\"pread\", \"uring\", \"mmap\"}");
+            }
+
+            if (readerJson.HasMember("read-queue-depth")) {
+                ctx->readQueueDepth = Ctx::getJsonFieldU64(configFileName, readerJson, "read-queue-depth");
+                if (ctx->readQueueDepth < 1 || ctx->readQueueDepth > 256)
+                    throw ConfigurationException(30001, "bad JSON, invalid \"read-queue-depth\" value: " +
+                                                        std::to_string(ctx->readQueueDepth) + ", expected: one of {1 .. 256}");
+            }
+
             if (readerJson.HasMember("db-timezone")) {
                 const char* dbTimezone = Ctx::getJsonFieldS(configFileName, Ctx::JSON_PARAMETER_LENGTH, readerJson, "db-timezone");
                 if (!ctx->parseTimezone(dbTimezone, ctx->dbTimezone))
@@ -777,9 +954,19 @@ namespace OpenLogReplicator {
                     throw ConfigurationException(30001, "bad JSON, invalid \"start-time-rel\" value: " + std::to_string(startTimeRel) +
                                                         ", expected: unset when reader \"type\" is \"offline\"");
 
+                uint64_t batchWorkers = 1;
+                if (readerJson.HasMember("batch-workers")) {
+                    batchWorkers = Ctx::getJsonFieldU64(configFileName, readerJson, "batch-workers");
+                    // Every worker needs at least two read buffers
+                    uint64_t batchWorkersMax = std::max(static_cast<uint64_t>(1), ctx->readBufferMax / 2);
+                    if (batchWorkers < 1 || batchWorkers > batchWorkersMax)
+                        throw ConfigurationException(30001, "bad JSON, invalid \"batch-workers\" value: " + std::to_string(batchWorkers) +
+                                                            ", expected: one of {1 .. " + std::to_string(batchWorkersMax) + "}");
+                }
+
                 archGetLog = Replicator::archGetLogList;
                 replicator = new ReplicatorBatch(ctx, archGetLog, builder, metadata,
-                                                 transactionBuffer, alias, name);
+                                                 transactionBuffer, alias, name, batchWorkers);
                 replicator->initialize();
 
                 const rapidjson::Value& redoLogBatchArrayJson = Ctx::getJsonFieldA(configFileName, readerJson, "redo-log");
@@ -792,6 +979,9 @@ namespace OpenLogReplicator {
                 throw ConfigurationException(30001, "bad JSON, invalid \"type\" value: " + std::string(readerType) +
                                                     ", expected: one of {\"online\", \"offline\", \"batch\"}");
 
+            for (Builder* formatBuilder: formatBuilders)
+                replicator->addFormatBuilder(formatBuilder);
+
             if (sourceJson.HasMember("filter")) {
                 const rapidjson::Value& filterJson = Ctx::getJsonFieldO(configFileName, sourceJson, "filter");
 
@@ -2307,6 +2307,88 @@ namespace OpenLogReplicator {
         bufferManager.releaseBuffers(maxId);
     }
 
+    void Builder::appendRelocated(const BuilderMessageHeader* header, const uint8_t* data, uint64_t size) {
+        uint64_t idxPos;
+        uint64_t idxLength;
+        locateIdx(header, data, size, idxPos, idxLength);
+
+        append(reinterpret_cast<const char*>(data), idxPos);
+        appendIdx();
+        append(reinterpret_cast<const char*>(data + idxPos + idxLength), size - idxPos - idxLength);
+    }
+
+    void Builder::appendMessages(Builder* formatBuilder) {
+        commitScn = formatBuilder->commitScn;
+        lastXid = formatBuilder->lastXid;
+
+        BuilderChunkHeader* chunk = &formatBuilder->bufferManager.begin();
+        uint64_t pos = 0;
+        while (true) {
+            if (pos == chunk->size) {
+                if (chunk->next == nullptr)
+                    break;
+                chunk = chunk->next;
+                pos = 0;
+                continue;
+            }
+
+            const auto* header = reinterpret_cast<const BuilderMessageHeader*>(chunk->data + pos);
+            pos += sizeof(struct BuilderMessageHeader);
+            uint64_t size = header->size;
+            uint64_t size8 = (size + 7) & 0xFFFFFFFFFFFFFFF8;
+
+            if (lwnScn != header->lwnScn) {
+                lwnScn = header->lwnScn;
+                lwnIdx = 0;
+            }
+            builderBegin(header->scn, header->sequence, header->obj, header->flags);
+
+            // The c_idx value is placed in the message after the index in the LWN is taken, it is replaced when it differs
+            bool relocate = header->lwnIdx + 1 != lwnIdx;
+            if (pos + size8 <= OUTPUT_BUFFER_DATA_SIZE) {
+                if (relocate)
+                    appendRelocated(header, chunk->data + pos, size);
+                else
+                    append(reinterpret_cast<const char*>(chunk->data + pos), size);
+                pos += size8;
+            } else {
+                // The message is split between many chunks, the same way as read by the writer
+                relocateBuffer.clear();
+                uint64_t copied = 0;
+                while (size > copied) {
+                    uint64_t toCopy = size - copied;
+                    bool nextChunk = toCopy > chunk->size - pos;
+                    if (nextChunk)
+                        toCopy = chunk->size - pos;
+
+                    if (relocate)
+                        relocateBuffer.append(reinterpret_cast<const char*>(chunk->data + pos), toCopy);
+                    else
+                        append(reinterpret_cast<const char*>(chunk->data + pos), toCopy);
+
+                    if (nextChunk) {
+                        chunk = chunk->next;
+                        pos = 0;
+                    } else
+                        pos += (toCopy + 7) & 0xFFFFFFFFFFFFFFF8;
+                    copied += toCopy;
+                }
+                if (relocate)
+                    appendRelocated(header, reinterpret_cast<const uint8_t*>(relocateBuffer.data()), size);
+            }
+            builderCommit(false);
+        }
+
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            condNoWriterWork.notify_all();
+        }
+        unconfirmedSize = 0;
+
+        formatBuilder->bufferManager.rewind();
+        formatBuilder->unconfirmedSize = 0;
+    }
+
     void Builder::sleepForWriterWork(uint64_t queueSize, uint64_t nanoseconds) {
         if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
             ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "Builder:sleepForWriterWork");
@@ -131,6 +131,7 @@ namespace OpenLogReplicator {
         uint64_t id;
         uint64_t num;
         uint64_t maxMessageMb;      // Maximum message size able to handle by writer
+        std::string relocateBuffer; // Message split between chunks, copied to replace the c_idx value
         bool newTran;
         bool compressedBefore;
         bool compressedAfter;
@@ -252,6 +253,7 @@ namespace OpenLogReplicator {
             message.header->obj = obj;
             message.header->pos = 0;
             message.header->flags = flags;
+            message.header->idxPos = 0;
             message.header->data = bufferManager.end().data + bufferManager.end().size + sizeof(struct BuilderMessageHeader);
         };
 
@@ -1145,6 +1147,19 @@ namespace OpenLogReplicator {
         virtual void processDdl(typeScn scn, typeSeq sequence, time_t timestamp, const OracleTable* table, typeObj obj, typeDataObj dataObj, uint16_t type,
                                 uint16_t seq, const char* sql, uint64_t sqlSize) = 0;
         virtual void processBeginMessage(typeScn scn, typeSeq sequence, time_t timestamp) = 0;
+
+        /// @brief Find the c_idx value in a message formatted by a builder of the same format.
+        /// @param header header of the message
+        /// @param data message data
+        /// @param size size of the message data
+        /// @param pos position of the value, or where it would be placed if it is not stored
+        /// @param length length of the value, 0 if not stored
+        virtual void locateIdx(const BuilderMessageHeader* header, const uint8_t* data, uint64_t size, uint64_t& pos,
+                               uint64_t& length) const = 0;
+
+        /// @brief Append the c_idx value of the current message, as it is placed in the message header.
+        virtual void appendIdx() = 0;
+        void appendRelocated(const BuilderMessageHeader* header, const uint8_t* data, uint64_t size);
         bool parseXml(const XmlCtx* xmlCtx, const uint8_t* data, uint64_t size, uint64_t offset);
 
     public:
@@ -1284,6 +1299,13 @@ namespace OpenLogReplicator {
         virtual void processCommit(typeScn scn, typeSeq sequence, time_t timestamp, bool rollback = false) = 0;
         virtual void processCheckpoint(typeScn scn, typeSeq sequence, time_t timestamp, uint64_t offset, bool redo) = 0;
         void releaseBuffers(uint64_t maxId);
+
+        /// @brief Copy the messages of a transaction formatted by another builder to the output queue and empty its buffer.
+        ///
+        /// The messages get the next message ids and LWN indexes of this builder, as if they were formatted here,
+        /// the c_idx value in the message data is replaced when it differs.
+        /// @param formatBuilder builder of the same format, not connected to a writer
+        void appendMessages(Builder* formatBuilder);
         void sleepForWriterWork(uint64_t queueSize, uint64_t nanoseconds);
         void wakeUp();
 
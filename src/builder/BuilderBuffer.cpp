@@ -62,6 +62,26 @@ namespace OpenLogReplicator {
         }
     }
 
+    void BuilderBuffer::rewind() {
+        // Only for buffers not read by a writer, the first chunk is reused for the next messages
+        BuilderChunkHeader* chunk;
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            chunk = firstChunk->next;
+            firstChunk->next = nullptr;
+            firstChunk->size = 0;
+            firstChunk->start = 0;
+            lastChunk = firstChunk;
+        }
+
+        while (chunk != nullptr) {
+            BuilderChunkHeader* nextChunk = chunk->next;
+            ctx->freeMemoryChunk(Ctx::MEMORY_MODULE_BUILDER, reinterpret_cast<uint8_t*>(chunk), true);
+            chunk = nextChunk;
+            --chunksAllocated;
+        }
+    }
+
     const BuilderChunkHeader& BuilderBuffer::begin() const {
         return *reinterpret_cast<BuilderChunkHeader*>(firstChunk);
     }
@@ -49,6 +49,7 @@ namespace OpenLogReplicator {
         typeObj obj;
         uint16_t pos;
         uint16_t flags;
+        uint32_t idxPos;     // Position of the c_idx value in the data, if stored by the format
 
         std::string ToString() const {
             return "id: " + std::to_string(id) + " size: " + std::to_string(size.load()) + " scn: " + std::to_string(scn) 
@@ -77,6 +78,7 @@ namespace OpenLogReplicator {
         void initialize();
         void expand(bool, BuilderMessage&);
         void releaseBuffers(uint64_t);
+        void rewind();
 
         const BuilderChunkHeader& begin() const;
         BuilderChunkHeader& begin();
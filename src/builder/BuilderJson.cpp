@@ -498,6 +498,18 @@ namespace OpenLogReplicator {
         }
     }
 
+    void BuilderJson::locateIdx(const BuilderMessageHeader* header, const uint8_t* data, uint64_t size, uint64_t& pos,
+                                uint64_t& length) const {
+        pos = header->idxPos;
+        length = 0;
+        while (pos + length < size && data[pos + length] >= '0' && data[pos + length] <= '9')
+            ++length;
+    }
+
+    void BuilderJson::appendIdx() {
+        appendDec(lwnIdx);
+    }
+
     void BuilderJson::processCommit(typeScn scn, typeSeq sequence, time_t timestamp, bool rollback) {
         // Skip empty transaction
         if (newTran) {
@@ -238,6 +238,7 @@ namespace OpenLogReplicator {
             append(R"("c_scn":)", sizeof(R"("c_scn":)") - 1);
             appendDec(lwnScn);
             append(R"(,"c_idx":)", sizeof(R"(,"c_idx":)") - 1);
+            message.header->idxPos = static_cast<uint32_t>(message.size + message.position - sizeof(struct BuilderMessageHeader));
             appendDec(lwnIdx);
 
             if (showXid) {
@@ -688,6 +689,9 @@ namespace OpenLogReplicator {
         virtual void processDdl(typeScn scn, typeSeq sequence, time_t timestamp, const OracleTable* table, typeObj obj, typeDataObj dataObj, uint16_t type,
                                 uint16_t seq, const char* sql, uint64_t sqlSize) override;
         virtual void processBeginMessage(typeScn scn, typeSeq sequence, time_t timestamp) override;
+        virtual void locateIdx(const BuilderMessageHeader* header, const uint8_t* data, uint64_t size, uint64_t& pos,
+                               uint64_t& length) const override;
+        virtual void appendIdx() override;
 
     public:
         BuilderJson(Ctx* newCtx, Locales* newLocales, Metadata* newMetadata, BuilderSettings newFormats, uint64_t newUnknownType, uint64_t newFlushBuffer);
@@ -17,6 +17,9 @@ You should have received a copy of the GNU General Public License
 along with OpenLogReplicator; see the file LICENSE;  If not see
 <http://www.gnu.org/licenses/>.  */
 
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
+
 #include "../common/OracleColumn.h"
 #include "../common/OracleTable.h"
 #include "../common/typeRowId.h"
@@ -278,6 +281,44 @@ namespace OpenLogReplicator {
         GOOGLE_PROTOBUF_VERIFY_VERSION;
     }
 
+    void BuilderProtobuf::locateIdx(const BuilderMessageHeader* header __attribute__((unused)), const uint8_t* data, uint64_t size,
+                                    uint64_t& pos, uint64_t& length) const {
+        // The fields are serialized in the order of their numbers, c_idx equal to 0 is not stored
+        google::protobuf::io::CodedInputStream input(data, static_cast<int>(size));
+        pos = size;
+        length = 0;
+        while (true) {
+            auto fieldPos = static_cast<uint64_t>(input.CurrentPosition());
+            uint32_t tag = input.ReadTag();
+            if (tag == 0)
+                return;
+
+            int field = google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag);
+            if (field >= pb::RedoResponse::kCIdxFieldNumber) {
+                pos = fieldPos;
+                if (field == pb::RedoResponse::kCIdxFieldNumber) {
+                    uint64_t value;
+                    if (unlikely(!input.ReadVarint64(&value)))
+                        throw RedoLogException(50070, "output buffer - invalid message, c_idx not read");
+                    length = static_cast<uint64_t>(input.CurrentPosition()) - pos;
+                }
+                return;
+            }
+
+            if (unlikely(!google::protobuf::internal::WireFormatLite::SkipField(&input, tag)))
+                throw RedoLogException(50070, "output buffer - invalid message, field " + std::to_string(field) + " not read");
+        }
+    }
+
+    void BuilderProtobuf::appendIdx() {
+        if (lwnIdx == 0)
+            return;
+
+        uint8_t buffer[16];
+        uint8_t* end = google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(pb::RedoResponse::kCIdxFieldNumber, lwnIdx, buffer);
+        append(reinterpret_cast<const char*>(buffer), static_cast<uint64_t>(end - buffer));
+    }
+
     void BuilderProtobuf::processCommit(typeScn scn, typeSeq sequence, time_t timestamp, bool rollback) {
         // Skip empty transaction
         if (newTran) {
@@ -431,6 +431,9 @@ namespace OpenLogReplicator {
         virtual void processDdl(typeScn scn, typeSeq sequence, time_t timestamp, const OracleTable* table, typeObj obj, typeDataObj dataObj, uint16_t type,
                                 uint16_t seq, const char* sql, uint64_t sqlSize) override;
         void processBeginMessage(typeScn scn, typeSeq sequence, time_t timestamp) override;
+        virtual void locateIdx(const BuilderMessageHeader* header, const uint8_t* data, uint64_t size, uint64_t& pos,
+                               uint64_t& length) const override;
+        virtual void appendIdx() override;
 
     public:
         BuilderProtobuf(Ctx* newCtx, Locales* newLocales, Metadata* newMetadata, BuilderSettings newFormats, uint64_t newUnknownType,
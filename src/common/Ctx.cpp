@@ -19,12 +19,15 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 
 #define GLOBALS 1
 
+#include <cerrno>
 #include <cstdlib>
 #include <csignal>
+#include <cstring>
 #include <execinfo.h>
 #include <iostream>
 #include <set>
 #include <string>
+#include <sys/mman.h>
 #include <unistd.h>
 
 #include "ClockHW.h"
@@ -35,6 +38,16 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #include "exception/RuntimeException.h"
 #include "metrics/Metrics.h"
 
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
 uint64_t OLR_LOCALES = OpenLogReplicator::Ctx::OLR_LOCALES_TIMESTAMP;
 
 namespace OpenLogReplicator {
@@ -76,6 +89,11 @@ namespace OpenLogReplicator {
             memoryChunksMax(0),
             memoryChunksHWM(0),
             memoryChunksReusable(0),
+            hugePagesMemory(nullptr),
+            hugePagesMemorySize(0),
+            hugePagesChunks(nullptr),
+            hugePagesChunksNum(0),
+            hugePagesChunksUsed(0),
             mainThread(pthread_self()),
             metrics(nullptr),
             clock(nullptr),
@@ -92,19 +110,34 @@ namespace OpenLogReplicator {
             checkpointIntervalS(600),
             checkpointIntervalMb(500),
             checkpointKeep(100),
+            checkpointTransactions(0),
+            checkpointTransactionsMaxMb(1024),
             schemaForceInterval(20),
             redoReadSleepUs(50000),
             redoVerifyDelayUs(0),
+            redoVerifyMode(REDO_VERIFY_MODE_FULL),
             archReadSleepUs(10000000),
             archReadTries(10),
+            archPrefetchLogs(0),
+            archWatch(1),
             refreshIntervalUs(10000000),
+            readMode(READ_MODE_PREAD),
+            readQueueDepth(8),
+            hugePages(HUGE_PAGES_NONE),
+            decodeWorkers(0),
+            flushQueue(0),
+            formatWorkers(0),
             pollIntervalUs(100000),
             queueSize(65536),
             dumpPath("."),
+            redoCopyFsync(REDO_COPY_FSYNC_NONE),
+            redoCopyCompress(0),
             stopLogSwitches(0),
             stopCheckpoints(0),
             stopTransactions(0),
             transactionSizeMax(0),
+            spillSizeMax(0),
+            compressIdleS(0),
             logLevel(3),
             trace(0),
             flags(0),
@@ -131,10 +164,16 @@ namespace OpenLogReplicator {
 
         while (memoryChunksAllocated > 0) {
             --memoryChunksAllocated;
-            free(memoryChunks[memoryChunksAllocated]);
+            if (!isHugePagesChunk(memoryChunks[memoryChunksAllocated]))
+                free(memoryChunks[memoryChunksAllocated]);
             memoryChunks[memoryChunksAllocated] = nullptr;
         }
 
+        if (hugePagesMemory != nullptr) {
+            munmap(hugePagesMemory, hugePagesMemorySize);
+            hugePagesMemory = nullptr;
+        }
+
         if (memoryChunks != nullptr) {
             delete[] memoryChunks;
             memoryChunks = nullptr;
@@ -661,7 +700,16 @@ namespace OpenLogReplicator {
         bufferSizeMax = readBufferMax * MEMORY_CHUNK_SIZE;
 
         memoryChunks = new uint8_t* [memoryMaxMb / MEMORY_CHUNK_SIZE_MB];
-        for (uint64_t i = 0; i < memoryChunksMin; ++i) {
+        if (hugePages != HUGE_PAGES_NONE && memoryChunksMin > 0)
+            hugePagesAllocate();
+
+        for (uint64_t i = 0; i < hugePagesChunksNum; ++i) {
+            memoryChunks[i] = hugePagesChunks + i * MEMORY_CHUNK_SIZE;
+            ++memoryChunksAllocated;
+            ++memoryChunksFree;
+        }
+
+        for (uint64_t i = hugePagesChunksNum; i < memoryChunksMin; ++i) {
             memoryChunks[i] = reinterpret_cast<uint8_t*>(aligned_alloc(MEMORY_ALIGNMENT, MEMORY_CHUNK_SIZE));
             if (unlikely(memoryChunks[i] == nullptr))
                 throw RuntimeException(10016, "couldn't allocate " + std::to_string(MEMORY_CHUNK_SIZE_MB) +
@@ -674,7 +722,48 @@ namespace OpenLogReplicator {
         if (metrics) {
             metrics->emitMemoryAllocatedMb(memoryChunksAllocated);
             metrics->emitMemoryUsedTotalMb(0);
+            metrics->emitMemoryHugePagesMbAllocated(hugePagesChunksNum * MEMORY_CHUNK_SIZE_MB);
+            metrics->emitMemoryHugePagesMbUsed(0);
+        }
+    }
+
+    void Ctx::hugePagesAllocate() {
+        uint64_t pageSize = 2 * 1024 * 1024;
+        int mapFlags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE | MAP_HUGE_2MB;
+        if (hugePages == HUGE_PAGES_1GB) {
+            pageSize = 1024 * 1024 * 1024;
+            mapFlags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE | MAP_HUGE_1GB;
+        }
+        uint64_t size = ((memoryChunksMin * MEMORY_CHUNK_SIZE + pageSize - 1) / pageSize) * pageSize;
+
+        void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, mapFlags, -1, 0);
+        if (memory != MAP_FAILED) {
+            hugePagesMemory = reinterpret_cast<uint8_t*>(memory);
+            hugePagesMemorySize = size;
+            hugePagesChunks = hugePagesMemory;
+        } else {
+            // Fall back to transparent huge pages, the memory must be aligned to the huge page size
+            OLR_WARN(60038, "allocating " + std::to_string(size / 1024 / 1024) + " MB of huge pages failed: " + strerror(errno) +
+                            ", falling back to transparent huge pages");
+            pageSize = 2 * 1024 * 1024;
+            size = memoryChunksMin * MEMORY_CHUNK_SIZE + pageSize;
+            memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (unlikely(memory == MAP_FAILED))
+                throw RuntimeException(10016, "couldn't allocate " + std::to_string(size) + " bytes memory for: memory chunks#3");
+
+            hugePagesMemory = reinterpret_cast<uint8_t*>(memory);
+            hugePagesMemorySize = size;
+            hugePagesChunks = reinterpret_cast<uint8_t*>((reinterpret_cast<uint64_t>(hugePagesMemory) + pageSize - 1) & ~(pageSize - 1));
+            if (madvise(hugePagesChunks, memoryChunksMin * MEMORY_CHUNK_SIZE, MADV_HUGEPAGE) != 0)
+                OLR_WARN(60038, "setting transparent huge pages failed: " + std::string(strerror(errno)) + ", falling back to regular pages");
+            // Fault in the memory now, so that the pages are allocated up front
+            memset(hugePagesChunks, 0, memoryChunksMin * MEMORY_CHUNK_SIZE);
         }
+        hugePagesChunksNum = memoryChunksMin;
+    }
+
+    bool Ctx::isHugePagesChunk(const uint8_t* chunk) const {
+        return hugePagesChunks != nullptr && chunk >= hugePagesChunks && chunk < hugePagesChunks + hugePagesChunksNum * MEMORY_CHUNK_SIZE;
     }
 
     void Ctx::wakeAllOutOfMemory() {
@@ -690,6 +779,10 @@ namespace OpenLogReplicator {
         return memoryChunksFree * MEMORY_CHUNK_SIZE_MB;
     }
 
+    uint64_t Ctx::getAvailableMemory() const {
+        return (memoryChunksFree + memoryChunksMax - memoryChunksAllocated) * MEMORY_CHUNK_SIZE_MB;
+    }
+
     uint64_t Ctx::getAllocatedMemory() const {
         return memoryChunksAllocated * MEMORY_CHUNK_SIZE_MB;
     }
@@ -706,8 +799,8 @@ namespace OpenLogReplicator {
                         OLR_TRACE(TRACE_SLEEP, "Ctx:getMemoryChunk");
                     condOutOfMemory.wait(lck);
                 } else {
-                    hint("try to restart with higher value of 'memory-max-mb' parameter or if big transaction - add to 'skip-xid' list; "
-                         "transaction would be skipped");
+                    hint("try to restart with higher value of 'memory-max-mb' parameter, set 'spill-path' to store big transactions on disk "
+                         "or if big transaction - add to 'skip-xid' list; transaction would be skipped");
                     throw RuntimeException(10017, "out of memory");
                 }
             }
@@ -733,9 +826,14 @@ namespace OpenLogReplicator {
         if (reusable)
             ++memoryChunksReusable;
         ++memoryModulesAllocated[module];
+        bool hugePagesChunk = isHugePagesChunk(memoryChunks[memoryChunksFree]);
+        if (hugePagesChunk)
+            ++hugePagesChunksUsed;
 
         if (metrics) {
             metrics->emitMemoryUsedTotalMb(memoryChunksAllocated - memoryChunksFree);
+            if (hugePagesChunk)
+                metrics->emitMemoryHugePagesMbUsed(hugePagesChunksUsed * MEMORY_CHUNK_SIZE_MB);
 
             switch (module) {
                 case MEMORY_MODULE_BUILDER:
@@ -764,15 +862,34 @@ namespace OpenLogReplicator {
         if (unlikely(memoryChunksFree == memoryChunksAllocated))
             throw RuntimeException(50001, "trying to free unknown memory block for: " + memoryModules[module]);
 
-        // Keep memoryChunksMin reserved
-        if (memoryChunksFree >= memoryChunksMin) {
+        bool hugePagesChunk = isHugePagesChunk(chunk);
+        if (hugePagesChunk)
+            --hugePagesChunksUsed;
+
+        // Keep memoryChunksMin reserved, chunks backed by huge pages are always kept
+        if (memoryChunksFree >= memoryChunksMin && !hugePagesChunk) {
             free(chunk);
             --memoryChunksAllocated;
             if (metrics)
                 metrics->emitMemoryAllocatedMb(memoryChunksAllocated);
         } else {
-            memoryChunks[memoryChunksFree] = chunk;
-            ++memoryChunksFree;
+            // Release a heap chunk instead of the one backed by huge pages
+            uint64_t num = memoryChunksFree;
+            if (hugePagesChunk && memoryChunksFree >= memoryChunksMin) {
+                while (num > 0 && isHugePagesChunk(memoryChunks[num - 1]))
+                    --num;
+            }
+
+            if (hugePagesChunk && num > 0 && memoryChunksFree >= memoryChunksMin) {
+                free(memoryChunks[num - 1]);
+                memoryChunks[num - 1] = chunk;
+                --memoryChunksAllocated;
+                if (metrics)
+                    metrics->emitMemoryAllocatedMb(memoryChunksAllocated);
+            } else {
+                memoryChunks[memoryChunksFree] = chunk;
+                ++memoryChunksFree;
+            }
         }
         if (reusable)
             --memoryChunksReusable;
@@ -783,6 +900,8 @@ namespace OpenLogReplicator {
 
         if (metrics) {
             metrics->emitMemoryUsedTotalMb(memoryChunksAllocated - memoryChunksFree);
+            if (hugePagesChunk)
+                metrics->emitMemoryHugePagesMbUsed(hugePagesChunksUsed * MEMORY_CHUNK_SIZE_MB);
 
             switch (module) {
                 case MEMORY_MODULE_BUILDER:
@@ -84,9 +84,24 @@ namespace OpenLogReplicator {
         static constexpr uint64_t MEMORY_CHUNK_SIZE = MEMORY_CHUNK_SIZE_MB * 1024 * 1024;
         static constexpr uint64_t MEMORY_CHUNK_MIN_MB = 16;
 
+        static constexpr uint64_t HUGE_PAGES_NONE = 0;
+        static constexpr uint64_t HUGE_PAGES_2MB = 1;
+        static constexpr uint64_t HUGE_PAGES_1GB = 2;
+
         static constexpr uint64_t OLR_LOCALES_TIMESTAMP = 0;
         static constexpr uint64_t OLR_LOCALES_MOCK = 1;
 
+        static constexpr uint64_t READ_MODE_PREAD = 0;
+        static constexpr uint64_t READ_MODE_URING = 1;
+        static constexpr uint64_t READ_MODE_MMAP = 2;
+
+        static constexpr uint64_t REDO_VERIFY_MODE_FULL = 0;
+        static constexpr uint64_t REDO_VERIFY_MODE_HEADER = 1;
+
+        static constexpr uint64_t REDO_COPY_FSYNC_NONE = 0;
+        static constexpr uint64_t REDO_COPY_FSYNC_CLOSE = 1;
+        static constexpr uint64_t REDO_COPY_FSYNC_BATCH = 2;
+
         static constexpr uint64_t REDO_FLAGS_ARCH_ONLY = 0x00000001;
         static constexpr uint64_t REDO_FLAGS_SCHEMALESS = 0x00000002;
         static constexpr uint64_t REDO_FLAGS_ADAPTIVE_SCHEMA = 0x00000004;
@@ -149,6 +164,12 @@ namespace OpenLogReplicator {
         std::atomic<uint64_t> memoryChunksHWM;
         std::atomic<uint64_t> memoryChunksReusable;
         uint64_t memoryModulesAllocated[MEMORY_MODULES_NUM];
+        // Preallocated chunks backed by huge pages, never returned to the system
+        uint8_t* hugePagesMemory;
+        uint64_t hugePagesMemorySize;
+        uint8_t* hugePagesChunks;
+        uint64_t hugePagesChunksNum;
+        uint64_t hugePagesChunksUsed;
 
         std::condition_variable condMainLoop;
         std::condition_variable condOutOfMemory;
@@ -220,23 +241,40 @@ namespace OpenLogReplicator {
         uint64_t checkpointIntervalS;
         uint64_t checkpointIntervalMb;
         uint64_t checkpointKeep;
+        uint64_t checkpointTransactions;
+        uint64_t checkpointTransactionsMaxMb;
         uint64_t schemaForceInterval;
         // Reader
         uint64_t redoReadSleepUs;
         uint64_t redoVerifyDelayUs;
+        uint64_t redoVerifyMode;
         uint64_t archReadSleepUs;
         uint64_t archReadTries;
+        uint64_t archPrefetchLogs;
+        uint64_t archWatch;
         uint64_t refreshIntervalUs;
+        uint64_t readMode;
+        uint64_t readQueueDepth;
+        uint64_t hugePages;
+        // Parser
+        uint64_t decodeWorkers;
+        uint64_t flushQueue;
+        uint64_t formatWorkers;
         // Writer
         uint64_t pollIntervalUs;
         uint64_t queueSize;
         // Transaction buffer
         std::string dumpPath;
         std::string redoCopyPath;
+        uint64_t redoCopyFsync;
+        uint64_t redoCopyCompress;
         uint64_t stopLogSwitches;
         uint64_t stopCheckpoints;
         uint64_t stopTransactions;
         uint64_t transactionSizeMax;
+        std::string spillPath;
+        uint64_t spillSizeMax;
+        uint64_t compressIdleS;
         std::atomic<uint64_t> logLevel;
         std::atomic<uint64_t> trace;
         std::atomic<uint64_t> flags;
@@ -261,6 +299,14 @@ namespace OpenLogReplicator {
                 return static_cast<char>('a' + (x - 10));
         }
 
+        static inline int64_t unmap16(char c) {
+            if (c >= '0' && c <= '9')
+                return c - '0';
+            if (c >= 'a' && c <= 'f')
+                return c - 'a' + 10;
+            return -1;
+        }
+
         static inline char map16U(uint64_t x) {
             if (x < 10)
                 return static_cast<char>('0' + x);
@@ -567,11 +613,14 @@ namespace OpenLogReplicator {
         time_t valuesToEpoch(int64_t year, int64_t month, int64_t day, int64_t hour, int64_t minute, int64_t second, int64_t tz) const;
         uint64_t epochToIso8601(time_t timestamp, char* buffer, bool addT, bool addZ) const;
 
+        void hugePagesAllocate();
+        [[nodiscard]] bool isHugePagesChunk(const uint8_t* chunk) const;
         void initialize(uint64_t newMemoryMinMb, uint64_t newMemoryMaxMb, uint64_t newReadBufferMax);
         void wakeAllOutOfMemory();
         [[nodiscard]] uint64_t getMaxUsedMemory() const;
         [[nodiscard]] uint64_t getAllocatedMemory() const;
         [[nodiscard]] uint64_t getFreeMemory() const;
+        [[nodiscard]] uint64_t getAvailableMemory() const;
         [[nodiscard]] uint8_t* getMemoryChunk(uint64_t module, bool reusable);
         void freeMemoryChunk(uint64_t module, uint8_t* chunk, bool reusable);
         void stopHard();
@@ -27,6 +27,7 @@ namespace OpenLogReplicator {
     }
 
     void LobCtx::checkOrphanedLobs(const Ctx* ctx, const typeLobId& lobId, typeXid xid, uint64_t offset) {
+        std::unique_lock<std::mutex> lck(*mtxOrphanedLobs);
         LobKey lobKey(lobId, 0);
         for (auto orphanedLobsIt = orphanedLobs->upper_bound(lobKey);
              orphanedLobsIt != orphanedLobs->end() && orphanedLobsIt->first.lobId == lobId;) {
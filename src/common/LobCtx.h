@@ -18,6 +18,7 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 <http://www.gnu.org/licenses/>.  */
 
 #include <map>
+#include <mutex>
 #include <unordered_map>
 
 #include "LobData.h"
@@ -38,6 +39,8 @@ namespace OpenLogReplicator {
 
         std::unordered_map<typeLobId, LobData*> lobs;
         std::map<LobKey, Lob>* orphanedLobs;
+        // Orphaned LOBs are also taken by transactions formatted outside the parser thread
+        std::mutex* mtxOrphanedLobs;
         std::map<typeDba, uint8_t*> listMap;
 
         void checkOrphanedLobs(const Ctx* ctx, const typeLobId& lobId, typeXid xid, uint64_t offset);
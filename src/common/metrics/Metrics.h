@@ -55,6 +55,12 @@ namespace OpenLogReplicator {
         // bytes sent
         virtual void emitBytesSent(uint64_t counter) = 0;
 
+        // bytes_skipped
+        virtual void emitBytesSkipped(uint64_t counter) = 0;
+
+        // bytes_verify_saved
+        virtual void emitBytesVerifySaved(uint64_t counter) = 0;
+
         // checkpoints
         virtual void emitCheckpointsOut(uint64_t counter) = 0;
         virtual void emitCheckpointsSkip(uint64_t counter) = 0;
@@ -84,6 +90,12 @@ namespace OpenLogReplicator {
         virtual void emitDmlOpsInsertSkip(uint64_t counter, const std::string& owner, const std::string& table) = 0;
         virtual void emitDmlOpsUpdateSkip(uint64_t counter, const std::string& owner, const std::string& table) = 0;
 
+        // flush_queue_depth
+        virtual void emitFlushQueueDepth(int64_t gauge) = 0;
+
+        // flush_time_us
+        virtual void emitFlushTimeUs(uint64_t counter) = 0;
+
         // log_switches
         virtual void emitLogSwitchesArchived(uint64_t counter) = 0;
         virtual void emitLogSwitchesOnline(uint64_t counter) = 0;
@@ -95,6 +107,10 @@ namespace OpenLogReplicator {
         // memory_allocated_mb
         virtual void emitMemoryAllocatedMb(int64_t gauge) = 0;
 
+        // memory_huge_pages_mb
+        virtual void emitMemoryHugePagesMbAllocated(int64_t gauge) = 0;
+        virtual void emitMemoryHugePagesMbUsed(int64_t gauge) = 0;
+
         // memory_used_total_mb
         virtual void emitMemoryUsedTotalMb(int64_t gauge) = 0;
 
@@ -110,6 +126,15 @@ namespace OpenLogReplicator {
         // messages sent
         virtual void emitMessagesSent(uint64_t counter) = 0;
 
+        // parser_read_lag_us
+        virtual void emitParserReadLagUs(int64_t gauge) = 0;
+
+        // read_queue_depth
+        virtual void emitReadQueueDepth(int64_t gauge) = 0;
+
+        // read_speed_mb
+        virtual void emitReadSpeedMb(int64_t gauge) = 0;
+
         // transactions
         virtual void emitTransactionsCommitOut(uint64_t counter) = 0;
         virtual void emitTransactionsRollbackOut(uint64_t counter) = 0;
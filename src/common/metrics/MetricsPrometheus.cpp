@@ -33,6 +33,10 @@ namespace OpenLogReplicator {
             bytesReadCounter(nullptr),
             bytesSent(nullptr),
             bytesSentCounter(nullptr),
+            bytesSkipped(nullptr),
+            bytesSkippedCounter(nullptr),
+            bytesVerifySaved(nullptr),
+            bytesVerifySavedCounter(nullptr),
             checkpoints(nullptr),
             checkpointsOutCounter(nullptr),
             checkpointsSkipCounter(nullptr),
@@ -52,6 +56,10 @@ namespace OpenLogReplicator {
             dmlOpsDeleteSkipCounter(nullptr),
             dmlOpsInsertSkipCounter(nullptr),
             dmlOpsUpdateSkipCounter(nullptr),
+            flushQueueDepth(nullptr),
+            flushQueueDepthGauge(nullptr),
+            flushTimeUs(nullptr),
+            flushTimeUsCounter(nullptr),
             logSwitches(nullptr),
             logSwitchesOnlineCounter(nullptr),
             logSwitchesArchivedCounter(nullptr),
@@ -60,6 +68,9 @@ namespace OpenLogReplicator {
             logSwitchesLagArchivedGauge(nullptr),
             memoryAllocatedMb(nullptr),
             memoryAllocatedMbGauge(nullptr),
+            memoryHugePagesMb(nullptr),
+            memoryHugePagesMbAllocatedGauge(nullptr),
+            memoryHugePagesMbUsedGauge(nullptr),
             memoryUsedTotalMb(nullptr),
             memoryUsedTotalMbGauge(nullptr),
             memoryUsedMb(nullptr),
@@ -71,6 +82,12 @@ namespace OpenLogReplicator {
             messagesConfirmedCounter(nullptr),
             messagesSent(nullptr),
             messagesSentCounter(nullptr),
+            parserReadLagUs(nullptr),
+            parserReadLagUsGauge(nullptr),
+            readQueueDepth(nullptr),
+            readQueueDepthGauge(nullptr),
+            readSpeedMb(nullptr),
+            readSpeedMbGauge(nullptr),
             transactions(nullptr),
             transactionsCommitOutCounter(nullptr),
             transactionsRollbackOutCounter(nullptr),
@@ -109,6 +126,16 @@ namespace OpenLogReplicator {
                 .Register(*registry);
         bytesSentCounter = &bytesSent->Add({});
 
+        // bytes_skipped
+        bytesSkipped = &prometheus::BuildCounter().Name("bytes_skipped").Help("Number of bytes of redo records skipped without decoding")
+                .Register(*registry);
+        bytesSkippedCounter = &bytesSkipped->Add({});
+
+        // bytes_verify_saved
+        bytesVerifySaved = &prometheus::BuildCounter().Name("bytes_verify_saved").Help("Number of bytes not read again during verification of online redo log files")
+                .Register(*registry);
+        bytesVerifySavedCounter = &bytesVerifySaved->Add({});
+
         // checkpoints
         checkpoints = &prometheus::BuildCounter().Name("checkpoints").Help("Number of checkpoint records").Register(*registry);
         checkpointsOutCounter = &checkpoints->Add({{"filter", "out"}});
@@ -142,6 +169,15 @@ namespace OpenLogReplicator {
         dmlOpsUpdateSkipCounter = &dmlOps->Add({{"type",   "update"},
                                                 {"filter", "skip"}});
 
+        // flush_queue_depth
+        flushQueueDepth = &prometheus::BuildGauge().Name("flush_queue_depth").Help("Number of committed transactions waiting for the flush thread")
+                .Register(*registry);
+        flushQueueDepthGauge = &flushQueueDepth->Add({});
+
+        // flush_time_us
+        flushTimeUs = &prometheus::BuildCounter().Name("flush_time_us").Help("Time spent on formatting committed transactions").Register(*registry);
+        flushTimeUsCounter = &flushTimeUs->Add({});
+
         // log_switches
         logSwitches = &prometheus::BuildCounter().Name("log_switches").Help("Number of redo log switches").Register(*registry);
         logSwitchesOnlineCounter = &logSwitches->Add({{"type", "online"}});
@@ -160,6 +196,11 @@ namespace OpenLogReplicator {
         memoryAllocatedMb = &prometheus::BuildGauge().Name("memory_allocated_mb").Help("Amount of allocated memory in MB").Register(*registry);
         memoryAllocatedMbGauge = &memoryAllocatedMb->Add({});
 
+        // memory_huge_pages_mb
+        memoryHugePagesMb = &prometheus::BuildGauge().Name("memory_huge_pages_mb").Help("Memory backed by huge pages in MB").Register(*registry);
+        memoryHugePagesMbAllocatedGauge = &memoryHugePagesMb->Add({{"type", "allocated"}});
+        memoryHugePagesMbUsedGauge = &memoryHugePagesMb->Add({{"type", "used"}});
+
         // memory_used_total_mb
         memoryUsedTotalMb = &prometheus::BuildGauge().Name("memory_used_total_mb").Help("Total used memory").Register(*registry);
         memoryUsedTotalMbGauge = &memoryUsedTotalMb->Add({});
@@ -176,6 +217,19 @@ namespace OpenLogReplicator {
                 .Register(*registry);
         messagesSentCounter = &messagesSent->Add({});
 
+        // parser_read_lag_us
+        parserReadLagUs = &prometheus::BuildGauge().Name("parser_read_lag_us").Help("Time between redo data validated by reader and taken by parser")
+                .Register(*registry);
+        parserReadLagUsGauge = &parserReadLagUs->Add({});
+
+        // read_queue_depth
+        readQueueDepth = &prometheus::BuildGauge().Name("read_queue_depth").Help("Number of redo log reads in flight").Register(*registry);
+        readQueueDepthGauge = &readQueueDepth->Add({});
+
+        // read_speed_mb
+        readSpeedMb = &prometheus::BuildGauge().Name("read_speed_mb").Help("Redo log read speed in MB/s").Register(*registry);
+        readSpeedMbGauge = &readSpeedMb->Add({});
+
         // transactions
         transactions = &prometheus::BuildCounter().Name("dml_ops").Help("Number of transactions").Register(*registry);
         transactionsCommitOutCounter = &transactions->Add({{"type",   "commit"},
@@ -217,6 +271,16 @@ namespace OpenLogReplicator {
         bytesSentCounter->Increment(counter);
     }
 
+    // bytes_skipped
+    void MetricsPrometheus::emitBytesSkipped(uint64_t counter) {
+        bytesSkippedCounter->Increment(counter);
+    }
+
+    // bytes_verify_saved
+    void MetricsPrometheus::emitBytesVerifySaved(uint64_t counter) {
+        bytesVerifySavedCounter->Increment(counter);
+    }
+
     // checkpoints
     void MetricsPrometheus::emitCheckpointsOut(uint64_t counter) {
         checkpointsOutCounter->Increment(counter);
@@ -377,6 +441,16 @@ namespace OpenLogReplicator {
         cnt->Increment(counter);
     }
 
+    // flush_queue_depth
+    void MetricsPrometheus::emitFlushQueueDepth(int64_t gauge) {
+        flushQueueDepthGauge->Set(gauge);
+    }
+
+    // flush_time_us
+    void MetricsPrometheus::emitFlushTimeUs(uint64_t counter) {
+        flushTimeUsCounter->Increment(counter);
+    }
+
     // log_switches
     void MetricsPrometheus::emitLogSwitchesArchived(uint64_t counter) {
         logSwitchesArchivedCounter->Increment(counter);
@@ -400,6 +474,15 @@ namespace OpenLogReplicator {
         memoryAllocatedMbGauge->Set(gauge);
     }
 
+    // memory_huge_pages_mb
+    void MetricsPrometheus::emitMemoryHugePagesMbAllocated(int64_t gauge) {
+        memoryHugePagesMbAllocatedGauge->Set(gauge);
+    }
+
+    void MetricsPrometheus::emitMemoryHugePagesMbUsed(int64_t gauge) {
+        memoryHugePagesMbUsedGauge->Set(gauge);
+    }
+
     // memory_used_total_mb
     void MetricsPrometheus::emitMemoryUsedTotalMb(int64_t gauge) {
         memoryUsedTotalMbGauge->Set(gauge);
@@ -432,6 +515,21 @@ namespace OpenLogReplicator {
         messagesSentCounter->Increment(counter);
     }
 
+    // parser_read_lag_us
+    void MetricsPrometheus::emitParserReadLagUs(int64_t gauge) {
+        parserReadLagUsGauge->Set(gauge);
+    }
+
+    // read_queue_depth
+    void MetricsPrometheus::emitReadQueueDepth(int64_t gauge) {
+        readQueueDepthGauge->Set(gauge);
+    }
+
+    // read_speed_mb
+    void MetricsPrometheus::emitReadSpeedMb(int64_t gauge) {
+        readSpeedMbGauge->Set(gauge);
+    }
+
     // transactions
     void MetricsPrometheus::emitTransactionsCommitOut(uint64_t counter) {
         transactionsCommitOutCounter->Increment(counter);
@@ -50,6 +50,14 @@ namespace OpenLogReplicator {
         prometheus::Family<prometheus::Counter>* bytesSent;
         prometheus::Counter* bytesSentCounter;
 
+        // bytes_skipped
+        prometheus::Family<prometheus::Counter>* bytesSkipped;
+        prometheus::Counter* bytesSkippedCounter;
+
+        // bytes_verify_saved
+        prometheus::Family<prometheus::Counter>* bytesVerifySaved;
+        prometheus::Counter* bytesVerifySavedCounter;
+
         // checkpoints
         prometheus::Family<prometheus::Counter>* checkpoints;
         prometheus::Counter* checkpointsOutCounter;
@@ -83,6 +91,14 @@ namespace OpenLogReplicator {
         std::unordered_map<std::string, prometheus::Counter*> dmlOpsInsertSkipCounterMap;
         std::unordered_map<std::string, prometheus::Counter*> dmlOpsUpdateSkipCounterMap;
 
+        // flush_queue_depth
+        prometheus::Family<prometheus::Gauge>* flushQueueDepth;
+        prometheus::Gauge* flushQueueDepthGauge;
+
+        // flush_time_us
+        prometheus::Family<prometheus::Counter>* flushTimeUs;
+        prometheus::Counter* flushTimeUsCounter;
+
         // log_switches
         prometheus::Family<prometheus::Counter>* logSwitches;
         prometheus::Counter* logSwitchesOnlineCounter;
@@ -97,6 +113,11 @@ namespace OpenLogReplicator {
         prometheus::Family<prometheus::Gauge>* memoryAllocatedMb;
         prometheus::Gauge* memoryAllocatedMbGauge;
 
+        // memory_huge_pages_mb
+        prometheus::Family<prometheus::Gauge>* memoryHugePagesMb;
+        prometheus::Gauge* memoryHugePagesMbAllocatedGauge;
+        prometheus::Gauge* memoryHugePagesMbUsedGauge;
+
         // memory_used_total_mb
         prometheus::Family<prometheus::Gauge>* memoryUsedTotalMb;
         prometheus::Gauge* memoryUsedTotalMbGauge;
@@ -116,6 +137,18 @@ namespace OpenLogReplicator {
         prometheus::Family<prometheus::Counter>* messagesSent;
         prometheus::Counter* messagesSentCounter;
 
+        // parser_read_lag_us
+        prometheus::Family<prometheus::Gauge>* parserReadLagUs;
+        prometheus::Gauge* parserReadLagUsGauge;
+
+        // read_queue_depth
+        prometheus::Family<prometheus::Gauge>* readQueueDepth;
+        prometheus::Gauge* readQueueDepthGauge;
+
+        // read_speed_mb
+        prometheus::Family<prometheus::Gauge>* readSpeedMb;
+        prometheus::Gauge* readSpeedMbGauge;
+
         // transactions
         prometheus::Family<prometheus::Counter>* transactions;
         prometheus::Counter* transactionsCommitOutCounter;
@@ -144,6 +177,12 @@ namespace OpenLogReplicator {
         // bytes sent
         virtual void emitBytesSent(uint64_t counter) override;
 
+        // bytes_skipped
+        virtual void emitBytesSkipped(uint64_t counter) override;
+
+        // bytes_verify_saved
+        virtual void emitBytesVerifySaved(uint64_t counter) override;
+
         // checkpoints
         virtual void emitCheckpointsOut(uint64_t counter) override;
         virtual void emitCheckpointsSkip(uint64_t counter) override;
@@ -173,6 +212,12 @@ namespace OpenLogReplicator {
         virtual void emitDmlOpsInsertSkip(uint64_t counter, const std::string& owner, const std::string& table) override;
         virtual void emitDmlOpsUpdateSkip(uint64_t counter, const std::string& owner, const std::string& table) override;
 
+        // flush_queue_depth
+        virtual void emitFlushQueueDepth(int64_t gauge) override;
+
+        // flush_time_us
+        virtual void emitFlushTimeUs(uint64_t counter) override;
+
         // log_switches
         virtual void emitLogSwitchesArchived(uint64_t counter) override;
         virtual void emitLogSwitchesOnline(uint64_t counter) override;
@@ -184,6 +229,10 @@ namespace OpenLogReplicator {
         // memory_allocated_mb
         virtual void emitMemoryAllocatedMb(int64_t gauge) override;
 
+        // memory_huge_pages_mb
+        virtual void emitMemoryHugePagesMbAllocated(int64_t gauge) override;
+        virtual void emitMemoryHugePagesMbUsed(int64_t gauge) override;
+
         // memory_used_total_mb
         virtual void emitMemoryUsedTotalMb(int64_t gauge) override;
 
@@ -199,6 +248,15 @@ namespace OpenLogReplicator {
         // messages sent
         virtual void emitMessagesSent(uint64_t counter) override;
 
+        // parser_read_lag_us
+        virtual void emitParserReadLagUs(int64_t gauge) override;
+
+        // read_queue_depth
+        virtual void emitReadQueueDepth(int64_t gauge) override;
+
+        // read_speed_mb
+        virtual void emitReadSpeedMb(int64_t gauge) override;
+
         // transactions
         virtual void emitTransactionsCommitOut(uint64_t counter) override;
         virtual void emitTransactionsRollbackOut(uint64_t counter) override;
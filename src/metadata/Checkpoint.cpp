@@ -202,7 +202,7 @@ namespace OpenLogReplicator {
         ctx->OLR_INFO(0, "scanning objects which match the configuration file");
         // Suspend transaction processing for the schema update
         {
-            std::unique_lock<std::mutex> lckTransaction(metadata->mtxTransaction);
+            std::unique_lock<std::shared_mutex> lckTransaction(metadata->mtxTransaction);
             metadata->commitElements();
             metadata->schema->purgeMetadata();
 
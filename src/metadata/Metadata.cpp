@@ -96,6 +96,11 @@ namespace OpenLogReplicator {
             minSequence(Ctx::ZERO_SEQ),
             minOffset(0),
             minXid(),
+            checkpointTransactions(false),
+            lastTransactionsTime(0),
+            lastTransactionsBytes(0),
+            transactionsSequence(Ctx::ZERO_SEQ),
+            transactionsOffset(0),
             schemaInterval(0) {
     }
 
@@ -189,6 +194,17 @@ namespace OpenLogReplicator {
         ++sequence;
     }
 
+    typeSeq Metadata::getThreadSequence(uint16_t thread) const {
+        if (threadPositions.empty())
+            return sequence;
+
+        // A thread missing in the checkpoint is read from the first archived redo log
+        auto threadPositionsIt = threadPositions.find(thread);
+        if (threadPositionsIt == threadPositions.end())
+            return 0;
+        return threadPositionsIt->second.first;
+    }
+
     void Metadata::setSeqOffset(typeSeq newSequence, uint64_t newOffset) {
         if (unlikely(ctx->trace & Ctx::TRACE_CHECKPOINT))
             ctx->OLR_TRACE(Ctx::TRACE_CHECKPOINT, "setting sequence to: " + std::to_string(newSequence) + ", offset: " +
@@ -238,6 +254,34 @@ namespace OpenLogReplicator {
         return false;
     }
 
+    std::istream* Metadata::stateReadData(const std::string& name) {
+        try {
+            return state->readData(name);
+        } catch (RuntimeException& ex) {
+            ctx->OLR_ERROR(ex.code, ex.msg);
+        }
+        return nullptr;
+    }
+
+    std::ostream* Metadata::stateWriteData(const std::string& name) {
+        try {
+            return state->writeData(name);
+        } catch (RuntimeException& ex) {
+            ctx->OLR_ERROR(ex.code, ex.msg);
+        }
+        return nullptr;
+    }
+
+    bool Metadata::stateDropData(const std::string& name) {
+        try {
+            state->dropData(name);
+            return true;
+        } catch (RuntimeException& ex) {
+            ctx->OLR_ERROR(ex.code, ex.msg);
+        }
+        return false;
+    }
+
     SchemaElement* Metadata::addElement(const char* owner, const char* table, typeOptions options) {
         if (unlikely(!Ctx::checkNameCase(owner)))
             throw ConfigurationException(30003, "owner '" + std::string(owner) +
@@ -342,9 +386,21 @@ namespace OpenLogReplicator {
     }
 
     void Metadata::checkpoint(typeScn newCheckpointScn, typeTime newCheckpointTime, typeSeq newCheckpointSequence, uint64_t newCheckpointOffset,
-                              uint64_t newCheckpointBytes, typeSeq newMinSequence, uint64_t newMinOffset, typeXid newMinXid) {
+                              uint64_t newCheckpointBytes, typeSeq newMinSequence, uint64_t newMinOffset, typeXid newMinXid, uint16_t newThread,
+                              bool newTransactions) {
         std::unique_lock<std::mutex> lck(mtxCheckpoint);
 
+        // The position of stored open transactions is kept until the checkpoint is written
+        if (checkpointTransactions && allowedCheckpoints && lastCheckpointScn != checkpointScn) {
+            checkpointBytes += newCheckpointBytes;
+            return;
+        }
+
+        checkpointTransactions = newTransactions;
+        if (newTransactions) {
+            lastTransactionsTime = newCheckpointTime;
+            lastTransactionsBytes = checkpointBytes + newCheckpointBytes;
+        }
         checkpointScn = newCheckpointScn;
         checkpointTime = newCheckpointTime;
         checkpointSequence = newCheckpointSequence;
@@ -353,6 +409,25 @@ namespace OpenLogReplicator {
         minSequence = newMinSequence;
         minOffset = newMinOffset;
         minXid = newMinXid;
+
+        // The oldest open transaction is then the oldest one of this thread
+        auto checkpointThreadPositionsIt = checkpointThreadPositions.find(newThread);
+        if (checkpointThreadPositionsIt != checkpointThreadPositions.end())
+            checkpointThreadPositionsIt->second = ThreadPosition{newCheckpointSequence, newCheckpointOffset, newMinSequence, newMinOffset, newMinXid};
+    }
+
+    bool Metadata::isTransactionsDue(typeTime time) {
+        std::unique_lock<std::mutex> lck(mtxCheckpoint);
+
+        if (!allowedCheckpoints || (checkpointTransactions && lastCheckpointScn != checkpointScn))
+            return false;
+
+        return static_cast<uint64_t>(time.toEpoch(ctx->hostTimezone) - lastTransactionsTime.toEpoch(ctx->hostTimezone)) >= ctx->checkpointIntervalS ||
+               (checkpointBytes - lastTransactionsBytes) / 1024 / 1024 >= ctx->checkpointIntervalMb;
+    }
+
+    std::string Metadata::getTransactionsName(typeScn scn) const {
+        return database + "-txn-" + std::to_string(scn);
     }
 
     void Metadata::writeCheckpoint(bool force) {
@@ -367,7 +442,7 @@ namespace OpenLogReplicator {
             if (checkpointScn == Ctx::ZERO_SCN || lastCheckpointScn == checkpointScn || checkpointSequence == Ctx::ZERO_SEQ)
                 return;
 
-            if (lastSequence == sequence && !force &&
+            if (lastSequence == sequence && !force && !checkpointTransactions &&
                 (static_cast<uint64_t>(checkpointTime.toEpoch(ctx->hostTimezone) - lastCheckpointTime.toEpoch(ctx->hostTimezone)) < ctx->checkpointIntervalS) &&
                 (checkpointBytes - lastCheckpointBytes) / 1024 / 1024 < ctx->checkpointIntervalMb)
                 return;
@@ -393,6 +468,8 @@ namespace OpenLogReplicator {
             ++checkpoints;
             checkpointScnList.insert(checkpointScn);
             checkpointSchemaMap.insert_or_assign(checkpointScn, storeSchema);
+            if (checkpointTransactions)
+                transactionsScnList.insert(checkpointScn);
         }
 
         std::string checkpointName = database + "-chkpt-" + std::to_string(lastCheckpointScn);
@@ -414,6 +491,12 @@ namespace OpenLogReplicator {
         state->list(namesList);
 
         for (const std::string& name: namesList) {
+            std::string transactionsPrefix(database + "-txn-");
+            if (name.length() > transactionsPrefix.length() && name.compare(0, transactionsPrefix.length(), transactionsPrefix) == 0) {
+                transactionsScnList.insert(strtoull(name.c_str() + transactionsPrefix.length(), nullptr, 10));
+                continue;
+            }
+
             std::string prefix(database + "-chkpt-");
             if (name.length() < prefix.length() || name.substr(0, prefix.length()).compare(prefix) != 0)
                 continue;
@@ -549,6 +632,8 @@ namespace OpenLogReplicator {
                 break;
         }
 
+        // Open transactions are dropped with the checkpoint, or when the checkpoint was never written
+        std::set<typeScn> transactionsScnToDrop;
         {
             std::unique_lock<std::mutex> lck(mtxCheckpoint);
 
@@ -556,6 +641,22 @@ namespace OpenLogReplicator {
                 checkpointScnList.erase(scn);
                 checkpointSchemaMap.erase(scn);
             }
+
+            for (auto scn: transactionsScnList) {
+                if (scnToDrop.find(scn) != scnToDrop.end() ||
+                    (scn < lastCheckpointScn && checkpointScnList.find(scn) == checkpointScnList.end()))
+                    transactionsScnToDrop.insert(scn);
+            }
+        }
+
+        for (auto scn: transactionsScnToDrop) {
+            // The data first, the file left after a failure is listed and dropped later
+            std::string name(getTransactionsName(scn));
+            if (!stateDropData(name) || !stateDrop(name))
+                break;
+
+            std::unique_lock<std::mutex> lck(mtxCheckpoint);
+            transactionsScnList.erase(scn);
         }
     }
 
@@ -20,10 +20,12 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #include <atomic>
 #include <condition_variable>
 #include <functional>
+#include <map>
 #include <mutex>
 #include <rapidjson/document.h>
 #include <rapidjson/error/en.h>
 #include <set>
+#include <shared_mutex>
 #include <unordered_map>
 #include <vector>
 
@@ -44,6 +46,15 @@ namespace OpenLogReplicator {
     class State;
     class StateDisk;
 
+    // Position of a redo thread and of the oldest open transaction started in the thread, Ctx::ZERO_SEQ if none is open
+    struct ThreadPosition {
+        typeSeq sequence;
+        uint64_t offset;
+        typeSeq minSequence;
+        uint64_t minOffset;
+        typeXid minXid;
+    };
+
     class Metadata final {
     protected:
         std::condition_variable condReplicator;
@@ -57,6 +68,8 @@ namespace OpenLogReplicator {
         static constexpr uint64_t STATUS_START = 1;
         // Replication is running. The metadata is initialized, the starting point of replication is defined.
         static constexpr uint64_t STATUS_REPLICATE = 2;
+        // Open transactions are stored as hex, larger sets are read from the oldest open transaction
+        static constexpr uint64_t TRANSACTIONS_FILE_MAX_SIZE = 2147483648;
 
         Schema* schema;
         Ctx* ctx;
@@ -98,8 +111,8 @@ namespace OpenLogReplicator {
         typeScn firstSchemaScn;
         std::set<RedoLog*> redoLogs;
 
-        // Transaction schema consistency mutex
-        std::mutex mtxTransaction;
+        // Transaction schema consistency mutex, shared by readers of the schema
+        std::shared_mutex mtxTransaction;
 
         // Checkpoint information
         std::mutex mtxCheckpoint;
@@ -127,6 +140,19 @@ namespace OpenLogReplicator {
         typeSeq minSequence;
         uint64_t minOffset;
         typeXid minXid;
+        // Positions of the redo threads of a RAC database, filled only when the threads are merged
+        std::map<uint16_t, std::pair<typeSeq, uint64_t>> threadPositions;
+        std::map<uint16_t, std::pair<typeSeq, uint64_t>> threadTransactionsPositions;
+        std::map<uint16_t, ThreadPosition> checkpointThreadPositions;
+        // Open transactions stored with the checkpoint, the checkpoint position is then kept until written
+        bool checkpointTransactions;
+        typeTime lastTransactionsTime;
+        uint64_t lastTransactionsBytes;
+        std::set<typeScn> transactionsScnList;
+        // Open transactions of the checkpoint read on startup
+        std::string transactionsName;
+        typeSeq transactionsSequence;
+        uint64_t transactionsOffset;
         uint64_t schemaInterval;
         std::set<typeScn> checkpointScnList;
         std::unordered_map<typeScn, bool> checkpointSchemaMap;
@@ -149,10 +175,14 @@ namespace OpenLogReplicator {
         void setActivation(typeActivation newActivation);
         void setFirstNextScn(typeScn newFirstScn, typeScn newNextScn);
         void setNextSequence();
+        [[nodiscard]] typeSeq getThreadSequence(uint16_t thread) const;
         [[nodiscard]] bool stateRead(const std::string& name, uint64_t maxSize, std::string& in);
         [[nodiscard]] bool stateDiskRead(const std::string& name, uint64_t maxSize, std::string& in);
         [[nodiscard]] bool stateWrite(const std::string& name, typeScn scn, const std::ostringstream& out);
         [[nodiscard]] bool stateDrop(const std::string& name);
+        [[nodiscard]] std::istream* stateReadData(const std::string& name);
+        [[nodiscard]] std::ostream* stateWriteData(const std::string& name);
+        [[nodiscard]] bool stateDropData(const std::string& name);
         SchemaElement* addElement(const char* owner, const char* table, typeOptions options);
         void resetElements();
         void commitElements();
@@ -164,7 +194,10 @@ namespace OpenLogReplicator {
         void setStatusReplicate();
         void wakeUp();
         void checkpoint(typeScn newCheckpointScn, typeTime newCheckpointTime, typeSeq newCheckpointSequence, uint64_t newCheckpointOffset,
-                        uint64_t newCheckpointBytes, typeSeq newMinSequence, uint64_t newMinOffset, typeXid newMinXid);
+                        uint64_t newCheckpointBytes, typeSeq newMinSequence, uint64_t newMinOffset, typeXid newMinXid, uint16_t newThread,
+                        bool newTransactions);
+        [[nodiscard]] bool isTransactionsDue(typeTime time);
+        [[nodiscard]] std::string getTransactionsName(typeScn scn) const;
         void writeCheckpoint(bool force);
         void readCheckpoints();
         void readCheckpoint(typeScn scn);
@@ -63,6 +63,9 @@ namespace OpenLogReplicator {
             lobTmp(nullptr),
             tableTmp(nullptr),
             touched(false) {
+        for (auto& bits: tableFilter)
+            bits = 0;
+        tableFilterStale = false;
     }
 
     Schema::~Schema() {
@@ -2174,6 +2177,24 @@ namespace OpenLogReplicator {
         return nullptr;
     }
 
+    bool Schema::checkTableFilter(typeObj obj) const {
+        // False positives are possible, the dictionary is checked later anyway
+        return (tableFilter[(obj % TABLE_FILTER_BITS) / 64].load(std::memory_order_relaxed) & (1ULL << (obj % 64))) != 0;
+    }
+
+    void Schema::addTableFilter(typeObj obj) {
+        tableFilter[(obj % TABLE_FILTER_BITS) / 64].fetch_or(1ULL << (obj % 64), std::memory_order_relaxed);
+    }
+
+    void Schema::rebuildTableFilter() {
+        // Bits can't be removed one by one, so the filter is rebuilt after tables were removed
+        for (auto& bits: tableFilter)
+            bits.store(0, std::memory_order_relaxed);
+        for (const auto& tablePartitionMapIt: tablePartitionMap)
+            addTableFilter(tablePartitionMapIt.first);
+        tableFilterStale = false;
+    }
+
     bool Schema::checkTableDictUncommitted(typeObj obj, std::string& owner, std::string& table) const {
         const auto objIt = sysObjMapObj.find(obj);
         if (objIt == sysObjMapObj.end())
@@ -2226,9 +2247,10 @@ namespace OpenLogReplicator {
             }
         }
 
-        if (likely(tablePartitionMap.find(table->obj) == tablePartitionMap.end()))
+        if (likely(tablePartitionMap.find(table->obj) == tablePartitionMap.end())) {
             tablePartitionMap.insert_or_assign(table->obj, table);
-        else
+            addTableFilter(table->obj);
+        } else
             throw DataException(50033, "can't add partition (obj: " + std::to_string(table->obj) + ", dataobj: " +
                                        std::to_string(table->dataObj) + ")");
 
@@ -2236,15 +2258,17 @@ namespace OpenLogReplicator {
             typeObj obj = objx >> 32;
             typeDataObj dataObj = objx & 0xFFFFFFFF;
 
-            if (likely(tablePartitionMap.find(obj) == tablePartitionMap.end()))
+            if (likely(tablePartitionMap.find(obj) == tablePartitionMap.end())) {
                 tablePartitionMap.insert_or_assign(obj, table);
-            else
+                addTableFilter(obj);
+            } else
                 throw DataException(50034, "can't add partition element (obj: " + std::to_string(obj) + ", dataobj: " +
                                            std::to_string(dataObj) + ")");
         }
     }
 
     void Schema::removeTableFromDict(OracleTable* table) {
+        tableFilterStale = true;
         auto tablePartitionMapIt = tablePartitionMap.find(table->obj);
         if (likely(tablePartitionMapIt != tablePartitionMap.end()))
             tablePartitionMap.erase(tablePartitionMapIt);
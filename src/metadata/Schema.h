@@ -17,6 +17,7 @@ You should have received a copy of the GNU General Public License
 along with OpenLogReplicator; see the file LICENSE;  If not see
 <http://www.gnu.org/licenses/>.  */
 
+#include <atomic>
 #include <list>
 #include <map>
 #include <rapidjson/document.h>
@@ -69,6 +70,9 @@ namespace OpenLogReplicator {
 
     class Schema final {
     protected:
+        // Bits of the object filter, any object of a table in the dictionary has its bit set
+        static constexpr uint64_t TABLE_FILTER_BITS = 1 << 20;
+
         Ctx* ctx;
         Locales* locales;
         typeRowId sysUserRowId;
@@ -116,6 +120,7 @@ namespace OpenLogReplicator {
         bool compareXdbXPt(Schema* otherSchema, std::string& msgs) const;
         void addTableToDict(OracleTable* table);
         void removeTableFromDict(OracleTable* table);
+        void addTableFilter(typeObj obj);
         uint16_t getLobBlockSize(typeTs ts) const;
 
     public:
@@ -127,6 +132,8 @@ namespace OpenLogReplicator {
         std::unordered_map<typeDataObj, OracleLob*> lobIndexMap;
         std::unordered_map<typeObj, OracleTable*> tableMap;
         std::unordered_map<typeObj, OracleTable*> tablePartitionMap;
+        std::atomic<uint64_t> tableFilter[TABLE_FILTER_BITS / 64];
+        std::atomic<bool> tableFilterStale;
         XmlCtx* xmlCtxDefault;
         OracleColumn* columnTmp;
         OracleLob* lobTmp;
@@ -312,6 +319,8 @@ namespace OpenLogReplicator {
 
         void touchTable(typeObj obj);
         [[nodiscard]] OracleTable* checkTableDict(typeObj obj) const;
+        [[nodiscard]] bool checkTableFilter(typeObj obj) const;
+        void rebuildTableFilter();
         [[nodiscard]] bool checkTableDictUncommitted(typeObj obj, std::string& owner, std::string& table) const;
         [[nodiscard]] OracleLob* checkLobDict(typeDataObj dataObj) const;
         [[nodiscard]] OracleLob* checkLobIndexDict(typeDataObj dataObj) const;
@@ -65,12 +65,39 @@ namespace OpenLogReplicator {
            R"(,"time":)" << std::dec << metadata->checkpointTime.getVal() << // not read
            R"(,"seq":)" << std::dec << metadata->checkpointSequence <<
            R"(,"offset":)" << std::dec << metadata->checkpointOffset;
-        if (metadata->minSequence != Ctx::ZERO_SEQ) {
+        if (!metadata->checkpointThreadPositions.empty()) {
+            // Every redo thread is resumed from its oldest open transaction
+            ss << R"(,"threads":[)";
+            bool hasPrev = false;
+            for (const auto& checkpointThreadPositionsIt: metadata->checkpointThreadPositions) {
+                if (hasPrev)
+                    ss << ",";
+                else
+                    hasPrev = true;
+                const ThreadPosition& threadPosition = checkpointThreadPositionsIt.second;
+                ss << R"({"thread":)" << std::dec << checkpointThreadPositionsIt.first <<
+                   R"(,"seq":)" << std::dec << threadPosition.sequence <<
+                   R"(,"offset":)" << std::dec << threadPosition.offset;
+                if (threadPosition.minSequence != Ctx::ZERO_SEQ) {
+                    ss << R"(,"min-tran":{)" <<
+                       R"("seq":)" << std::dec << threadPosition.minSequence <<
+                       R"(,"offset":)" << std::dec << threadPosition.minOffset <<
+                       R"(,"xid":")" << threadPosition.minXid.toString() << R"("})";
+                }
+                ss << "}";
+            }
+            ss << "]";
+        } else if (metadata->minSequence != Ctx::ZERO_SEQ) {
             ss << R"(,"min-tran":{)" <<
                R"("seq":)" << std::dec << metadata->minSequence <<
                R"(,"offset":)" << std::dec << metadata->minOffset <<
                R"(,"xid":")" << metadata->minXid.toString() << R"("})";
         }
+        if (metadata->checkpointTransactions) {
+            ss << R"(,"transactions":")";
+            Ctx::writeEscapeValue(ss, metadata->getTransactionsName(metadata->checkpointScn));
+            ss << R"(")";
+        }
         ss << R"(,"big-endian":)" << std::dec << (metadata->ctx->isBigEndian() ? 1 : 0) <<
            R"(,"context":")";
         Ctx::writeEscapeValue(ss, metadata->context);
@@ -523,8 +550,8 @@ namespace OpenLogReplicator {
 
             {
                 if (!metadata->ctx->disableChecksSet(Ctx::DISABLE_CHECKS_JSON_TAGS)) {
-                    static const char* documentChildNames[] = {"scn", "min-tran", "seq", "offset", "database", "resetlogs",
-                                                               "activation", "time", "big-endian", "context", "con-id", "con-name",
+                    static const char* documentChildNames[] = {"scn", "min-tran", "threads", "transactions", "seq", "offset", "database",
+                                                               "resetlogs", "activation", "time", "big-endian", "context", "con-id", "con-name",
                                                                "db-timezone", "db-recovery-file-dest", "db-block-checksum",
                                                                "log-archive-format", "log-archive-dest", "nls-character-set",
                                                                "nls-nchar-character-set", "supp-log-db-primary", "supp-log-db-all",
@@ -559,6 +586,50 @@ namespace OpenLogReplicator {
                         throw DataException(20006, "file: " + fileName + " - invalid offset: " + std::to_string(metadata->offset) +
                                                    " is not a multiplication of 512");
 
+                    // Open transactions are restored later, the position of the oldest one is used if that fails
+                    metadata->transactionsName.clear();
+                    if (document.HasMember("transactions")) {
+                        metadata->transactionsName = Ctx::getJsonFieldS(fileName, Ctx::JSON_PARAMETER_LENGTH, document, "transactions");
+                        metadata->transactionsSequence = Ctx::getJsonFieldU32(fileName, document, "seq");
+                        metadata->transactionsOffset = Ctx::getJsonFieldU64(fileName, document, "offset");
+                    }
+
+                    metadata->threadPositions.clear();
+                    metadata->threadTransactionsPositions.clear();
+                    metadata->checkpointThreadPositions.clear();
+                    if (document.HasMember("threads")) {
+                        const rapidjson::Value& threadsJson = Ctx::getJsonFieldA(fileName, document, "threads");
+                        for (rapidjson::SizeType i = 0; i < threadsJson.Size(); ++i) {
+                            if (!metadata->ctx->disableChecksSet(Ctx::DISABLE_CHECKS_JSON_TAGS)) {
+                                static const char* threadsChildNames[] = {"thread", "seq", "offset", "min-tran", nullptr};
+                                Ctx::checkJsonFields(fileName, threadsJson[i], threadsChildNames);
+                            }
+
+                            uint16_t thread = Ctx::getJsonFieldU16(fileName, threadsJson[i], "thread");
+                            typeSeq threadSequence = Ctx::getJsonFieldU32(fileName, threadsJson[i], "seq");
+                            uint64_t threadOffset = Ctx::getJsonFieldU64(fileName, threadsJson[i], "offset");
+                            if (document.HasMember("transactions"))
+                                metadata->threadTransactionsPositions.insert_or_assign(thread, std::make_pair(threadSequence, threadOffset));
+
+                            // Like for a single thread, the redo thread is read again from its oldest open transaction
+                            if (threadsJson[i].HasMember("min-tran")) {
+                                const rapidjson::Value& minTranJson = Ctx::getJsonFieldO(fileName, threadsJson[i], "min-tran");
+                                if (!metadata->ctx->disableChecksSet(Ctx::DISABLE_CHECKS_JSON_TAGS)) {
+                                    static const char* minTranJsonChildNames[] = {"seq", "offset", "xid", nullptr};
+                                    Ctx::checkJsonFields(fileName, minTranJson, minTranJsonChildNames);
+                                }
+
+                                threadSequence = Ctx::getJsonFieldU32(fileName, minTranJson, "seq");
+                                threadOffset = Ctx::getJsonFieldU64(fileName, minTranJson, "offset");
+                            }
+
+                            if (unlikely((threadOffset & 511) != 0))
+                                throw DataException(20006, "file: " + fileName + " - invalid offset: " + std::to_string(threadOffset) +
+                                                           " is not a multiplication of 512");
+                            metadata->threadPositions.insert_or_assign(thread, std::make_pair(threadSequence, threadOffset));
+                        }
+                    }
+
                     metadata->minSequence = Ctx::ZERO_SEQ;
                     metadata->minOffset = 0;
                     metadata->minXid = 0;
@@ -0,0 +1,155 @@
+/* Thread formatting committed transactions in parallel to the flush thread
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <thread>
+
+#include "../builder/Builder.h"
+#include "../common/Clock.h"
+#include "../common/Ctx.h"
+#include "../common/exception/DataException.h"
+#include "../common/exception/RedoLogException.h"
+#include "../common/exception/RuntimeException.h"
+#include "../common/metrics/Metrics.h"
+#include "FormatWorker.h"
+#include "Transaction.h"
+
+namespace OpenLogReplicator {
+    FormatWorker::FormatWorker(Ctx* newCtx, Builder* newBuilder, Metadata* newMetadata, TransactionBuffer* newTransactionBuffer,
+                               const std::string& newAlias) :
+            Thread(newCtx, newAlias),
+            metadata(newMetadata),
+            transactionBuffer(newTransactionBuffer),
+            transaction(nullptr),
+            lwnScn(Ctx::ZERO_SCN),
+            formatted(false),
+            shutdown(false),
+            builder(newBuilder) {
+    }
+
+    FormatWorker::~FormatWorker() {
+    }
+
+    bool FormatWorker::assign(Transaction* newTransaction, typeScn newLwnScn) {
+        std::unique_lock<std::mutex> lck(mtx);
+        if (shutdown)
+            return false;
+
+        transaction = newTransaction;
+        lwnScn = newLwnScn;
+        formatted = false;
+        condWorker.notify_all();
+        return true;
+    }
+
+    bool FormatWorker::wait() {
+        std::unique_lock<std::mutex> lck(mtx);
+        while (!formatted && !shutdown && !ctx->hardShutdown) {
+            if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
+                ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "FormatWorker:wait");
+            condFlusher.wait(lck);
+        }
+
+        if (!formatted)
+            return false;
+        formatted = false;
+        return true;
+    }
+
+    void FormatWorker::stop() {
+        std::unique_lock<std::mutex> lck(mtx);
+        shutdown = true;
+        condWorker.notify_all();
+        condFlusher.notify_all();
+    }
+
+    void FormatWorker::wakeUp() {
+        std::unique_lock<std::mutex> lck(mtx);
+        condWorker.notify_all();
+        condFlusher.notify_all();
+    }
+
+    void FormatWorker::mainLoop() {
+        while (true) {
+            Transaction* currentTransaction;
+            typeScn currentLwnScn;
+            {
+                std::unique_lock<std::mutex> lck(mtx);
+                while (transaction == nullptr && !shutdown && !ctx->hardShutdown) {
+                    if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
+                        ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "FormatWorker:mainLoop:idle");
+                    condWorker.wait(lck);
+                }
+
+                // An assigned transaction is always formatted, the flush thread waits for it
+                if (transaction == nullptr)
+                    break;
+                currentTransaction = transaction;
+                currentLwnScn = lwnScn;
+            }
+
+            time_ut start = ctx->clock->getTimeUt();
+            currentTransaction->flush(metadata, transactionBuffer, builder, currentLwnScn);
+            if (ctx->metrics != nullptr)
+                ctx->metrics->emitFlushTimeUs(ctx->clock->getTimeUt() - start);
+
+            {
+                std::unique_lock<std::mutex> lck(mtx);
+                transaction = nullptr;
+                formatted = true;
+                condFlusher.notify_all();
+            }
+        }
+    }
+
+    void FormatWorker::run() {
+        if (unlikely(ctx->trace & Ctx::TRACE_THREADS)) {
+            std::ostringstream ss;
+            ss << std::this_thread::get_id();
+            ctx->OLR_TRACE(Ctx::TRACE_THREADS, "format worker (" + ss.str() + ") start");
+        }
+
+        try {
+            mainLoop();
+        } catch (DataException& ex) {
+            ctx->OLR_ERROR(ex.code, ex.msg);
+            ctx->stopHard();
+        } catch (RedoLogException& ex) {
+            ctx->OLR_ERROR(ex.code, ex.msg);
+            ctx->stopHard();
+        } catch (RuntimeException& ex) {
+            ctx->OLR_ERROR(ex.code, ex.msg);
+            ctx->stopHard();
+        } catch (std::bad_alloc& ex) {
+            ctx->OLR_ERROR(10018, "memory allocation failed: " + std::string(ex.what()));
+            ctx->stopHard();
+        }
+
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            shutdown = true;
+            condFlusher.notify_all();
+        }
+
+        if (unlikely(ctx->trace & Ctx::TRACE_THREADS)) {
+            std::ostringstream ss;
+            ss << std::this_thread::get_id();
+            ctx->OLR_TRACE(Ctx::TRACE_THREADS, "format worker (" + ss.str() + ") stop");
+        }
+    }
+}
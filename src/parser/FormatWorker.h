@@ -0,0 +1,71 @@
+/* Header for FormatWorker class
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <condition_variable>
+#include <mutex>
+
+#include "../common/Thread.h"
+#include "../common/types.h"
+
+#ifndef FORMAT_WORKER_H_
+#define FORMAT_WORKER_H_
+
+namespace OpenLogReplicator {
+    class Builder;
+    class Metadata;
+    class Transaction;
+    class TransactionBuffer;
+
+    class FormatWorker final : public Thread {
+    protected:
+        Metadata* metadata;
+        TransactionBuffer* transactionBuffer;
+        std::mutex mtx;
+        std::condition_variable condWorker;
+        std::condition_variable condFlusher;
+        Transaction* transaction;
+        typeScn lwnScn;
+        bool formatted;
+        bool shutdown;
+
+        void mainLoop();
+
+    public:
+        // Private builder, the messages are moved to the output queue by the flush thread
+        Builder* builder;
+
+        FormatWorker(Ctx* newCtx, Builder* newBuilder, Metadata* newMetadata, TransactionBuffer* newTransactionBuffer, const std::string& newAlias);
+        ~FormatWorker() override;
+
+        /// @brief Pass a committed transaction to format, the worker must be idle.
+        /// @param newTransaction transaction, already removed from the transaction buffer
+        /// @param newLwnScn scn of the LWN with the commit
+        /// @return false if the thread has stopped
+        bool assign(Transaction* newTransaction, typeScn newLwnScn);
+
+        /// @brief Wait until the assigned transaction is formatted.
+        /// @return false if the thread has stopped, the transaction may be still used
+        bool wait();
+        void stop();
+        void wakeUp() override;
+        void run() override;
+    };
+}
+
+#endif
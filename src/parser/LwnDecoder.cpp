@@ -0,0 +1,121 @@
+/* Thread decoding redo records of an LWN in parallel to the parser
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <thread>
+
+#include "../common/Ctx.h"
+#include "../common/exception/RuntimeException.h"
+#include "LwnDecoder.h"
+#include "Parser.h"
+
+namespace OpenLogReplicator {
+    LwnDecoder::LwnDecoder(Ctx* newCtx, const std::string& newAlias) :
+            Thread(newCtx, newAlias),
+            lwnBatch(nullptr),
+            shutdown(false) {
+    }
+
+    LwnDecoder::~LwnDecoder() {
+    }
+
+    bool LwnDecoder::assign(LwnBatch* newLwnBatch) {
+        std::unique_lock<std::mutex> lck(mtx);
+        if (shutdown)
+            return false;
+
+        lwnBatch = newLwnBatch;
+        condDecoder.notify_all();
+        return true;
+    }
+
+    bool LwnDecoder::revoke(LwnBatch* oldLwnBatch) {
+        std::unique_lock<std::mutex> lck(mtx);
+        if (lwnBatch != oldLwnBatch)
+            return false;
+
+        lwnBatch = nullptr;
+        return true;
+    }
+
+    void LwnDecoder::stop() {
+        std::unique_lock<std::mutex> lck(mtx);
+        shutdown = true;
+        condDecoder.notify_all();
+    }
+
+    void LwnDecoder::wakeUp() {
+        std::unique_lock<std::mutex> lck(mtx);
+        condDecoder.notify_all();
+    }
+
+    void LwnDecoder::mainLoop() {
+        while (true) {
+            LwnBatch* currentLwnBatch;
+            {
+                std::unique_lock<std::mutex> lck(mtx);
+                while (lwnBatch == nullptr && !shutdown && !ctx->hardShutdown) {
+                    if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
+                        ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "LwnDecoder:mainLoop:idle");
+                    condDecoder.wait(lck);
+                }
+
+                // An assigned batch is always decoded, the parser waits for it
+                if (lwnBatch == nullptr) {
+                    shutdown = true;
+                    break;
+                }
+                currentLwnBatch = lwnBatch;
+                lwnBatch = nullptr;
+            }
+
+            // Errors are passed to the parser with the decoded member
+            currentLwnBatch->parser->decodeLwnBatch();
+            --currentLwnBatch->active;
+        }
+    }
+
+    void LwnDecoder::run() {
+        if (unlikely(ctx->trace & Ctx::TRACE_THREADS)) {
+            std::ostringstream ss;
+            ss << std::this_thread::get_id();
+            ctx->OLR_TRACE(Ctx::TRACE_THREADS, "lwn decoder (" + ss.str() + ") start");
+        }
+
+        try {
+            mainLoop();
+        } catch (RuntimeException& ex) {
+            ctx->OLR_ERROR(ex.code, ex.msg);
+            ctx->stopHard();
+        } catch (std::bad_alloc& ex) {
+            ctx->OLR_ERROR(10018, "memory allocation failed: " + std::string(ex.what()));
+            ctx->stopHard();
+        }
+
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            shutdown = true;
+        }
+
+        if (unlikely(ctx->trace & Ctx::TRACE_THREADS)) {
+            std::ostringstream ss;
+            ss << std::this_thread::get_id();
+            ctx->OLR_TRACE(Ctx::TRACE_THREADS, "lwn decoder (" + ss.str() + ") stop");
+        }
+    }
+}
@@ -0,0 +1,52 @@
+/* Header for LwnDecoder class
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <condition_variable>
+#include <mutex>
+
+#include "../common/Thread.h"
+
+#ifndef LWN_DECODER_H_
+#define LWN_DECODER_H_
+
+namespace OpenLogReplicator {
+    struct LwnBatch;
+
+    class LwnDecoder final : public Thread {
+    protected:
+        std::mutex mtx;
+        std::condition_variable condDecoder;
+        LwnBatch* lwnBatch;
+        bool shutdown;
+
+        void mainLoop();
+
+    public:
+        LwnDecoder(Ctx* newCtx, const std::string& newAlias);
+        ~LwnDecoder() override;
+
+        bool assign(LwnBatch* newLwnBatch);
+        bool revoke(LwnBatch* oldLwnBatch);
+        void stop();
+        void wakeUp() override;
+        void run() override;
+    };
+}
+
+#endif
@@ -297,6 +297,29 @@ namespace OpenLogReplicator {
         }
     }
 
+    bool OpCode0501::identify0501(const Ctx* ctx, RedoLogRecord* redoLogRecord) {
+        // Only the transaction and the object are read, the rest of the vector may never be needed
+        typePos fieldPos = 0;
+        typeField fieldNum = 0;
+        typeSize fieldSize = 0;
+        if (!RedoLogRecord::nextFieldOpt(ctx, redoLogRecord, fieldNum, fieldPos, fieldSize, 0x05011D) || fieldSize < 20)
+            return false;
+        // Field: 1
+        redoLogRecord->xid = typeXid(static_cast<typeUsn>(ctx->read16(redoLogRecord->data() + fieldPos + 8)),
+                                     ctx->read16(redoLogRecord->data() + fieldPos + 10),
+                                     ctx->read32(redoLogRecord->data() + fieldPos + 12));
+
+        if (!RedoLogRecord::nextFieldOpt(ctx, redoLogRecord, fieldNum, fieldPos, fieldSize, 0x05011E) || fieldSize < 24)
+            return false;
+        // Field: 2
+        redoLogRecord->obj = ctx->read32(redoLogRecord->data() + fieldPos + 0);
+        redoLogRecord->dataObj = ctx->read32(redoLogRecord->data() + fieldPos + 4);
+        redoLogRecord->opc = (static_cast<typeOp1>(redoLogRecord->data()[fieldPos + 16]) << 8) | redoLogRecord->data()[fieldPos + 17];
+        redoLogRecord->slt = redoLogRecord->data()[fieldPos + 18];
+        redoLogRecord->flg = ctx->read16(redoLogRecord->data() + fieldPos + 20);
+        return true;
+    }
+
     void OpCode0501::process0501(Ctx* ctx, RedoLogRecord* redoLogRecord) {
         init(ctx, redoLogRecord);
         OpCode::process(ctx, redoLogRecord);
@@ -36,6 +36,7 @@ namespace OpenLogReplicator {
         static void opc0D17(const Ctx* ctx, RedoLogRecord* redoLogRecord, typeField& fieldNum, typePos& fieldPos, typeSize& fieldSize);
 
     public:
+        static bool identify0501(const Ctx* ctx, RedoLogRecord* redoLogRecord);
         static void process0501(Ctx* ctx, RedoLogRecord* redoLogRecord);
     };
 }
@@ -17,6 +17,9 @@ You should have received a copy of the GNU General Public License
 along with OpenLogReplicator; see the file LICENSE;  If not see
 <http://www.gnu.org/licenses/>.  */
 
+#include <algorithm>
+#include <thread>
+
 #include "../builder/Builder.h"
 #include "../common/Clock.h"
 #include "../common/LobCtx.h"
@@ -28,6 +31,8 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #include "../metadata/Metadata.h"
 #include "../metadata/Schema.h"
 #include "../reader/Reader.h"
+#include "../replicator/BatchWorker.h"
+#include "LwnDecoder.h"
 #include "OpCode0501.h"
 #include "OpCode0502.h"
 #include "OpCode0504.h"
@@ -55,6 +60,7 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #include "Parser.h"
 #include "Transaction.h"
 #include "TransactionBuffer.h"
+#include "TransactionFlusher.h"
 
 namespace OpenLogReplicator {
 
@@ -62,7 +68,10 @@ namespace OpenLogReplicator {
             ctx(newCtx),
             lwnAllocated(0),
             lwnAllocatedMax(0),
-            lwnRecords(0) {
+            lwnRecords(0),
+            lwnFirst(1),
+            lwnRuns(0),
+            lwnHeap(false) {
         lwnChunks[0] = ctx->getMemoryChunk(Ctx::MEMORY_MODULE_PARSER, false);
         auto size = reinterpret_cast<uint64_t*>(lwnChunks[0]);
         *size = sizeof(uint64_t);
@@ -85,10 +94,10 @@ namespace OpenLogReplicator {
         }
     }
 
-    LwnMember* LwnMembersManager::allocateLwnMember(uint64_t recordSize4) {
+    uint8_t* LwnMembersManager::allocate(uint64_t size) {
         uint64_t* recordSize = reinterpret_cast<uint64_t*>(lwnChunks[lwnAllocated - 1]);
 
-        if (((*recordSize + sizeof(struct LwnMember) + recordSize4 + 7) & 0xFFFFFFF8) > Ctx::MEMORY_CHUNK_SIZE) {
+        if (((*recordSize + size + 7) & 0xFFFFFFF8) > Ctx::MEMORY_CHUNK_SIZE) {
             if (unlikely(lwnAllocated == MAX_LWN_CHUNKS))
                 throw RedoLogException(50052, "all " + std::to_string(MAX_LWN_CHUNKS) + " lwn buffers allocated");
 
@@ -97,29 +106,109 @@ namespace OpenLogReplicator {
             *recordSize = sizeof(uint64_t);
         }
 
-        if (unlikely(((*recordSize + sizeof(struct LwnMember) + recordSize4 + 7) & 0xFFFFFFF8) > Ctx::MEMORY_CHUNK_SIZE))
-            throw RedoLogException(50053, "too big redo log record, size: " + std::to_string(recordSize4));
+        if (unlikely(((*recordSize + size + 7) & 0xFFFFFFF8) > Ctx::MEMORY_CHUNK_SIZE))
+            throw RedoLogException(50053, "too big redo log record, size: " + std::to_string(size));
 
-        LwnMember* result = reinterpret_cast<struct LwnMember*>(lwnChunks[lwnAllocated - 1] + *recordSize);
-        *recordSize += (sizeof(struct LwnMember) + recordSize4 + 7) & 0xFFFFFFF8;
+        uint8_t* result = lwnChunks[lwnAllocated - 1] + *recordSize;
+        *recordSize += (size + 7) & 0xFFFFFFF8;
 
         return result;
     }
 
+    LwnMember* LwnMembersManager::allocateLwnMember(uint64_t recordSize4) {
+        auto result = reinterpret_cast<struct LwnMember*>(allocate(sizeof(struct LwnMember) + recordSize4));
+        result->data = reinterpret_cast<uint8_t*>(result) + sizeof(struct LwnMember);
+        return result;
+    }
+
+    void LwnMembersManager::copyLwnMembers() {
+        // Members pointing to the read buffer get their own copy, so that the buffer can be released
+        for (uint64_t lwnPos = lwnFirst; lwnPos < lwnFirst + lwnRecords; ++lwnPos) {
+            LwnMember* lwnMember = lwnMembers[lwnPos];
+            if (lwnMember->data == reinterpret_cast<uint8_t*>(lwnMember) + sizeof(struct LwnMember))
+                continue;
+
+            uint8_t* data = allocate(lwnMember->size);
+            memcpy(reinterpret_cast<void*>(data), reinterpret_cast<const void*>(lwnMember->data), lwnMember->size);
+            lwnMember->data = data;
+        }
+    }
+
     void LwnMembersManager::addLwnMember(LwnMember* lwnMember) {
-        uint64_t lwnPos = ++lwnRecords;
+        uint64_t lwnPos = lwnFirst + lwnRecords;
         if (unlikely(lwnPos >= MAX_RECORDS_IN_LWN))
             throw RedoLogException(50054, "all " + std::to_string(lwnPos) + " records in lwn were used");
 
-        // make heap
-        while (lwnPos > 1 && *lwnMember < *lwnMembers[lwnPos / 2]) { 
+        if (lwnHeap) {
+            heapPush(lwnMember);
+            return;
+        }
+
+        // Records come almost always in order, so they are appended to the last run
+        lwnMembers[lwnPos] = lwnMember;
+        ++lwnRecords;
+        if (lwnRecords == 1 || !(*lwnMember < *lwnMembers[lwnPos - 1]))
+            return;
+
+        if (lwnRuns < MAX_LWN_RUNS) {
+            lwnRunStart[lwnRuns++] = lwnPos;
+            return;
+        }
+        makeHeap();
+    }
+
+    void LwnMembersManager::heapPush(LwnMember* lwnMember) {
+        uint64_t lwnPos = ++lwnRecords;
+        while (lwnPos > 1 && *lwnMember < *lwnMembers[lwnPos / 2]) {
             lwnMembers[lwnPos] = lwnMembers[lwnPos / 2];
             lwnPos = lwnPos / 2;
         }
         lwnMembers[lwnPos] = lwnMember;
     }
 
+    void LwnMembersManager::makeHeap() {
+        if (lwnFirst > 1) {
+            memmove(reinterpret_cast<void*>(lwnMembers + 1), reinterpret_cast<const void*>(lwnMembers + lwnFirst),
+                    lwnRecords * sizeof(LwnMember*));
+            lwnFirst = 1;
+        }
+
+        // Every member is only moved towards the root, so the heap is built in place
+        uint64_t records = lwnRecords;
+        lwnRecords = 0;
+        lwnRuns = 0;
+        lwnHeap = true;
+        for (uint64_t lwnPos = 1; lwnPos <= records; ++lwnPos)
+            heapPush(lwnMembers[lwnPos]);
+    }
+
+    void LwnMembersManager::mergeRuns() {
+        // Only the out of order tail is sorted, then it is merged into the first run from the end
+        uint64_t lwnEnd = lwnFirst + lwnRecords;
+        lwnTail.assign(lwnMembers + lwnRunStart[0], lwnMembers + lwnEnd);
+        std::sort(lwnTail.begin(), lwnTail.end(), [](const LwnMember* a, const LwnMember* b) { return *a < *b; });
+
+        uint64_t lwnPos = lwnEnd;
+        uint64_t lwnRunEnd = lwnRunStart[0];
+        uint64_t tailPos = lwnTail.size();
+        while (tailPos > 0) {
+            if (lwnRunEnd > lwnFirst && *lwnTail[tailPos - 1] < *lwnMembers[lwnRunEnd - 1])
+                lwnMembers[--lwnPos] = lwnMembers[--lwnRunEnd];
+            else
+                lwnMembers[--lwnPos] = lwnTail[--tailPos];
+        }
+        lwnRuns = 0;
+    }
+
     void LwnMembersManager::dropMin() {
+        if (!lwnHeap) {
+            if (lwnRuns > 0)
+                mergeRuns();
+            ++lwnFirst;
+            --lwnRecords;
+            return;
+        }
+
         uint64_t lwnPos = 1;
         while (true) {
             uint64_t left = lwnPos * 2, right = lwnPos * 2 + 1;
@@ -146,6 +235,9 @@ namespace OpenLogReplicator {
 
     void LwnMembersManager::reset() {
         lwnRecords = 0;
+        lwnFirst = 1;
+        lwnRuns = 0;
+        lwnHeap = false;
     }
 
     uint64_t LwnMembersManager::maxAllocated() const {
@@ -157,7 +249,17 @@ namespace OpenLogReplicator {
     }
 
     LwnMember* LwnMembersManager::getMinLwnMember() {
-        return lwnMembers[1];
+        if (lwnRuns > 0)
+            mergeRuns();
+        return lwnMembers[lwnFirst];
+    }
+
+    void LwnMembersManager::detachChunks(std::vector<uint8_t*>& chunks) {
+        // The last chunk is still being filled, it is handed over with a later LWN
+        for (uint64_t i = 0; i < lwnAllocated - 1; ++i)
+            chunks.push_back(lwnChunks[i]);
+        lwnChunks[0] = lwnChunks[lwnAllocated - 1];
+        lwnAllocated = 1;
     }
 
     void LwnMembersManager::allocateChunk() {
@@ -178,30 +280,57 @@ namespace OpenLogReplicator {
             lwnTimestamp(0),
             lwnScn(0),
             lwnCheckpointBlock(0),
+            lwnRecord(nullptr),
+            recordPos(0),
+            recordLeftToCopy(0),
+            lwnEndBlock(0),
+            lwnZeroCopyBlock(Ctx::ZERO_BLK),
+            releasedBufferStart(0),
+            lwnZeroCopy(false),
+            lwnNumMax(0),
+            lwnNumCnt(0),
+            replayConfirmedBlock(0),
+            replayStartBlock(0),
+            replayCurrentBlock(0),
+            replayStart(0),
             group(newGroup),
             path(newPath),
             sequence(0),
+            thread(0),
+            mergeThreads(false),
             firstScn(Ctx::ZERO_SCN),
             nextScn(Ctx::ZERO_SCN),
-            reader(nullptr) {
+            reader(nullptr),
+            decoders(nullptr),
+            flusher(nullptr) {
         memset(reinterpret_cast<void*>(&zero), 0, sizeof(RedoLogRecord));
+        lwnBatch.parser = this;
+        lwnBatch.start = 0;
+        lwnBatch.end = 0;
+        lwnBatch.next = 0;
+        lwnBatch.active = 0;
     }
 
     Parser::~Parser() {
+        for (LwnDecoded* lwnDecoded: lwnBatch.decoded)
+            delete lwnDecoded;
+        lwnBatch.decoded.clear();
     }
 
     void Parser::freeLwn() {
         lwnManager.freeLwnMembers();
     }
 
-    void Parser::analyzeLwn(LwnMember* lwnMember) {
+    void Parser::analyzeLwn(LwnMember* lwnMember, LwnDecoded* lwnDecoded) {
         if (unlikely(ctx->trace & Ctx::TRACE_LWN))
             ctx->OLR_TRACE(Ctx::TRACE_LWN, "analyze blk: " + std::to_string(lwnMember->block) + " offset: " +
                                           std::to_string(lwnMember->offset) + " scn: " + std::to_string(lwnMember->scn) + " subscn: " +
                                           std::to_string(lwnMember->subScn));
 
-        uint8_t* data = reinterpret_cast<uint8_t*>(lwnMember) + sizeof(struct LwnMember);
-        RedoLogRecord redoLogRecord[2];
+        uint8_t* data = lwnMember->data;
+        // Without decoders the changes are applied at once and two vectors are enough
+        RedoLogRecord redoLogRecordPair[2];
+        RedoLogRecord* redoLogRecord = redoLogRecordPair;
         int64_t vectorCur = -1;
         if (unlikely(ctx->trace & Ctx::TRACE_LWN))
             ctx->OLR_TRACE(Ctx::TRACE_LWN, "analyze size: " + std::to_string(lwnMember->size) + " scn: " + std::to_string(lwnMember->scn) +
@@ -222,13 +351,12 @@ namespace OpenLogReplicator {
             headerSize = 24;
 
         if (unlikely(ctx->dumpRedoLog >= 1)) {
-            uint16_t thread = 1; // TODO: verify field size/position
             *ctx->dumpStream << " \n";
 
             *ctx->dumpStream << "########################################################\n";
             *ctx->dumpStream << "#                     REDO RECORD                      #\n";
             *ctx->dumpStream << "########################################################\n";
-            *ctx->dumpStream << "Thread:" << thread << " RBA: 0x" << std::setfill('0') << std::setw(6) << std::hex << sequence << "." <<
+            *ctx->dumpStream << "Thread:" << std::dec << reader->getThread() << " RBA: 0x" << std::setfill('0') << std::setw(6) << std::hex << sequence << "." <<
                             std::setfill('0') << std::setw(8) << std::hex << lwnMember->block << "." << std::setfill('0') << std::setw(4) <<
                             std::hex << lwnMember->offset << " LEN: 0x" << std::setfill('0') << std::setw(4) << std::hex << recordSize << " VLD: 0x" <<
                             std::setfill('0') << std::setw(2) << std::hex << static_cast<uint64_t>(vld);
@@ -292,10 +420,17 @@ namespace OpenLogReplicator {
 
         uint64_t offset = headerSize;
         uint64_t vectors = 0;
+        bool vectorFiltered = false;
 
         while (offset < recordSize) {
             int64_t vectorPrev = vectorCur;
-            vectorCur = (vectorPrev + 1) % 2;
+            if (lwnDecoded == nullptr) {
+                vectorCur = (vectorPrev + 1) % 2;
+            } else {
+                vectorCur = static_cast<int64_t>(lwnDecoded->records.size());
+                lwnDecoded->records.emplace_back();
+                redoLogRecord = lwnDecoded->records.data();
+            }
 
             memset(reinterpret_cast<void*>(&redoLogRecord[vectorCur]), 0, sizeof(RedoLogRecord));
             redoLogRecord[vectorCur].vectorNo = (++vectors);
@@ -379,9 +514,21 @@ namespace OpenLogReplicator {
             redoLogRecord[vectorCur].recordDataObj = 0xFFFFFFFF;
             offset += redoLogRecord[vectorCur].size;
 
+            // Both vectors of a filtered out change are decoded only if needed when applied
+            if (vectorFiltered) {
+                vectorFiltered = false;
+                lwnAction(lwnDecoded, redoLogRecord, LWN_ACTION_FILTER, vectorPrev, vectorCur);
+                vectorCur = -1;
+                continue;
+            }
+
             switch (redoLogRecord[vectorCur].opCode) {
                 case 0x0501:
                     // Undo
+                    if (filterUndo(&redoLogRecord[vectorCur], data + offset, recordSize - offset)) {
+                        vectorFiltered = true;
+                        break;
+                    }
                     OpCode0501::process0501(ctx, &redoLogRecord[vectorCur]);
                     break;
 
@@ -406,12 +553,12 @@ namespace OpenLogReplicator {
 
                 case 0x0513:
                     // Session information
-                    OpCode0513::process0513(ctx, &redoLogRecord[vectorCur], lastTransaction);
+                    lwnAction(lwnDecoded, redoLogRecord, LWN_ACTION_SESSION_0513, vectorCur);
                     break;
 
                     // Session information
                 case 0x0514:
-                    OpCode0514::process0514(ctx, &redoLogRecord[vectorCur], lastTransaction);
+                    lwnAction(lwnDecoded, redoLogRecord, LWN_ACTION_SESSION_0514, vectorCur);
                     break;
 
                 case 0x0A02:
@@ -563,14 +710,14 @@ namespace OpenLogReplicator {
                 if (redoLogRecord[vectorPrev].opCode == 0x0501) {
                     if ((redoLogRecord[vectorCur].opCode & 0xFF00) == 0x0A00 || redoLogRecord[vectorCur].opCode == 0x1A02) {
                         // UNDO - index
-                        appendToTransactionIndex(&redoLogRecord[vectorPrev], &redoLogRecord[vectorCur]);
+                        lwnAction(lwnDecoded, redoLogRecord, LWN_ACTION_INDEX, vectorPrev, vectorCur);
                     } else if ((redoLogRecord[vectorCur].opCode & 0xFF00) == 0x0B00 || redoLogRecord[vectorCur].opCode == 0x0513 ||
                                redoLogRecord[vectorCur].opCode == 0x0514) {
                         // UNDO - data
-                        appendToTransaction(&redoLogRecord[vectorPrev], &redoLogRecord[vectorCur]);
+                        lwnAction(lwnDecoded, redoLogRecord, LWN_ACTION_APPEND_PAIR, vectorPrev, vectorCur);
                     } else if (redoLogRecord[vectorCur].opCode == 0x0501) {
                         // Single 5.1
-                        appendToTransaction(&redoLogRecord[vectorPrev]);
+                        lwnAction(lwnDecoded, redoLogRecord, LWN_ACTION_APPEND, vectorPrev);
                         continue;
                     } else if (redoLogRecord[vectorPrev].opc == 0x0B01)
                         ctx->OLR_WARN(70010, "unknown undo OP: " + std::to_string(static_cast<uint64_t>(redoLogRecord[vectorCur].opCode >> 8)) +
@@ -583,7 +730,7 @@ namespace OpenLogReplicator {
 
                 if ((redoLogRecord[vectorCur].opCode == 0x0506 || redoLogRecord[vectorCur].opCode == 0x050B)) {
                     if ((redoLogRecord[vectorPrev].opCode & 0xFF00) == 0x0B00)
-                        appendToTransactionRollback(&redoLogRecord[vectorPrev], &redoLogRecord[vectorCur]);
+                        lwnAction(lwnDecoded, redoLogRecord, LWN_ACTION_ROLLBACK_PAIR, vectorPrev, vectorCur);
                     else if (redoLogRecord[vectorCur].opc == 0x0B01)
                         ctx->OLR_WARN(70011, "unknown rollback OP: " + std::to_string(static_cast<uint64_t>(redoLogRecord[vectorCur].opCode >> 8)) +
                                             "." + std::to_string(static_cast<uint64_t>(redoLogRecord[vectorCur].opCode & 0xFF)) + ", opc: " +
@@ -597,42 +744,42 @@ namespace OpenLogReplicator {
             // UNDO - data
             if (redoLogRecord[vectorCur].opCode == 0x0501 &&
                     (redoLogRecord[vectorCur].flg & (OpCode::FLG_MULTIBLOCKUNDOTAIL | OpCode::FLG_MULTIBLOCKUNDOMID)) != 0) {
-                appendToTransaction(&redoLogRecord[vectorCur]);
+                lwnAction(lwnDecoded, redoLogRecord, LWN_ACTION_APPEND, vectorCur);
                 vectorCur = -1;
                 continue;
             }
 
             // ROLLBACK - data
             if (redoLogRecord[vectorCur].opCode == 0x0506 || redoLogRecord[vectorCur].opCode == 0x050B) {
-                appendToTransactionRollback(&redoLogRecord[vectorCur]);
+                lwnAction(lwnDecoded, redoLogRecord, LWN_ACTION_ROLLBACK, vectorCur);
                 vectorCur = -1;
                 continue;
             }
 
             // BEGIN
             if (redoLogRecord[vectorCur].opCode == 0x0502) {
-                appendToTransactionBegin(&redoLogRecord[vectorCur]);
+                lwnAction(lwnDecoded, redoLogRecord, LWN_ACTION_BEGIN, vectorCur);
                 vectorCur = -1;
                 continue;
             }
 
             // COMMIT
             if (redoLogRecord[vectorCur].opCode == 0x0504) {
-                appendToTransactionCommit(&redoLogRecord[vectorCur]);
+                lwnAction(lwnDecoded, redoLogRecord, LWN_ACTION_COMMIT, vectorCur);
                 vectorCur = -1;
                 continue;
             }
 
             // LOB
             if (redoLogRecord[vectorCur].opCode == 0x1301 || redoLogRecord[vectorCur].opCode == 0x1A06) {
-                appendToTransactionLob(&redoLogRecord[vectorCur]);
+                lwnAction(lwnDecoded, redoLogRecord, LWN_ACTION_LOB, vectorCur);
                 vectorCur = -1;
                 continue;
             }
 
             // DDL
             if (redoLogRecord[vectorCur].opCode == 0x1801) {
-                appendToTransactionDdl(&redoLogRecord[vectorCur]);
+                lwnAction(lwnDecoded, redoLogRecord, LWN_ACTION_DDL, vectorCur);
                 vectorCur = -1;
                 continue;
             }
@@ -640,8 +787,102 @@ namespace OpenLogReplicator {
 
         // UNDO - data
         if (vectorCur != -1 && redoLogRecord[vectorCur].opCode == 0x0501) {
-            appendToTransaction(&redoLogRecord[vectorCur]);
+            lwnAction(lwnDecoded, redoLogRecord, LWN_ACTION_APPEND, vectorCur);
+        }
+    }
+
+    void Parser::lwnAction(LwnDecoded* lwnDecoded, RedoLogRecord* redoLogRecord, uint64_t type, int64_t vector1, int64_t vector2) {
+        LwnAction action = {type, vector1, vector2};
+        if (lwnDecoded == nullptr)
+            applyLwnAction(redoLogRecord, action);
+        else
+            lwnDecoded->actions.push_back(action);
+    }
+
+    void Parser::applyLwnAction(RedoLogRecord* redoLogRecord, const LwnAction& action) {
+        switch (action.type) {
+            case LWN_ACTION_APPEND:
+                appendToTransaction(&redoLogRecord[action.vector1]);
+                break;
+
+            case LWN_ACTION_APPEND_PAIR:
+                appendToTransaction(&redoLogRecord[action.vector1], &redoLogRecord[action.vector2]);
+                break;
+
+            case LWN_ACTION_BEGIN:
+                appendToTransactionBegin(&redoLogRecord[action.vector1]);
+                break;
+
+            case LWN_ACTION_COMMIT:
+                appendToTransactionCommit(&redoLogRecord[action.vector1]);
+                break;
+
+            case LWN_ACTION_DDL:
+                appendToTransactionDdl(&redoLogRecord[action.vector1]);
+                break;
+
+            case LWN_ACTION_INDEX:
+                appendToTransactionIndex(&redoLogRecord[action.vector1], &redoLogRecord[action.vector2]);
+                break;
+
+            case LWN_ACTION_LOB:
+                appendToTransactionLob(&redoLogRecord[action.vector1]);
+                break;
+
+            case LWN_ACTION_ROLLBACK:
+                appendToTransactionRollback(&redoLogRecord[action.vector1]);
+                break;
+
+            case LWN_ACTION_ROLLBACK_PAIR:
+                appendToTransactionRollback(&redoLogRecord[action.vector1], &redoLogRecord[action.vector2]);
+                break;
+
+            case LWN_ACTION_SESSION_0513:
+                // Session information refers to the last transaction, so it is decoded in order
+                OpCode0513::process0513(ctx, &redoLogRecord[action.vector1], lastTransaction);
+                break;
+
+            case LWN_ACTION_SESSION_0514:
+                OpCode0514::process0514(ctx, &redoLogRecord[action.vector1], lastTransaction);
+                break;
+
+            case LWN_ACTION_FILTER:
+                appendToTransactionFiltered(&redoLogRecord[action.vector1], &redoLogRecord[action.vector2]);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    bool Parser::filterUndo(RedoLogRecord* redoLogRecord1, const uint8_t* data2, uint64_t size2) {
+        if (ctx->dumpRedoLog > 0 || ctx->isFlagSet(Ctx::REDO_FLAGS_SCHEMALESS) || size2 < 2)
+            return false;
+
+        // Only row changes which are dropped later when the table is not in the dictionary
+        switch ((static_cast<typeOp1>(data2[0]) << 8) | data2[1]) {
+            case 0x0B02:
+            case 0x0B03:
+            case 0x0B05:
+            case 0x0B06:
+            case 0x0B08:
+            case 0x0B0B:
+            case 0x0B0C:
+            case 0x0B10:
+            case 0x0B16:
+                break;
+
+            default:
+                return false;
         }
+
+        if (!OpCode0501::identify0501(ctx, redoLogRecord1))
+            return false;
+        if ((redoLogRecord1->flg & (OpCode::FLG_MULTIBLOCKUNDOHEAD | OpCode::FLG_MULTIBLOCKUNDOTAIL | OpCode::FLG_MULTIBLOCKUNDOMID)) != 0 ||
+                redoLogRecord1->dataObj == 0)
+            return false;
+
+        return !metadata->schema->checkTableFilter(redoLogRecord1->obj);
     }
 
     void Parser::appendToTransactionDdl(RedoLogRecord* redoLogRecord1) {
@@ -657,7 +898,7 @@ namespace OpenLogReplicator {
 
         const OracleTable* table;
         {
-            std::unique_lock<std::mutex> lckTransaction(metadata->mtxTransaction);
+            std::shared_lock<std::shared_mutex> lckTransaction(metadata->mtxTransaction);
             table = metadata->schema->checkTableDict(redoLogRecord1->obj);
         }
 
@@ -676,12 +917,9 @@ namespace OpenLogReplicator {
         // Transaction size limit
         if (ctx->transactionSizeMax > 0 &&
             transaction->size + redoLogRecord1->size + TransactionChunk::ROW_HEADER_TOTAL >= ctx->transactionSizeMax) {
-            transactionBuffer->skipXidList.insert(transaction->xid);
-            transactionBuffer->dropTransaction(redoLogRecord1->xid, redoLogRecord1->conId);
-            transaction->purge(transactionBuffer);
             if (transaction == lastTransaction)
                 lastTransaction = nullptr;
-            delete transaction;
+            transactionBuffer->skipTransaction(transaction, redoLogRecord1->conId);
             return;
         }
 
@@ -691,7 +929,7 @@ namespace OpenLogReplicator {
     void Parser::appendToTransactionLob(RedoLogRecord* redoLogRecord1) {
         OracleLob* lob;
         {
-            std::unique_lock<std::mutex> lckTransaction(metadata->mtxTransaction);
+            std::shared_lock<std::shared_mutex> lckTransaction(metadata->mtxTransaction);
             lob = metadata->schema->checkLobDict(redoLogRecord1->dataObj);
         }
 
@@ -756,7 +994,7 @@ namespace OpenLogReplicator {
 
         const OracleTable* table;
         {
-            std::unique_lock<std::mutex> lckTransaction(metadata->mtxTransaction);
+            std::shared_lock<std::shared_mutex> lckTransaction(metadata->mtxTransaction);
             table = metadata->schema->checkTableDict(redoLogRecord1->obj);
         }
 
@@ -775,12 +1013,9 @@ namespace OpenLogReplicator {
         // Transaction size limit
         if (ctx->transactionSizeMax > 0 && transaction->size + redoLogRecord1->size + TransactionChunk::ROW_HEADER_TOTAL >= ctx->transactionSizeMax) {
             transaction->log(ctx, "siz ", redoLogRecord1);
-            transactionBuffer->skipXidList.insert(transaction->xid);
-            transactionBuffer->dropTransaction(redoLogRecord1->xid, redoLogRecord1->conId);
-            transaction->purge(transactionBuffer);
             if (transaction == lastTransaction)
                 lastTransaction = nullptr;
-            delete transaction;
+            transactionBuffer->skipTransaction(transaction, redoLogRecord1->conId);
             return;
         }
 
@@ -812,7 +1047,7 @@ namespace OpenLogReplicator {
 
         const OracleTable* table;
         {
-            std::unique_lock<std::mutex> lckTransaction(metadata->mtxTransaction);
+            std::shared_lock<std::shared_mutex> lckTransaction(metadata->mtxTransaction);
             table = metadata->schema->checkTableDict(redoLogRecord1->obj);
         }
 
@@ -838,20 +1073,14 @@ namespace OpenLogReplicator {
         Transaction* transaction = transactionBuffer->findTransaction(metadata->schema->xmlCtxDefault, redoLogRecord1->xid, redoLogRecord1->conId,
                                                                       false, true, false);
         transaction->begin = true;
-        transaction->firstSequence = sequence;
-        transaction->firstOffset = static_cast<uint64_t>(lwnCheckpointBlock) * reader->getBlockSize();
+        transactionBuffer->setTransactionPosition(transaction, thread, sequence, static_cast<uint64_t>(lwnCheckpointBlock) * reader->getBlockSize());
         transaction->log(ctx, "B   ", redoLogRecord1);
         lastTransaction = transaction;
     }
 
     void Parser::appendToTransactionCommit(RedoLogRecord* redoLogRecord1) {
         // Clean LOBs if used
-        for (auto lobIdToXidMapIt = ctx->lobIdToXidMap.cbegin(); lobIdToXidMapIt != ctx->lobIdToXidMap.cend();) {
-            if (lobIdToXidMapIt->second == redoLogRecord1->xid) {
-                lobIdToXidMapIt = ctx->lobIdToXidMap.erase(lobIdToXidMapIt);
-            } else
-                ++lobIdToXidMapIt;
-        }
+        transactionBuffer->dropLobIds(redoLogRecord1->xid, redoLogRecord1->conId);
 
         // Skip list
         auto skipXidListIt = transactionBuffer->skipXidList.find(redoLogRecord1->xid);
@@ -878,55 +1107,14 @@ namespace OpenLogReplicator {
         if ((redoLogRecord1->flg & OpCode::FLG_ROLLBACK_OP0504) != 0)
             transaction->rollback = true;
 
-        if ((transaction->commitScn > metadata->firstDataScn && !transaction->system) ||
-            (transaction->commitScn > metadata->firstSchemaScn && transaction->system)) {
-
-            if (transaction->begin) {
-                transaction->flush(metadata, transactionBuffer, builder, lwnScn);
-                if (ctx->metrics != nullptr) {
-                    if (transaction->rollback)
-                        ctx->metrics->emitTransactionsRollbackOut(1);
-                    else
-                        ctx->metrics->emitTransactionsCommitOut(1);
-                }
-
-                if (ctx->stopTransactions > 0 && metadata->isNewData(lwnScn, builder->lwnIdx)) {
-                    --ctx->stopTransactions;
-                    if (ctx->stopTransactions == 0) {
-                        ctx->OLR_INFO(0, "shutdown started - exhausted number of transactions");
-                        ctx->stopSoft();
-                    }
-                }
-
-                if (transaction->shutdown && metadata->isNewData(lwnScn, builder->lwnIdx)) {
-                    ctx->OLR_INFO(0, "shutdown started - initiated by debug transaction " + transaction->xid.toString() +
-                                 " at scn " + std::to_string(transaction->commitScn));
-                    ctx->stopSoft();
-                }
-            } else {
-                if (ctx->metrics != nullptr) {
-                    if (transaction->rollback)
-                        ctx->metrics->emitTransactionsRollbackPartial(1);
-                    else
-                        ctx->metrics->emitTransactionsCommitPartial(1);
-                }
-                ctx->OLR_WARN(60011, "skipping transaction with no beginning: " + transaction->toString());
-            }
-        } else {
-            if (ctx->metrics != nullptr) {
-                if (transaction->rollback)
-                    ctx->metrics->emitTransactionsRollbackSkip(1);
-                else
-                    ctx->metrics->emitTransactionsCommitSkip(1);
-            }
-            if (unlikely(ctx->trace & Ctx::TRACE_TRANSACTION))
-                ctx->OLR_TRACE(Ctx::TRACE_TRANSACTION, "skipping transaction already committed: " + transaction->toString());
-        }
-
         transactionBuffer->dropTransaction(redoLogRecord1->xid, redoLogRecord1->conId);
-        transaction->purge(transactionBuffer);
         lastTransaction = nullptr;
-        delete transaction;
+
+        FlushTask task{};
+        task.type = FlushTask::TYPE_TRANSACTION;
+        task.transaction = transaction;
+        task.lwnScn = lwnScn;
+        flusher->push(task);
     }
 
     void Parser::appendToTransaction(RedoLogRecord* redoLogRecord1, RedoLogRecord* redoLogRecord2) {
@@ -984,7 +1172,7 @@ namespace OpenLogReplicator {
                 // Logminer support - KDOCMP
                 const OracleTable* table;
                 {
-                    std::unique_lock<std::mutex> lckTransaction(metadata->mtxTransaction);
+                    std::shared_lock<std::shared_mutex> lckTransaction(metadata->mtxTransaction);
                     table = metadata->schema->checkTableDict(obj);
                 }
 
@@ -1016,18 +1204,86 @@ namespace OpenLogReplicator {
                 TransactionChunk::ROW_HEADER_TOTAL >= ctx->transactionSizeMax) {
             transaction->log(ctx, "siz1", redoLogRecord1);
             transaction->log(ctx, "siz2", redoLogRecord2);
-            transactionBuffer->skipXidList.insert(transaction->xid);
-            transactionBuffer->dropTransaction(redoLogRecord1->xid, redoLogRecord1->conId);
-            transaction->purge(transactionBuffer);
             if (transaction == lastTransaction)
                 lastTransaction = nullptr;
-            delete transaction;
+            transactionBuffer->skipTransaction(transaction, redoLogRecord1->conId);
             return;
         }
 
         transaction->add(metadata, transactionBuffer, redoLogRecord1, redoLogRecord2);
     }
 
+    void Parser::appendToTransactionFiltered(RedoLogRecord* redoLogRecord1, RedoLogRecord* redoLogRecord2) {
+        // The table could have been added to the dictionary after the vectors were filtered out
+        if (metadata->schema->checkTableFilter(redoLogRecord1->obj)) {
+            OpCode0501::process0501(ctx, redoLogRecord1);
+            redoLogRecord2->recordDataObj = redoLogRecord1->dataObj;
+            redoLogRecord2->recordObj = redoLogRecord1->obj;
+
+            switch (redoLogRecord2->opCode) {
+                case 0x0B02:
+                    OpCode0B02::process0B02(ctx, redoLogRecord2);
+                    break;
+
+                case 0x0B03:
+                    OpCode0B03::process0B03(ctx, redoLogRecord2);
+                    break;
+
+                case 0x0B05:
+                    OpCode0B05::process0B05(ctx, redoLogRecord2);
+                    break;
+
+                case 0x0B06:
+                    OpCode0B06::process0B06(ctx, redoLogRecord2);
+                    break;
+
+                case 0x0B08:
+                    OpCode0B08::process0B08(ctx, redoLogRecord2);
+                    break;
+
+                case 0x0B0B:
+                    OpCode0B0B::process0B0B(ctx, redoLogRecord2);
+                    break;
+
+                case 0x0B0C:
+                    OpCode0B0C::process0B0C(ctx, redoLogRecord2);
+                    break;
+
+                case 0x0B10:
+                    OpCode0B10::process0B10(ctx, redoLogRecord2);
+                    break;
+
+                case 0x0B16:
+                    OpCode0B16::process0B16(ctx, redoLogRecord2);
+                    break;
+            }
+
+            appendToTransaction(redoLogRecord1, redoLogRecord2);
+            return;
+        }
+
+        if (ctx->metrics)
+            ctx->metrics->emitBytesSkipped(redoLogRecord1->size + redoLogRecord2->size);
+
+        // Skip other PDB vectors
+        if (metadata->conId > 0 && redoLogRecord2->conId != metadata->conId)
+            return;
+
+        // Skip list
+        if (transactionBuffer->skipXidList.find(redoLogRecord1->xid) != transactionBuffer->skipXidList.end())
+            return;
+
+        // The transaction is registered as if the change was dropped after decoding
+        Transaction* transaction = transactionBuffer->findTransaction(metadata->schema->xmlCtxDefault, redoLogRecord1->xid, redoLogRecord1->conId,
+                                                                      true, ctx->isFlagSet(Ctx::REDO_FLAGS_SHOW_INCOMPLETE_TRANSACTIONS), false);
+        if (transaction == nullptr)
+            return;
+        lastTransaction = transaction;
+
+        transaction->log(ctx, "flt1", redoLogRecord1);
+        transaction->log(ctx, "flt2", redoLogRecord2);
+    }
+
     void Parser::appendToTransactionRollback(RedoLogRecord* redoLogRecord1, RedoLogRecord* redoLogRecord2) {
         // Skip other PDB vectors
         if (metadata->conId > 0 && redoLogRecord1->conId != metadata->conId)
@@ -1070,7 +1326,7 @@ namespace OpenLogReplicator {
 
         const OracleTable* table;
         {
-            std::unique_lock<std::mutex> lckTransaction(metadata->mtxTransaction);
+            std::shared_lock<std::shared_mutex> lckTransaction(metadata->mtxTransaction);
             table = metadata->schema->checkTableDict(obj);
         }
 
@@ -1152,7 +1408,7 @@ namespace OpenLogReplicator {
 
         const OracleLob* lob;
         {
-            std::unique_lock<std::mutex> lckTransaction(metadata->mtxTransaction);
+            std::shared_lock<std::shared_mutex> lckTransaction(metadata->mtxTransaction);
             lob = metadata->schema->checkLobIndexDict(dataObj);
         }
 
@@ -1269,6 +1525,7 @@ namespace OpenLogReplicator {
             if (unlikely(ctx->trace & Ctx::TRACE_LOB))
                 ctx->OLR_TRACE(Ctx::TRACE_LOB, "id: " + redoLogRecord2->lobId.lower() + " xid: " + redoLogRecord1->xid.toString() + " MAP");
             ctx->lobIdToXidMap.insert_or_assign(redoLogRecord2->lobId, redoLogRecord1->xid);
+            transaction->lobIdList.push_back(redoLogRecord2->lobId);
             transaction->lobCtx.checkOrphanedLobs(ctx, redoLogRecord2->lobId, redoLogRecord1->xid, redoLogRecord1->dataOffset);
         }
 
@@ -1282,12 +1539,9 @@ namespace OpenLogReplicator {
         // Transaction size limit
         if (ctx->transactionSizeMax > 0 &&
             transaction->size + redoLogRecord1->size + redoLogRecord2->size + TransactionChunk::ROW_HEADER_TOTAL >= ctx->transactionSizeMax) {
-            transactionBuffer->skipXidList.insert(transaction->xid);
-            transactionBuffer->dropTransaction(redoLogRecord1->xid, redoLogRecord1->conId);
-            transaction->purge(transactionBuffer);
             if (transaction == lastTransaction)
                 lastTransaction = nullptr;
-            delete transaction;
+            transactionBuffer->skipTransaction(transaction, redoLogRecord1->conId);
             return;
         }
 
@@ -1310,7 +1564,7 @@ namespace OpenLogReplicator {
         }
     }
 
-    uint64_t Parser::parse() {
+    typeBlk Parser::parseOffset() {
         typeBlk lwnConfirmedBlock = 2;
         lwnManager.reset();
 
@@ -1347,10 +1601,11 @@ namespace OpenLogReplicator {
                                                      std::to_string(lwnConfirmedBlock) + ")");
             metadata->offset = 0;
         }
-        reader->setBufferStartEnd(static_cast<uint64_t>(lwnConfirmedBlock) * reader->getBlockSize(),
-                                  static_cast<uint64_t>(lwnConfirmedBlock) * reader->getBlockSize());
+        return lwnConfirmedBlock;
+    }
 
-        ctx->OLR_INFO(0, "processing redo log: " + toString() + " offset: " + std::to_string(reader->getBufferStart()));
+    void Parser::parseHeader(uint64_t offset) {
+        ctx->OLR_INFO(0, "processing redo log: " + toString() + " offset: " + std::to_string(offset));
         if (ctx->isFlagSet(Ctx::REDO_FLAGS_ADAPTIVE_SCHEMA) && !metadata->schema->loaded && ctx->versionStr.length() > 0) {
             metadata->loadAdaptiveSchema();
             metadata->schema->loaded = true;
@@ -1367,231 +1622,374 @@ namespace OpenLogReplicator {
             ctx->OLR_INFO(0, "new activation detected: " + std::to_string(reader->getActivation()));
             metadata->setActivation(reader->getActivation());
         }
+    }
 
-        time_ut cStart = ctx->clock->getTimeUt();
-        reader->setStatusRead(); // allow reader to read blocks
-        uint64_t blockOffset;
-        uint64_t confirmedBufferStart = reader->getBufferStart();
-        uint64_t recordPos = 0;
-        uint64_t recordLeftToCopy = 0;
-        typeBlk startBlock = lwnConfirmedBlock;
-        typeBlk currentBlock = lwnConfirmedBlock;
-        typeBlk lwnEndBlock = lwnConfirmedBlock;
-        uint16_t lwnNumMax = 0;
-        uint16_t lwnNumCnt = 0;
-        lwnCheckpointBlock = lwnConfirmedBlock;
-        bool switchRedo = false;
+    void Parser::parseReset(typeBlk startBlock) {
+        lwnManager.reset();
+        recordPos = 0;
+        recordLeftToCopy = 0;
+        lwnEndBlock = startBlock;
+        lwnZeroCopyBlock = Ctx::ZERO_BLK;
+        releasedBufferStart = (static_cast<uint64_t>(startBlock) * reader->getBlockSize() / Ctx::MEMORY_CHUNK_SIZE) * Ctx::MEMORY_CHUNK_SIZE;
+        lwnNumMax = 0;
+        lwnNumCnt = 0;
+        lwnCheckpointBlock = startBlock;
+    }
 
-        while (!ctx->softShutdown) {
-            // There is some work to do
-            while (confirmedBufferStart < reader->getBufferEnd()) {
-                uint64_t redoBufferPos = (static_cast<uint64_t>(currentBlock) * reader->getBlockSize()) % Ctx::MEMORY_CHUNK_SIZE;
-                uint64_t redoBufferNum = ((static_cast<uint64_t>(currentBlock) * reader->getBlockSize()) / Ctx::MEMORY_CHUNK_SIZE) % ctx->readBufferMax;
-                const uint8_t* redoBlock = reader->redoBufferList[redoBufferNum] + redoBufferPos;
+    bool Parser::parseBlock(uint8_t* redoBlock, typeBlk currentBlock) {
+        uint64_t blockOffset = 16;
+        // New LWN block
+        if (currentBlock == lwnEndBlock) {
+            uint8_t vld = redoBlock[blockOffset + 4];
 
-                blockOffset = 16;
-                // New LWN block
-                if (currentBlock == lwnEndBlock) {
-                    uint8_t vld = redoBlock[blockOffset + 4];
+            if (unlikely((vld & 0x04) == 0)) {
+                throw RedoLogException(50051, "did not find lwn at offset: " + std::to_string(static_cast<uint64_t>(currentBlock) *
+                                                                                              reader->getBlockSize()));
+            }
 
-                    if (unlikely((vld & 0x04) == 0)) {
-                        throw RedoLogException(50051, "did not find lwn at offset: " + std::to_string(confirmedBufferStart));
-                    }
+            uint16_t lwnNum = ctx->read16(redoBlock + blockOffset + 24);
+            uint32_t lwnSize = ctx->read32(redoBlock + blockOffset + 28);
+            lwnEndBlock = currentBlock + lwnSize;
+            lwnScn = ctx->readScn(redoBlock + blockOffset + 40);
+            lwnTimestamp = ctx->read32(redoBlock + blockOffset + 64);
 
-                    uint16_t lwnNum = ctx->read16(redoBlock + blockOffset + 24);
-                    uint32_t lwnSize = ctx->read32(redoBlock + blockOffset + 28);
-                    lwnEndBlock = currentBlock + lwnSize;
-                    lwnScn = ctx->readScn(redoBlock + blockOffset + 40);
-                    lwnTimestamp = ctx->read32(redoBlock + blockOffset + 64);
+            if (ctx->metrics) {
+                int64_t diff = ctx->clock->getTimeT() - lwnTimestamp.toEpoch(ctx->hostTimezone);
+                ctx->metrics->emitCheckpointLag(diff);
+            }
 
-                    if (ctx->metrics) {
-                        int64_t diff = ctx->clock->getTimeT() - lwnTimestamp.toEpoch(ctx->hostTimezone);
-                        ctx->metrics->emitCheckpointLag(diff);
-                    }
+            if (lwnNumCnt == 0) {
+                lwnCheckpointBlock = currentBlock;
+                lwnNumMax = ctx->read16(redoBlock + blockOffset + 26);
+                // Verify LWN header start
+                if (unlikely(lwnScn < reader->getFirstScn() || (lwnScn > reader->getNextScn() && reader->getNextScn() != Ctx::ZERO_SCN)))
+                    throw RedoLogException(50049, "invalid lwn scn: " + std::to_string(lwnScn));
+            } else {
+                uint16_t lwnNumCur = ctx->read16(redoBlock + blockOffset + 26);
+                if (unlikely(lwnNumCur != lwnNumMax))
+                    throw RedoLogException(50050, "invalid lwn max: " + std::to_string(lwnNum) + "/" +
+                                                    std::to_string(lwnNumCur) + "/" + std::to_string(lwnNumMax));
+            }
+            ++lwnNumCnt;
 
-                    if (lwnNumCnt == 0) {
-                        lwnCheckpointBlock = currentBlock;
-                        lwnNumMax = ctx->read16(redoBlock + blockOffset + 26);
-                        // Verify LWN header start
-                        if (unlikely(lwnScn < reader->getFirstScn() || (lwnScn > reader->getNextScn() && reader->getNextScn() != Ctx::ZERO_SCN)))
-                            throw RedoLogException(50049, "invalid lwn scn: " + std::to_string(lwnScn));
-                    } else {
-                        uint16_t lwnNumCur = ctx->read16(redoBlock + blockOffset + 26);
-                        if (unlikely(lwnNumCur != lwnNumMax))
-                            throw RedoLogException(50050, "invalid lwn max: " + std::to_string(lwnNum) + "/" +
-                                                            std::to_string(lwnNumCur) + "/" + std::to_string(lwnNumMax));
-                    }
-                    ++lwnNumCnt;
+            if (unlikely(ctx->trace & Ctx::TRACE_LWN)) {
+                typeBlk lwnStartBlock = currentBlock;
+                ctx->OLR_TRACE(Ctx::TRACE_LWN, "at: " + std::to_string(lwnStartBlock) + " size: " + std::to_string(lwnSize) +
+                                                " chk: " + std::to_string(lwnNum) + " max: " + std::to_string(lwnNumMax));
+            }
+        }
 
-                    if (unlikely(ctx->trace & Ctx::TRACE_LWN)) {
-                        typeBlk lwnStartBlock = currentBlock;
-                        ctx->OLR_TRACE(Ctx::TRACE_LWN, "at: " + std::to_string(lwnStartBlock) + " size: " + std::to_string(lwnSize) +
-                                                        " chk: " + std::to_string(lwnNum) + " max: " + std::to_string(lwnNumMax));
-                    }
+        while (blockOffset < reader->getBlockSize()) {
+            // Next record
+            if (recordLeftToCopy == 0) {
+                if (blockOffset + 20 >= reader->getBlockSize())
+                    break;
+
+                uint64_t recordSize4 = (static_cast<uint64_t>(ctx->read32(redoBlock + blockOffset)) + 3) & 0xFFFFFFFC;
+                if (recordSize4 > 0) {
+                    // A record within the block is not copied, the read buffer is held until the LWN is analyzed
+                    if (lwnZeroCopy && blockOffset + recordSize4 <= reader->getBlockSize()) {
+                        lwnRecord = lwnManager.allocateLwnMember(0);
+                        lwnRecord->data = redoBlock + blockOffset;
+                        if (lwnZeroCopyBlock == Ctx::ZERO_BLK)
+                            lwnZeroCopyBlock = currentBlock;
+                    } else
+                        lwnRecord = lwnManager.allocateLwnMember(recordSize4);
+                    lwnRecord->scn = ctx->read32(redoBlock + blockOffset + 8) |
+                                     (static_cast<uint64_t>(ctx->read16(redoBlock + blockOffset + 6)) << 32);
+                    lwnRecord->subScn = ctx->read16(redoBlock + blockOffset + 12);
+                    lwnRecord->block = currentBlock;
+                    lwnRecord->offset = blockOffset;
+                    lwnRecord->size = recordSize4;
+                    if (unlikely(ctx->trace & Ctx::TRACE_LWN))
+                        ctx->OLR_TRACE(Ctx::TRACE_LWN, "size: " + std::to_string(recordSize4) + " scn: " +
+                                                      std::to_string(lwnRecord->scn) + " subscn: " + std::to_string(lwnRecord->subScn));
+
+                    lwnManager.addLwnMember(lwnRecord);
                 }
 
-                LwnMember* lwnMember;
-                while (blockOffset < reader->getBlockSize()) {
-                    // Next record
-                    if (recordLeftToCopy == 0) {
-                        if (blockOffset + 20 >= reader->getBlockSize())
-                            break;
+                recordLeftToCopy = recordSize4;
+                recordPos = 0;
+            }
 
-                        uint64_t recordSize4 = (static_cast<uint64_t>(ctx->read32(redoBlock + blockOffset)) + 3) & 0xFFFFFFFC;
-                        if (recordSize4 > 0) {
-                            lwnMember = lwnManager.allocateLwnMember(recordSize4);
-                            lwnMember->scn = ctx->read32(redoBlock + blockOffset + 8) |
-                                             (static_cast<uint64_t>(ctx->read16(redoBlock + blockOffset + 6)) << 32);
-                            lwnMember->subScn = ctx->read16(redoBlock + blockOffset + 12);
-                            lwnMember->block = currentBlock;
-                            lwnMember->offset = blockOffset;
-                            lwnMember->size = recordSize4;
-                            if (unlikely(ctx->trace & Ctx::TRACE_LWN))
-                                ctx->OLR_TRACE(Ctx::TRACE_LWN, "size: " + std::to_string(recordSize4) + " scn: " +
-                                                              std::to_string(lwnMember->scn) + " subscn: " + std::to_string(lwnMember->subScn));
-
-                            lwnManager.addLwnMember(lwnMember);
-                        }
+            // Nothing more
+            if (recordLeftToCopy == 0)
+                break;
 
-                        recordLeftToCopy = recordSize4;
-                        recordPos = 0;
-                    }
+            uint64_t toCopy = std::min(reader->getBlockSize() - blockOffset, recordLeftToCopy);
 
-                    // Nothing more
-                    if (recordLeftToCopy == 0)
-                        break;
+            if (lwnRecord->data != redoBlock + blockOffset)
+                memcpy(reinterpret_cast<void*>(lwnRecord->data + recordPos),
+                       reinterpret_cast<const void*>(redoBlock + blockOffset), toCopy);
+            recordLeftToCopy -= toCopy;
+            blockOffset += toCopy;
+            recordPos += toCopy;
+        }
 
-                    uint64_t toCopy = std::min(reader->getBlockSize() - blockOffset, recordLeftToCopy);
+        // Checkpoint
+        if (unlikely(ctx->trace & Ctx::TRACE_LWN))
+            ctx->OLR_TRACE(Ctx::TRACE_LWN, "checkpoint at " + std::to_string(currentBlock + 1) + "/" + std::to_string(lwnEndBlock) +
+                                          " num: " + std::to_string(lwnNumCnt) + "/" + std::to_string(lwnNumMax));
+        if (currentBlock + 1 == lwnEndBlock && lwnNumCnt == lwnNumMax) {
+            lwnNumCnt = 0;
+            return true;
+        }
+        if (unlikely(lwnNumCnt > lwnNumMax))
+            throw RedoLogException(50055, "lwn overflow: " + std::to_string(lwnNumCnt) + "/" + std::to_string(lwnNumMax));
+        return false;
+    }
 
-                    memcpy(reinterpret_cast<void*>(reinterpret_cast<uint8_t*>(lwnMember) + sizeof(struct LwnMember) + recordPos),
-                           reinterpret_cast<const void*>(redoBlock + blockOffset), toCopy);
-                    recordLeftToCopy -= toCopy;
-                    blockOffset += toCopy;
-                    recordPos += toCopy;
-                }
+    void Parser::analyzeLwnMember(LwnMember* lwnMember, LwnDecoded* lwnDecoded) {
+        try {
+            if (lwnDecoded == nullptr) {
+                analyzeLwn(lwnMember, nullptr);
+            } else {
+                // Changes decoded before an error are applied as if the member was analyzed here
+                for (const LwnAction& action: lwnDecoded->actions)
+                    applyLwnAction(lwnDecoded->records.data(), action);
+                if (lwnDecoded->error)
+                    std::rethrow_exception(lwnDecoded->error);
+            }
+        } catch (DataException& ex) {
+            if (ctx->isFlagSet(Ctx::REDO_FLAGS_IGNORE_DATA_ERRORS)) {
+                ctx->OLR_ERROR(ex.code, ex.msg);
+                ctx->OLR_WARN(60013, "forced to continue working in spite of error");
+            } else
+                throw DataException(ex.code, "runtime error, aborting further redo log processing: " + ex.msg);
+        } catch (RedoLogException& ex) {
+            if (ctx->isFlagSet(Ctx::REDO_FLAGS_IGNORE_DATA_ERRORS)) {
+                ctx->OLR_ERROR(ex.code, ex.msg);
+                ctx->OLR_WARN(60013, "forced to continue working in spite of error");
+            } else
+                throw RedoLogException(ex.code, "runtime error, aborting further redo log processing: " + ex.msg);
+        }
+    }
 
-                ++currentBlock;
-                confirmedBufferStart += reader->getBlockSize();
-                redoBufferPos += reader->getBlockSize();
+    void Parser::decodeLwnMember(LwnMember* lwnMember, LwnDecoded* lwnDecoded) {
+        lwnDecoded->records.clear();
+        lwnDecoded->actions.clear();
+        lwnDecoded->error = nullptr;
+        try {
+            analyzeLwn(lwnMember, lwnDecoded);
+        } catch (...) {
+            lwnDecoded->error = std::current_exception();
+        }
+        lwnDecoded->ready = true;
+    }
 
-                // Checkpoint
-                if (unlikely(ctx->trace & Ctx::TRACE_LWN))
-                    ctx->OLR_TRACE(Ctx::TRACE_LWN, "checkpoint at " + std::to_string(currentBlock) + "/" + std::to_string(lwnEndBlock) +
-                                                  " num: " + std::to_string(lwnNumCnt) + "/" + std::to_string(lwnNumMax));
-                if (currentBlock == lwnEndBlock && lwnNumCnt == lwnNumMax) {
-                    lastTransaction = nullptr;
+    bool Parser::decodeLwnNext() {
+        uint64_t num = lwnBatch.next++;
+        if (num >= lwnBatch.end)
+            return false;
 
-                    if (unlikely(ctx->trace & Ctx::TRACE_LWN))
-                        ctx->OLR_TRACE(Ctx::TRACE_LWN, "* analyze: " + std::to_string(lwnScn));
+        decodeLwnMember(lwnBatch.members[num], lwnBatch.decoded[num - lwnBatch.start]);
+        return true;
+    }
 
-                    while (lwnManager.records() > 0) {
-                        try {
-                            analyzeLwn(lwnManager.getMinLwnMember());
-                        } catch (DataException& ex) {
-                            if (ctx->isFlagSet(Ctx::REDO_FLAGS_IGNORE_DATA_ERRORS)) {
-                                ctx->OLR_ERROR(ex.code, ex.msg);
-                                ctx->OLR_WARN(60013, "forced to continue working in spite of error");
-                            } else
-                                throw DataException(ex.code, "runtime error, aborting further redo log processing: " + ex.msg);
-                        } catch (RedoLogException& ex) {
-                            if (ctx->isFlagSet(Ctx::REDO_FLAGS_IGNORE_DATA_ERRORS)) {
-                                ctx->OLR_ERROR(ex.code, ex.msg);
-                                ctx->OLR_WARN(60013, "forced to continue working in spite of error");
-                            } else
-                                throw RedoLogException(ex.code, "runtime error, aborting further redo log processing: " + ex.msg);
-                        }
+    void Parser::decodeLwnBatch() {
+        while (decodeLwnNext()) {
+        }
+    }
 
-                        if (lwnManager.records() == 1) {
-                            lwnManager.reset();
-                            break;
-                        }
+    void Parser::analyzeLwnBatch() {
+        uint64_t size = lwnBatch.members.size();
+
+        for (uint64_t start = 0; start < size; start = lwnBatch.end) {
+            uint64_t end = std::min(size, start + LWN_DECODE_WINDOW);
+            while (lwnBatch.decoded.size() < end - start)
+                lwnBatch.decoded.push_back(new LwnDecoded);
+            for (uint64_t num = start; num < end; ++num)
+                lwnBatch.decoded[num - start]->ready = false;
+
+            lwnBatch.start = start;
+            lwnBatch.end = end;
+            lwnBatch.next = start;
+            lwnBatch.active = 0;
+            for (LwnDecoder* decoder: *decoders) {
+                ++lwnBatch.active;
+                if (!decoder->assign(&lwnBatch))
+                    --lwnBatch.active;
+            }
 
-                        lwnManager.dropMin();
+            try {
+                // Members are applied in the order of analysis, the parser decodes too when the next one is not ready yet
+                for (uint64_t num = start; num < end; ++num) {
+                    LwnDecoded* lwnDecoded = lwnBatch.decoded[num - start];
+                    while (!lwnDecoded->ready) {
+                        if (!decodeLwnNext())
+                            std::this_thread::yield();
                     }
+                    analyzeLwnMember(lwnBatch.members[num], lwnDecoded);
+                }
+            } catch (...) {
+                lwnBatch.next = end;
+                analyzeLwnBatchLeave();
+                throw;
+            }
 
-                    if (lwnScn > metadata->firstDataScn) {
-                        if (unlikely(ctx->trace & Ctx::TRACE_CHECKPOINT))
-                            ctx->OLR_TRACE(Ctx::TRACE_CHECKPOINT, "on: " + std::to_string(lwnScn));
-                        builder->processCheckpoint(lwnScn, sequence, lwnTimestamp.toEpoch(ctx->hostTimezone),
-                                                   static_cast<uint64_t>(currentBlock) * reader->getBlockSize(), switchRedo);
-
-                        typeSeq minSequence = Ctx::ZERO_SEQ;
-                        uint64_t minOffset = -1;
-                        typeXid minXid;
-                        transactionBuffer->checkpoint(minSequence, minOffset, minXid);
-                        if (unlikely(ctx->trace & Ctx::TRACE_LWN))
-                            ctx->OLR_TRACE(Ctx::TRACE_LWN, "* checkpoint: " + std::to_string(lwnScn));
-                        metadata->checkpoint(lwnScn, lwnTimestamp, sequence,
-                                             static_cast<uint64_t>(currentBlock) * reader->getBlockSize(),
-                                             static_cast<uint64_t>(currentBlock - lwnConfirmedBlock) * reader->getBlockSize(), minSequence,
-                                             minOffset, minXid);
-
-                        if (ctx->stopCheckpoints > 0 && metadata->isNewData(lwnScn, builder->lwnIdx)) {
-                            --ctx->stopCheckpoints;
-                            if (ctx->stopCheckpoints == 0) {
-                                ctx->OLR_INFO(0, "shutdown started - exhausted number of checkpoints");
-                                ctx->stopSoft();
-                            }
-                        }
-                        if (ctx->metrics)
-                            ctx->metrics->emitCheckpointsOut(1);
-                    } else {
-                        if (ctx->metrics)
-                            ctx->metrics->emitCheckpointsSkip(1);
-                    }
+            analyzeLwnBatchLeave();
+        }
+    }
 
-                    lwnNumCnt = 0;
-                    freeLwn();
+    void Parser::analyzeLwnBatchLeave() {
+        // The window is reused, the decoders which did not start yet are not waited for
+        for (LwnDecoder* decoder: *decoders) {
+            if (decoder->revoke(&lwnBatch))
+                --lwnBatch.active;
+        }
 
-                    if (ctx->metrics)
-                        ctx->metrics->emitBytesParsed((currentBlock - lwnConfirmedBlock) * reader->getBlockSize());
-                    lwnConfirmedBlock = currentBlock;
-                } else if (unlikely(lwnNumCnt > lwnNumMax))
-                    throw RedoLogException(50055, "lwn overflow: " + std::to_string(lwnNumCnt) + "/" + std::to_string(lwnNumMax));
+        while (lwnBatch.active > 0)
+            std::this_thread::yield();
+    }
 
-                // Free memory
-                if (redoBufferPos == Ctx::MEMORY_CHUNK_SIZE) {
-                    reader->bufferFree(redoBufferNum);
-                    reader->confirmReadData(confirmedBufferStart);
-                }
-            }
+    void Parser::releaseReadData(uint64_t confirmedBufferStart) {
+        uint64_t releaseBufferStart = confirmedBufferStart;
+        if (lwnZeroCopyBlock != Ctx::ZERO_BLK) {
+            uint64_t holdBufferStart = static_cast<uint64_t>(lwnZeroCopyBlock) * reader->getBlockSize();
+            // Holding too much of the read buffer would stall the reader, the members are copied then
+            if (confirmedBufferStart / Ctx::MEMORY_CHUNK_SIZE - holdBufferStart / Ctx::MEMORY_CHUNK_SIZE >= ctx->readBufferMax / 2) {
+                lwnManager.copyLwnMembers();
+                lwnZeroCopyBlock = Ctx::ZERO_BLK;
+            } else
+                releaseBufferStart = holdBufferStart;
+        }
 
-            // Processing finished
-            if (!switchRedo && lwnScn > 0 && confirmedBufferStart == reader->getBufferEnd() && reader->getRet() == Reader::REDO_FINISHED) {
-                if (lwnScn > metadata->firstDataScn) {
-                    switchRedo = true;
-                    if (unlikely(ctx->trace & Ctx::TRACE_CHECKPOINT))
-                        ctx->OLR_TRACE(Ctx::TRACE_CHECKPOINT, "on: " + std::to_string(lwnScn) + " with switch");
-                    builder->processCheckpoint(lwnScn, sequence, lwnTimestamp.toEpoch(ctx->hostTimezone),
-                                               static_cast<uint64_t>(currentBlock) * reader->getBlockSize(), switchRedo);
-                    if (ctx->metrics)
-                        ctx->metrics->emitCheckpointsOut(1);
-                } else {
-                    if (ctx->metrics)
-                        ctx->metrics->emitCheckpointsSkip(1);
-                }
-            }
+        while (releasedBufferStart + Ctx::MEMORY_CHUNK_SIZE <= releaseBufferStart) {
+            reader->bufferFree((releasedBufferStart / Ctx::MEMORY_CHUNK_SIZE) % ctx->readBufferMax);
+            releasedBufferStart += Ctx::MEMORY_CHUNK_SIZE;
+        }
 
-            if (ctx->softShutdown) {
-                if (unlikely(ctx->trace & Ctx::TRACE_CHECKPOINT))
-                    ctx->OLR_TRACE(Ctx::TRACE_CHECKPOINT, "on: " + std::to_string(lwnScn) + " at exit");
-                builder->processCheckpoint(lwnScn, sequence, lwnTimestamp.toEpoch(ctx->hostTimezone),
-                                           static_cast<uint64_t>(currentBlock) * reader->getBlockSize(), false);
-                if (ctx->metrics)
-                    ctx->metrics->emitCheckpointsOut(1);
+        if (reader->getBufferStart() < releaseBufferStart)
+            reader->confirmReadData(releaseBufferStart);
+    }
 
-                reader->setRet(Reader::REDO_SHUTDOWN);
-            } else {
-                if (reader->checkFinished(confirmedBufferStart)) {
-                    if (reader->getRet() == Reader::REDO_FINISHED && nextScn == Ctx::ZERO_SCN && reader->getNextScn() != Ctx::ZERO_SCN)
-                        nextScn = reader->getNextScn();
-                    if (reader->getRet() == Reader::REDO_STOPPED || reader->getRet() == Reader::REDO_OVERWRITTEN)
-                        metadata->offset = static_cast<uint64_t>(lwnConfirmedBlock) * reader->getBlockSize();
-                    break;
-                }
+    void Parser::checkpointLwn(typeBlk currentBlock, typeBlk lwnConfirmedBlock, bool switchRedo) {
+        if (ctx->compressIdleS > 0)
+            transactionBuffer->compressTransactions(lwnTimestamp.toEpoch(ctx->hostTimezone));
+
+        if (lwnScn > metadata->firstDataScn) {
+            if (unlikely(ctx->trace & Ctx::TRACE_CHECKPOINT))
+                ctx->OLR_TRACE(Ctx::TRACE_CHECKPOINT, "on: " + std::to_string(lwnScn));
+            FlushTask task{};
+            task.type = FlushTask::TYPE_CHECKPOINT_LWN;
+            task.lwnScn = lwnScn;
+            task.sequence = sequence;
+            task.lwnTimestamp = lwnTimestamp;
+            task.offset = static_cast<uint64_t>(currentBlock) * reader->getBlockSize();
+            task.bytes = static_cast<uint64_t>(currentBlock - lwnConfirmedBlock) * reader->getBlockSize();
+            task.switchRedo = switchRedo;
+            task.minSequence = Ctx::ZERO_SEQ;
+            task.minOffset = -1;
+            task.thread = thread;
+            if (mergeThreads)
+                transactionBuffer->checkpointThread(thread, task.minSequence, task.minOffset, task.minXid);
+            else
+                transactionBuffer->checkpoint(task.minSequence, task.minOffset, task.minXid);
+            if (unlikely(ctx->trace & Ctx::TRACE_LWN))
+                ctx->OLR_TRACE(Ctx::TRACE_LWN, "* checkpoint: " + std::to_string(lwnScn));
+            task.transactions = false;
+            if (ctx->checkpointTransactions != 0 && metadata->isTransactionsDue(lwnTimestamp) && checkpointTransactionsPossible()) {
+                // The previous checkpoints may be still queued
+                flusher->drain();
+                if (metadata->isTransactionsDue(lwnTimestamp))
+                    task.transactions = checkpointTransactions();
             }
+            flusher->push(task);
+
+            if (ctx->metrics)
+                ctx->metrics->emitCheckpointsOut(1);
+        } else {
+            if (ctx->metrics)
+                ctx->metrics->emitCheckpointsSkip(1);
+        }
+    }
+
+    bool Parser::checkpointTransactionsPossible() {
+        uint64_t dataSize;
+        if (!transactionBuffer->isSnapshotPossible(dataSize)) {
+            if (unlikely(ctx->trace & Ctx::TRACE_CHECKPOINT))
+                ctx->OLR_TRACE(Ctx::TRACE_CHECKPOINT, "open transactions with lob data not stored at: " + std::to_string(lwnScn));
+            return false;
+        }
+
+        if (dataSize > ctx->checkpointTransactionsMaxMb * 1024 * 1024) {
+            if (unlikely(ctx->trace & Ctx::TRACE_CHECKPOINT))
+                ctx->OLR_TRACE(Ctx::TRACE_CHECKPOINT, "open transactions of size: " + std::to_string(dataSize / 1024 / 1024) +
+                                                      "MB not stored at: " + std::to_string(lwnScn));
+            return false;
+        }
+        return true;
+    }
+
+    bool Parser::checkpointTransactions() {
+        std::string transactionsName = metadata->getTransactionsName(lwnScn);
+        if (unlikely(ctx->trace & Ctx::TRACE_CHECKPOINT))
+            ctx->OLR_TRACE(Ctx::TRACE_CHECKPOINT, "write open transactions scn: " + std::to_string(lwnScn) + " name: " + transactionsName);
+
+        // The records data is written first, the index makes the files visible
+        std::ostream* data = metadata->stateWriteData(transactionsName);
+        if (data == nullptr) {
+            ctx->OLR_WARN(60018, "file: " + transactionsName + " - couldn't write checkpoint");
+            return false;
+        }
+
+        std::ostringstream ss;
+        try {
+            transactionBuffer->snapshot(ss, *data);
+            data->flush();
+        } catch (...) {
+            delete data;
+            throw;
+        }
+        bool written = data->good();
+        delete data;
+
+        if (!written || !metadata->stateWrite(transactionsName, lwnScn, ss)) {
+            ctx->OLR_WARN(60018, "file: " + transactionsName + " - couldn't write checkpoint");
+            (void)metadata->stateDropData(transactionsName);
+            return false;
+        }
+        return true;
+    }
+
+    bool Parser::checkpointSwitch(typeBlk currentBlock) {
+        if (lwnScn > metadata->firstDataScn) {
+            if (unlikely(ctx->trace & Ctx::TRACE_CHECKPOINT))
+                ctx->OLR_TRACE(Ctx::TRACE_CHECKPOINT, "on: " + std::to_string(lwnScn) + " with switch");
+            FlushTask task{};
+            task.type = FlushTask::TYPE_CHECKPOINT;
+            task.lwnScn = lwnScn;
+            task.sequence = sequence;
+            task.lwnTimestamp = lwnTimestamp;
+            task.offset = static_cast<uint64_t>(currentBlock) * reader->getBlockSize();
+            task.switchRedo = true;
+            flusher->push(task);
+            if (ctx->metrics)
+                ctx->metrics->emitCheckpointsOut(1);
+            return true;
         }
 
+        if (ctx->metrics)
+            ctx->metrics->emitCheckpointsSkip(1);
+        return false;
+    }
+
+    void Parser::checkpointShutdown(typeBlk currentBlock) {
+        if (unlikely(ctx->trace & Ctx::TRACE_CHECKPOINT))
+            ctx->OLR_TRACE(Ctx::TRACE_CHECKPOINT, "on: " + std::to_string(lwnScn) + " at exit");
+        FlushTask task{};
+        task.type = FlushTask::TYPE_CHECKPOINT;
+        task.lwnScn = lwnScn;
+        task.sequence = sequence;
+        task.lwnTimestamp = lwnTimestamp;
+        task.offset = static_cast<uint64_t>(currentBlock) * reader->getBlockSize();
+        task.switchRedo = false;
+        flusher->push(task);
+        if (ctx->metrics)
+            ctx->metrics->emitCheckpointsOut(1);
+    }
+
+    void Parser::parseEnd(typeBlk startBlock, typeBlk currentBlock, time_ut cStart) {
         if (ctx->metrics != nullptr && reader->getNextScn() != Ctx::ZERO_SCN) {
             int64_t diff = ctx->clock->getTimeT() - reader->getNextTime().toEpoch(ctx->hostTimezone);
 
@@ -1643,11 +2041,250 @@ namespace OpenLogReplicator {
             *ctx->dumpStream << "END OF REDO DUMP\n";
             ctx->dumpStream->close();
         }
+    }
+
+    uint64_t Parser::parse() {
+        typeBlk lwnConfirmedBlock = parseOffset();
+        reader->setBufferStartEnd(static_cast<uint64_t>(lwnConfirmedBlock) * reader->getBlockSize(),
+                                  static_cast<uint64_t>(lwnConfirmedBlock) * reader->getBlockSize());
+        parseHeader(reader->getBufferStart());
+
+        time_ut cStart = ctx->clock->getTimeUt();
+        reader->setStatusRead(); // allow reader to read blocks
+        uint64_t confirmedBufferStart = reader->getBufferStart();
+        typeBlk startBlock = lwnConfirmedBlock;
+        typeBlk currentBlock = lwnConfirmedBlock;
+        parseReset(lwnConfirmedBlock);
+        // Data written by the redo copier must stay intact
+        lwnZeroCopy = ctx->redoCopyPath.empty();
+        bool switchRedo = false;
+
+        while (!ctx->softShutdown) {
+            // There is some work to do
+            while (confirmedBufferStart < reader->getDataEnd()) {
+                uint64_t redoBufferPos = (static_cast<uint64_t>(currentBlock) * reader->getBlockSize()) % Ctx::MEMORY_CHUNK_SIZE;
+                uint64_t redoBufferNum = ((static_cast<uint64_t>(currentBlock) * reader->getBlockSize()) / Ctx::MEMORY_CHUNK_SIZE) % ctx->readBufferMax;
+                bool lwnComplete = parseBlock(reader->redoBufferList[redoBufferNum] + redoBufferPos, currentBlock);
+
+                ++currentBlock;
+                confirmedBufferStart += reader->getBlockSize();
+                redoBufferPos += reader->getBlockSize();
+
+                if (lwnComplete) {
+                    lastTransaction = nullptr;
+                    if (unlikely(metadata->schema->tableFilterStale)) {
+                        std::unique_lock<std::shared_mutex> lckTransaction(metadata->mtxTransaction);
+                        metadata->schema->rebuildTableFilter();
+                    }
+
+                    if (unlikely(ctx->trace & Ctx::TRACE_LWN))
+                        ctx->OLR_TRACE(Ctx::TRACE_LWN, "* analyze: " + std::to_string(lwnScn));
+
+                    if (decoders != nullptr && lwnManager.records() >= LWN_DECODE_MIN) {
+                        lwnBatch.members.clear();
+                        while (lwnManager.records() > 0) {
+                            lwnBatch.members.push_back(lwnManager.getMinLwnMember());
+
+                            if (lwnManager.records() == 1) {
+                                lwnManager.reset();
+                                break;
+                            }
+
+                            lwnManager.dropMin();
+                        }
+                        analyzeLwnBatch();
+                    } else {
+                        while (lwnManager.records() > 0) {
+                            analyzeLwnMember(lwnManager.getMinLwnMember());
+
+                            if (lwnManager.records() == 1) {
+                                lwnManager.reset();
+                                break;
+                            }
+
+                            lwnManager.dropMin();
+                        }
+                    }
+
+                    checkpointLwn(currentBlock, lwnConfirmedBlock, switchRedo);
+                    freeLwn();
+                    lwnZeroCopyBlock = Ctx::ZERO_BLK;
+
+                    if (ctx->metrics)
+                        ctx->metrics->emitBytesParsed((currentBlock - lwnConfirmedBlock) * reader->getBlockSize());
+                    lwnConfirmedBlock = currentBlock;
+                }
+
+                // Free memory
+                if (redoBufferPos == Ctx::MEMORY_CHUNK_SIZE || lwnComplete)
+                    releaseReadData(confirmedBufferStart);
+            }
+
+            // Processing finished
+            if (!switchRedo && lwnScn > 0 && reader->getRet() == Reader::REDO_FINISHED && confirmedBufferStart == reader->getDataEnd()) {
+                switchRedo = checkpointSwitch(currentBlock);
+            }
+
+            if (ctx->softShutdown) {
+                checkpointShutdown(currentBlock);
+                reader->setRet(Reader::REDO_SHUTDOWN);
+            } else {
+                releaseReadData(confirmedBufferStart);
+                if (reader->checkFinished(confirmedBufferStart)) {
+                    if (reader->getRet() == Reader::REDO_FINISHED && nextScn == Ctx::ZERO_SCN && reader->getNextScn() != Ctx::ZERO_SCN)
+                        nextScn = reader->getNextScn();
+                    if (reader->getRet() == Reader::REDO_STOPPED || reader->getRet() == Reader::REDO_OVERWRITTEN)
+                        metadata->offset = static_cast<uint64_t>(lwnConfirmedBlock) * reader->getBlockSize();
+                    break;
+                }
+            }
+        }
 
+        parseEnd(startBlock, currentBlock, cStart);
         freeLwn();
         return reader->getRet();
     }
 
+    uint64_t Parser::stage(BatchWorker* worker, uint64_t startOffset) {
+        if (unlikely((startOffset % reader->getBlockSize()) != 0))
+            throw RedoLogException(50047, "incorrect offset start: " + std::to_string(startOffset) +
+                                          " - not a multiplication of block size: " + std::to_string(reader->getBlockSize()));
+
+        typeBlk currentBlock = 2;
+        if (startOffset > 0)
+            currentBlock = startOffset / reader->getBlockSize();
+        reader->setBufferStartEnd(static_cast<uint64_t>(currentBlock) * reader->getBlockSize(),
+                                  static_cast<uint64_t>(currentBlock) * reader->getBlockSize());
+        reader->setStatusRead(); // allow reader to read blocks
+        uint64_t confirmedBufferStart = reader->getBufferStart();
+        parseReset(currentBlock);
+        // The members outlive the read buffer
+        lwnZeroCopy = false;
+
+        while (!ctx->softShutdown) {
+            while (confirmedBufferStart < reader->getDataEnd()) {
+                uint64_t redoBufferPos = (static_cast<uint64_t>(currentBlock) * reader->getBlockSize()) % Ctx::MEMORY_CHUNK_SIZE;
+                uint64_t redoBufferNum = ((static_cast<uint64_t>(currentBlock) * reader->getBlockSize()) / Ctx::MEMORY_CHUNK_SIZE) % ctx->readBufferMax;
+                bool lwnComplete = parseBlock(reader->redoBufferList[redoBufferNum] + redoBufferPos, currentBlock);
+
+                ++currentBlock;
+                confirmedBufferStart += reader->getBlockSize();
+                redoBufferPos += reader->getBlockSize();
+
+                // The members are handed over in the order of analysis
+                if (lwnComplete) {
+                    auto lwnGroup = new LwnGroup;
+                    lwnGroup->scn = lwnScn;
+                    lwnGroup->timestamp = lwnTimestamp;
+                    lwnGroup->checkpointBlock = lwnCheckpointBlock;
+                    lwnGroup->endBlock = currentBlock;
+                    lwnGroup->members.reserve(lwnManager.records());
+
+                    while (lwnManager.records() > 0) {
+                        lwnGroup->members.push_back(lwnManager.getMinLwnMember());
+
+                        if (lwnManager.records() == 1) {
+                            lwnManager.reset();
+                            break;
+                        }
+
+                        lwnManager.dropMin();
+                    }
+                    lwnManager.detachChunks(lwnGroup->chunks);
+
+                    // The records are decoded here, the merge only applies the changes in the order of analysis
+                    worker->decodedAllocate(lwnGroup->decoded, lwnGroup->members.size());
+                    lwnGroup->records = 0;
+                    for (uint64_t num = 0; num < lwnGroup->members.size(); ++num) {
+                        decodeLwnMember(lwnGroup->members[num], lwnGroup->decoded[num]);
+                        lwnGroup->records += lwnGroup->decoded[num]->records.size();
+                    }
+
+                    if (!worker->push(lwnGroup))
+                        return Reader::REDO_SHUTDOWN;
+                }
+
+                // Free memory
+                if (redoBufferPos == Ctx::MEMORY_CHUNK_SIZE)
+                    releaseReadData(confirmedBufferStart);
+            }
+
+            if (ctx->softShutdown)
+                break;
+
+            releaseReadData(confirmedBufferStart);
+            if (reader->checkFinished(confirmedBufferStart))
+                break;
+        }
+
+        if (ctx->softShutdown)
+            return Reader::REDO_SHUTDOWN;
+        return reader->getRet();
+    }
+
+    void Parser::replayBegin() {
+        replayConfirmedBlock = parseOffset();
+        parseHeader(static_cast<uint64_t>(replayConfirmedBlock) * reader->getBlockSize());
+
+        replayStart = ctx->clock->getTimeUt();
+        replayStartBlock = replayConfirmedBlock;
+        replayCurrentBlock = replayConfirmedBlock;
+    }
+
+    void Parser::replayLwn(const LwnGroup* lwnGroup) {
+        lwnScn = lwnGroup->scn;
+        lwnTimestamp = lwnGroup->timestamp;
+        lwnCheckpointBlock = lwnGroup->checkpointBlock;
+        replayCurrentBlock = lwnGroup->endBlock;
+        lastTransaction = nullptr;
+        if (unlikely(metadata->schema->tableFilterStale)) {
+            std::unique_lock<std::shared_mutex> lckTransaction(metadata->mtxTransaction);
+            metadata->schema->rebuildTableFilter();
+        }
+
+        if (unlikely(ctx->trace & Ctx::TRACE_LWN))
+            ctx->OLR_TRACE(Ctx::TRACE_LWN, "* analyze: " + std::to_string(lwnScn));
+
+        for (uint64_t num = 0; num < lwnGroup->members.size(); ++num)
+            analyzeLwnMember(lwnGroup->members[num], lwnGroup->decoded[num]);
+
+        checkpointLwn(replayCurrentBlock, replayConfirmedBlock, false);
+
+        if (ctx->metrics)
+            ctx->metrics->emitBytesParsed((replayCurrentBlock - replayConfirmedBlock) * reader->getBlockSize());
+        replayConfirmedBlock = replayCurrentBlock;
+    }
+
+    uint64_t Parser::replayEnd(BatchWorker* worker) {
+        uint64_t ret = Reader::REDO_SHUTDOWN;
+        if (ctx->softShutdown) {
+            checkpointShutdown(replayCurrentBlock);
+        } else {
+            ret = worker->getRet();
+            if (ret == Reader::REDO_FINISHED && lwnScn > 0)
+                checkpointSwitch(replayCurrentBlock);
+            if (ret == Reader::REDO_FINISHED && nextScn == Ctx::ZERO_SCN && reader->getNextScn() != Ctx::ZERO_SCN)
+                nextScn = reader->getNextScn();
+            if (ret == Reader::REDO_STOPPED || ret == Reader::REDO_OVERWRITTEN)
+                metadata->offset = static_cast<uint64_t>(replayConfirmedBlock) * reader->getBlockSize();
+        }
+
+        parseEnd(replayStartBlock, replayCurrentBlock, replayStart);
+        return ret;
+    }
+
+    uint64_t Parser::replay(BatchWorker* worker) {
+        replayBegin();
+
+        LwnGroup* lwnGroup;
+        while (!ctx->softShutdown && (lwnGroup = worker->pop()) != nullptr) {
+            replayLwn(lwnGroup);
+            worker->release(lwnGroup);
+        }
+
+        return replayEnd(worker);
+    }
+
     std::string Parser::toString() const {
         return "group: " + std::to_string(group) + " scn: " + std::to_string(firstScn) + " to " +
                std::to_string(nextScn != Ctx::ZERO_SCN ? nextScn : 0) + " seq: " + std::to_string(sequence) + " path: " + path;
@@ -17,6 +17,10 @@ You should have received a copy of the GNU General Public License
 along with OpenLogReplicator; see the file LICENSE;  If not see
 <http://www.gnu.org/licenses/>.  */
 
+#include <atomic>
+#include <exception>
+#include <vector>
+
 #include "../common/Ctx.h"
 #include "../common/RedoLogRecord.h"
 #include "../common/types.h"
@@ -27,17 +31,22 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #define PARSER_H_
 
 namespace OpenLogReplicator {
+    class BatchWorker;
     class Builder;
+    class LwnDecoder;
     class Reader;
     class Metadata;
+    class Parser;
     class Transaction;
     class TransactionBuffer;
+    class TransactionFlusher;
     class XmlCtx;
 
     /*
         LWN Member - Log Writer Number Member.
     */
     struct LwnMember {
+        uint8_t* data;      // record data, own copy or in the read buffer
         uint64_t offset;    // offset of block
         uint32_t size;      // size of LWN
         typeScn scn;        // current SCN
@@ -61,9 +70,57 @@ namespace OpenLogReplicator {
         }
     };
 
+    /*
+        LWN Action - change applied to the transactions, refers to decoded vectors by number.
+    */
+    struct LwnAction {
+        uint64_t type;
+        int64_t vector1;
+        int64_t vector2;
+    };
+
+    /*
+        LWN Decoded - vectors of one LWN member decoded by a worker, applied later in the order of analysis.
+    */
+    struct LwnDecoded {
+        std::vector<RedoLogRecord> records;
+        std::vector<LwnAction> actions;
+        std::exception_ptr error;
+        std::atomic<bool> ready;
+    };
+
+    /*
+        LWN Group - members of one LWN in order of analysis, decoded by a batch worker.
+    */
+    struct LwnGroup {
+        std::vector<LwnMember*> members;
+        std::vector<LwnDecoded*> decoded;
+        std::vector<uint8_t*> chunks;
+        uint64_t records;
+        typeScn scn;
+        typeTime timestamp;
+        typeBlk checkpointBlock;
+        typeBlk endBlock;
+    };
+
+    /*
+        LWN Batch - members of one LWN shared with the decoders, claimed one by one within a window.
+    */
+    struct LwnBatch {
+        Parser* parser;
+        std::vector<LwnMember*> members;
+        std::vector<LwnDecoded*> decoded;
+        uint64_t start;
+        uint64_t end;
+        std::atomic<uint64_t> next;
+        std::atomic<uint64_t> active;
+    };
+
     class LwnMembersManager {
         static constexpr uint64_t MAX_LWN_CHUNKS = 512 * 2 / Ctx::MEMORY_CHUNK_SIZE_MB;
         static constexpr uint64_t MAX_RECORDS_IN_LWN = 1048576;
+        // More out of order runs fall back to the heap
+        static constexpr uint64_t MAX_LWN_RUNS = 16;
 
     public:
         LwnMembersManager(Ctx* newCtx);
@@ -72,25 +129,54 @@ namespace OpenLogReplicator {
 
         LwnMember* allocateLwnMember(uint64_t recordSize4);
         void addLwnMember(LwnMember* lwnMember);
+        void copyLwnMembers();
         void dropMin();
         void reset();
         uint64_t maxAllocated() const;
         uint64_t records() const;
         LwnMember* getMinLwnMember();
+        void detachChunks(std::vector<uint8_t*>& chunks);
 
     private:
+        uint8_t* allocate(uint64_t size);
         void allocateChunk();
+        void heapPush(LwnMember* lwnMember);
+        void makeHeap();
+        void mergeRuns();
 
         Ctx* ctx;
         uint8_t* lwnChunks[MAX_LWN_CHUNKS];
         LwnMember* lwnMembers[MAX_RECORDS_IN_LWN + 1];
+        uint64_t lwnRunStart[MAX_LWN_RUNS];
+        std::vector<LwnMember*> lwnTail;
         uint64_t lwnAllocated;
         uint64_t lwnAllocatedMax;
         uint64_t lwnRecords;
+        uint64_t lwnFirst;
+        uint64_t lwnRuns;
+        bool lwnHeap;
     };
 
     class Parser final {
     protected:
+        // Smaller LWNs are not worth waking up the decoders
+        static constexpr uint64_t LWN_DECODE_MIN = 16;
+        // Limit of members decoded ahead of the apply
+        static constexpr uint64_t LWN_DECODE_WINDOW = 1024;
+
+        static constexpr uint64_t LWN_ACTION_APPEND = 0;
+        static constexpr uint64_t LWN_ACTION_APPEND_PAIR = 1;
+        static constexpr uint64_t LWN_ACTION_BEGIN = 2;
+        static constexpr uint64_t LWN_ACTION_COMMIT = 3;
+        static constexpr uint64_t LWN_ACTION_DDL = 4;
+        static constexpr uint64_t LWN_ACTION_INDEX = 5;
+        static constexpr uint64_t LWN_ACTION_LOB = 6;
+        static constexpr uint64_t LWN_ACTION_ROLLBACK = 7;
+        static constexpr uint64_t LWN_ACTION_ROLLBACK_PAIR = 8;
+        static constexpr uint64_t LWN_ACTION_SESSION_0513 = 9;
+        static constexpr uint64_t LWN_ACTION_SESSION_0514 = 10;
+        static constexpr uint64_t LWN_ACTION_FILTER = 11;
+
         Ctx* ctx;
         Builder* builder;
         Metadata* metadata;
@@ -102,9 +188,42 @@ namespace OpenLogReplicator {
         typeTime lwnTimestamp;
         typeScn lwnScn;
         typeBlk lwnCheckpointBlock;
+        LwnMember* lwnRecord;
+        uint64_t recordPos;
+        uint64_t recordLeftToCopy;
+        typeBlk lwnEndBlock;
+        typeBlk lwnZeroCopyBlock;
+        uint64_t releasedBufferStart;
+        bool lwnZeroCopy;
+        uint16_t lwnNumMax;
+        uint16_t lwnNumCnt;
+        LwnBatch lwnBatch;
+        typeBlk replayConfirmedBlock;
+        typeBlk replayStartBlock;
+        typeBlk replayCurrentBlock;
+        time_ut replayStart;
 
+        typeBlk parseOffset();
+        void parseHeader(uint64_t offset);
+        void parseReset(typeBlk startBlock);
+        bool parseBlock(uint8_t* redoBlock, typeBlk currentBlock);
+        void releaseReadData(uint64_t confirmedBufferStart);
+        void parseEnd(typeBlk startBlock, typeBlk currentBlock, time_ut cStart);
+        void analyzeLwnMember(LwnMember* lwnMember, LwnDecoded* lwnDecoded = nullptr);
+        void analyzeLwnBatch();
+        void analyzeLwnBatchLeave();
+        void decodeLwnMember(LwnMember* lwnMember, LwnDecoded* lwnDecoded);
+        bool decodeLwnNext();
+        void checkpointLwn(typeBlk currentBlock, typeBlk lwnConfirmedBlock, bool switchRedo);
+        bool checkpointTransactionsPossible();
+        bool checkpointTransactions();
+        bool checkpointSwitch(typeBlk currentBlock);
+        void checkpointShutdown(typeBlk currentBlock);
         void freeLwn();
-        void analyzeLwn(LwnMember* lwnMember);
+        void analyzeLwn(LwnMember* lwnMember, LwnDecoded* lwnDecoded);
+        void lwnAction(LwnDecoded* lwnDecoded, RedoLogRecord* redoLogRecord, uint64_t type, int64_t vector1, int64_t vector2 = -1);
+        void applyLwnAction(RedoLogRecord* redoLogRecord, const LwnAction& lwnAction);
+        bool filterUndo(RedoLogRecord* redoLogRecord1, const uint8_t* data2, uint64_t size2);
         void appendToTransactionDdl(RedoLogRecord* redoLogRecord1);
         void appendToTransactionBegin(RedoLogRecord* redoLogRecord1);
         void appendToTransactionCommit(RedoLogRecord* redoLogRecord1);
@@ -113,6 +232,7 @@ namespace OpenLogReplicator {
         void appendToTransaction(RedoLogRecord* redoLogRecord1);
         void appendToTransactionRollback(RedoLogRecord* redoLogRecord1);
         void appendToTransaction(RedoLogRecord* redoLogRecord1, RedoLogRecord* redoLogRecord2);
+        void appendToTransactionFiltered(RedoLogRecord* redoLogRecord1, RedoLogRecord* redoLogRecord2);
         void appendToTransactionRollback(RedoLogRecord* redoLogRecord1, RedoLogRecord* redoLogRecord2);
         void dumpRedoVector(const uint8_t* data, typeSize recordSize) const;
 
@@ -120,14 +240,25 @@ namespace OpenLogReplicator {
         int64_t group;
         std::string path;
         typeSeq sequence;
+        uint16_t thread;
+        // Redo threads are merged, the checkpoint keeps the oldest open transaction of every thread
+        bool mergeThreads;
         typeScn firstScn;
         typeScn nextScn;
         Reader* reader;
+        const std::vector<LwnDecoder*>* decoders;
+        TransactionFlusher* flusher;
 
         Parser(Ctx* newCtx, Builder* newBuilder, Metadata* newMetadata, TransactionBuffer* newTransactionBuffer, int64_t newGroup, const std::string& newPath);
         virtual ~Parser();
 
         uint64_t parse();
+        uint64_t stage(BatchWorker* worker, uint64_t startOffset);
+        uint64_t replay(BatchWorker* worker);
+        void replayBegin();
+        void replayLwn(const LwnGroup* lwnGroup);
+        uint64_t replayEnd(BatchWorker* worker);
+        void decodeLwnBatch();
         std::string toString() const;
     };
 }
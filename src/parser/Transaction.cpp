@@ -24,6 +24,7 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #include "../common/OracleTable.h"
 #include "../common/RedoLogRecord.h"
 #include "../common/XmlCtx.h"
+#include "../common/exception/DataException.h"
 #include "../common/exception/RedoLogException.h"
 #include "../metadata/Metadata.h"
 #include "../metadata/Schema.h"
@@ -32,7 +33,7 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #include "TransactionBuffer.h"
 
 namespace OpenLogReplicator {
-    Transaction::Transaction(typeXid newXid, std::map<LobKey, Lob>* newOrphanedLobs, XmlCtx* newXmlCtx) :
+    Transaction::Transaction(typeXid newXid, std::map<LobKey, Lob>* newOrphanedLobs, std::mutex* newMtxOrphanedLobs, XmlCtx* newXmlCtx) :
             deallocTc(nullptr),
             opCodes(0),
             mergeBuffer(nullptr),
@@ -40,6 +41,7 @@ namespace OpenLogReplicator {
             xid(newXid),
             firstSequence(0),
             firstOffset(0),
+            thread(0),
             commitSequence(0),
             commitScn(0),
             firstTc(nullptr),
@@ -52,8 +54,56 @@ namespace OpenLogReplicator {
             shutdown(false),
             lastSplit(false),
             dump(false),
-            size(0) {
+            locked(false),
+            size(0),
+            lastTime(0),
+            spillFd(-1),
+            spillChunks(0),
+            spillSize(0),
+            compressedFirstTc(nullptr),
+            compressedLastTc(nullptr),
+            compressedPos(0),
+            compressedChunks(0),
+            compressedSize(0) {
         lobCtx.orphanedLobs = newOrphanedLobs; // from TransactionBuffer
+        lobCtx.mtxOrphanedLobs = newMtxOrphanedLobs;
+    }
+
+    // Called for purged transaction taken from the pool, the containers are empty but keep the allocated memory
+    void Transaction::reset(typeXid newXid, XmlCtx* newXmlCtx) {
+        deallocTc = nullptr;
+        opCodes = 0;
+        mergeBuffer = nullptr;
+        xmlCtx = newXmlCtx;
+        xid = newXid;
+        firstSequence = 0;
+        firstOffset = 0;
+        thread = 0;
+        commitSequence = 0;
+        commitScn = 0;
+        firstTc = nullptr;
+        lastTc = nullptr;
+        commitTimestamp = 0;
+        begin = false;
+        rollback = false;
+        system = false;
+        schema = false;
+        shutdown = false;
+        lastSplit = false;
+        dump = false;
+        locked = false;
+        size = 0;
+        lastTime = 0;
+        spillFd = -1;
+        spillChunks = 0;
+        spillSize = 0;
+        compressedFirstTc = nullptr;
+        compressedLastTc = nullptr;
+        compressedPos = 0;
+        compressedChunks = 0;
+        compressedSize = 0;
+        attributes.clear();
+        lobIdList.clear();
     }
 
     void Transaction::add(const Metadata* metadata, TransactionBuffer* transactionBuffer, RedoLogRecord* redoLogRecord1) {
@@ -76,12 +126,12 @@ namespace OpenLogReplicator {
         log(ctx, "rlb2", redoLogRecord2);
 
         while (lastTc != nullptr && lastTc->size > 0 && opCodes > 0) {
-            TransactionChunkRecord lastRecord = lastTc->lastRecord();
-            // auto lastRedoLogRecord1 = lastRecord.redo1();
-            const auto lastRedoLogRecord2 = lastRecord.redo2();
+            RedoLogRecord lastRedoLogRecord1;
+            RedoLogRecord lastRedoLogRecord2;
+            lastTc->lastRecord().decode(&lastRedoLogRecord1, &lastRedoLogRecord2);
 
             bool ok = false;
-            switch (lastRedoLogRecord2->opCode) {
+            switch (lastRedoLogRecord2.opCode) {
                 case 0x0A02:
                 case 0x0A08:
                 case 0x0A12:
@@ -124,11 +174,11 @@ namespace OpenLogReplicator {
                     break;
             }
 
-            if (lastRedoLogRecord2->obj != redoLogRecord1->obj)
+            if (lastRedoLogRecord2.obj != redoLogRecord1->obj)
                 ok = false;
 
             if (!ok) {
-                ctx->OLR_WARN(70003, "trying to rollback: " + std::to_string(lastRedoLogRecord2->opCode) + " with: " +
+                ctx->OLR_WARN(70003, "trying to rollback: " + std::to_string(lastRedoLogRecord2.opCode) + " with: " +
                                     std::to_string(redoLogRecord1->opCode) + ", offset: " + std::to_string(redoLogRecord1->dataOffset) + ", xid: " +
                                     xid.toString() + ", pos: 2");
                 return;
@@ -147,12 +197,12 @@ namespace OpenLogReplicator {
         log(metadata->ctx, "rlb ", redoLogRecord1);
 
         while (lastTc != nullptr && lastTc->size > 0 && opCodes > 0) {
-            TransactionChunkRecord lastRecord = lastTc->lastRecord();
-            const auto lastRedoLogRecord1 = lastRecord.redo1();
-            const auto lastRedoLogRecord2 = lastRecord.redo2();
+            RedoLogRecord lastRedoLogRecord1;
+            RedoLogRecord lastRedoLogRecord2;
+            lastTc->lastRecord().decode(&lastRedoLogRecord1, &lastRedoLogRecord2);
 
             bool ok = false;
-            switch (lastRedoLogRecord2->opCode) {
+            switch (lastRedoLogRecord2.opCode) {
                 case 0x0A02:
                 case 0x0A08:
                 case 0x0A12:
@@ -169,11 +219,11 @@ namespace OpenLogReplicator {
                     break;
             }
 
-            if (lastRedoLogRecord1->obj != redoLogRecord1->obj)
+            if (lastRedoLogRecord1.obj != redoLogRecord1->obj)
                 ok = false;
 
             if (!ok) {
-                metadata->ctx->OLR_WARN(70003, "trying to rollback: " + std::to_string(lastRedoLogRecord2->opCode) + " with: " +
+                metadata->ctx->OLR_WARN(70003, "trying to rollback: " + std::to_string(lastRedoLogRecord2.opCode) + " with: " +
                                               std::to_string(redoLogRecord1->opCode) + ", offset: " + std::to_string(redoLogRecord1->dataOffset) +
                                               ", xid: " + xid.toString() + ", pos: 1");
                 return;
@@ -192,7 +242,13 @@ namespace OpenLogReplicator {
         bool opFlush;
         deallocTc = nullptr;
         uint64_t maxMessageMb = builder->getMaxMessageMb();
-        std::unique_lock<std::mutex> lckTransaction(metadata->mtxTransaction);
+        // Transactions only read the schema and may be formatted in parallel, system transactions change it
+        std::shared_lock<std::shared_mutex> lckTransactionShared(metadata->mtxTransaction, std::defer_lock);
+        std::unique_lock<std::shared_mutex> lckTransaction(metadata->mtxTransaction, std::defer_lock);
+        if (system)
+            lckTransaction.lock();
+        else
+            lckTransactionShared.lock();
         std::unique_lock<std::mutex> lckSchema(metadata->mtxSchema, std::defer_lock);
 
         if (opCodes == 0 || (metadata->ctx->skipRollback == 1 && rollback))
@@ -213,22 +269,29 @@ namespace OpenLogReplicator {
         uint64_t type = 0;
         std::deque<const RedoLogRecord*> redo1;
         std::deque<const RedoLogRecord*> redo2;
+        // Records rebuilt from the chunks, kept until the operation is flushed like the chunks
+        std::deque<RedoLogRecord> records;
+
+        // Chunks from the spill file and compressed chunks are read first, one by one, then the chunks in memory
+        locked = true;
+        uint64_t spillPos = 0;
+        TransactionChunk* tc = transactionBuffer->takeColdTransactionChunk(this, spillPos);
+        bool cold = (tc != nullptr);
+        if (!cold)
+            tc = firstTc;
 
-        TransactionChunk* tc = firstTc;
         while (tc != nullptr) {
             TransactionChunkRecord tcr = tc->firstRecord();
             for (uint64_t i = 0; i < tc->elements; ++i) {
                 typeOp2 op = tcr.opCode();
 
-                RedoLogRecord* redoLogRecord1 = tcr.redo1();
-                RedoLogRecord* redoLogRecord2 = tcr.redo2();
+                RedoLogRecord* redoLogRecord1 = &records.emplace_back();
+                RedoLogRecord* redoLogRecord2 = &records.emplace_back();
+                tcr.decode(redoLogRecord1, redoLogRecord2);
+                tcr.next();
                 log(metadata->ctx, "flu1", redoLogRecord1);
                 log(metadata->ctx, "flu2", redoLogRecord2);
 
-                redoLogRecord1->dataExt = tcr.redoData1();
-                redoLogRecord2->dataExt = tcr.redoData2();
-                tcr.next();
-
                 if (unlikely(metadata->ctx->trace & Ctx::TRACE_TRANSACTION))
                     metadata->ctx->OLR_TRACE(Ctx::TRACE_TRANSACTION, std::to_string(redoLogRecord1->size) + ":" +
                                                                     std::to_string(redoLogRecord2->size) + " fb: " +
@@ -554,6 +617,7 @@ namespace OpenLogReplicator {
                 if (opFlush) {
                     redo1.clear();
                     redo2.clear();
+                    records.clear();
                     type = 0;
 
                     while (deallocTc != nullptr) {
@@ -567,8 +631,15 @@ namespace OpenLogReplicator {
             TransactionChunk* nextTc = tc->next;
             tc->next = deallocTc;
             deallocTc = tc;
+            if (cold) {
+                nextTc = transactionBuffer->takeColdTransactionChunk(this, spillPos);
+                if (nextTc == nullptr) {
+                    cold = false;
+                    nextTc = firstTc;
+                }
+            } else
+                firstTc = nextTc;
             tc = nextTc;
-            firstTc = tc;
         }
 
         while (deallocTc != nullptr) {
@@ -580,6 +651,8 @@ namespace OpenLogReplicator {
         firstTc = nullptr;
         lastTc = nullptr;
         opCodes = 0;
+        transactionBuffer->dropSpill(this);
+        locked = false;
 
         if (system) {
             builder->systemTransaction->commit(commitScn);
@@ -606,6 +679,17 @@ namespace OpenLogReplicator {
             deallocTc = nextTc;
         }
         deallocTc = nullptr;
+        transactionBuffer->dropSpill(this);
+        locked = false;
+
+        if (compressedFirstTc != nullptr) {
+            transactionBuffer->deleteTransactionChunks(compressedFirstTc);
+            compressedFirstTc = nullptr;
+            compressedLastTc = nullptr;
+        }
+        compressedPos = 0;
+        compressedChunks = 0;
+        compressedSize = 0;
 
         if (mergeBuffer != nullptr) {
             delete[] mergeBuffer;
@@ -618,6 +702,124 @@ namespace OpenLogReplicator {
         opCodes = 0;
     }
 
+    bool Transaction::hasLobs() const {
+        return !lobCtx.lobs.empty() || !lobCtx.listMap.empty();
+    }
+
+    void Transaction::snapshot(const TransactionBuffer* transactionBuffer, std::ostringstream& ss, std::ostream& data,
+                               typeXidMap xidMap) const {
+        ss << R"({"xid":)" << std::dec << xid.getData() <<
+           R"(,"xid-map":)" << std::dec << xidMap <<
+           R"(,"seq":)" << std::dec << firstSequence <<
+           R"(,"offset":)" << std::dec << firstOffset <<
+           R"(,"thread":)" << std::dec << thread <<
+           R"(,"begin":)" << std::dec << (begin ? 1 : 0) <<
+           R"(,"rollback":)" << std::dec << (rollback ? 1 : 0) <<
+           R"(,"system":)" << std::dec << (system ? 1 : 0) <<
+           R"(,"schema":)" << std::dec << (schema ? 1 : 0) <<
+           R"(,"split":)" << std::dec << (lastSplit ? 1 : 0) <<
+           R"(,"op-codes":)" << std::dec << opCodes <<
+           R"(,"attributes":{)";
+
+        bool hasPrev = false;
+        for (const auto& attributesIt: attributes) {
+            if (hasPrev)
+                ss << ",";
+            else
+                hasPrev = true;
+            ss << R"(")";
+            Ctx::writeEscapeValue(ss, attributesIt.first);
+            ss << R"(":")";
+            Ctx::writeEscapeValue(ss, attributesIt.second);
+            ss << R"(")";
+        }
+
+        // The records are stored as they are in memory in the data file, the data pointers are restored when the transaction is flushed
+        ss << R"(},"chunks":[)";
+        hasPrev = false;
+        if (spillChunks > 0 || compressedFirstTc != nullptr) {
+            auto coldTc = reinterpret_cast<TransactionChunk*>(new uint8_t[TransactionChunk::FULL_BUFFER_SIZE]);
+            try {
+                for (uint64_t i = 0; i < spillChunks; ++i) {
+                    transactionBuffer->readSpilledChunk(this, i, coldTc);
+                    snapshotChunk(ss, data, coldTc, hasPrev);
+                }
+
+                uint64_t pos = compressedPos;
+                for (const TransactionChunk* tc = compressedFirstTc; tc != nullptr; tc = tc->next) {
+                    while (pos < tc->size) {
+                        pos += transactionBuffer->decompressChunk(tc->buffer + pos, coldTc);
+                        snapshotChunk(ss, data, coldTc, hasPrev);
+                    }
+                    pos = 0;
+                }
+            } catch (...) {
+                delete[] reinterpret_cast<uint8_t*>(coldTc);
+                throw;
+            }
+            delete[] reinterpret_cast<uint8_t*>(coldTc);
+        }
+        for (const TransactionChunk* tc = firstTc; tc != nullptr; tc = tc->next)
+            snapshotChunk(ss, data, tc, hasPrev);
+        ss << "]}";
+    }
+
+    void Transaction::snapshotChunk(std::ostringstream& ss, std::ostream& data, const TransactionChunk* tc, bool& hasPrev) {
+        if (hasPrev)
+            ss << ",";
+        else
+            hasPrev = true;
+        ss << R"({"elements":)" << std::dec << tc->elements << R"(,"size":)" << std::dec << tc->size << "}";
+        data.write(reinterpret_cast<const char*>(tc->buffer), static_cast<std::streamsize>(tc->size));
+    }
+
+    void Transaction::restore(const Ctx* ctx, TransactionBuffer* transactionBuffer, const std::string& fileName,
+                              const rapidjson::Value& transactionJson, std::istream& data) {
+        firstSequence = Ctx::getJsonFieldU32(fileName, transactionJson, "seq");
+        firstOffset = Ctx::getJsonFieldU64(fileName, transactionJson, "offset");
+        thread = Ctx::getJsonFieldU16(fileName, transactionJson, "thread");
+        begin = Ctx::getJsonFieldU64(fileName, transactionJson, "begin") != 0;
+        rollback = Ctx::getJsonFieldU64(fileName, transactionJson, "rollback") != 0;
+        system = Ctx::getJsonFieldU64(fileName, transactionJson, "system") != 0;
+        schema = Ctx::getJsonFieldU64(fileName, transactionJson, "schema") != 0;
+        lastSplit = Ctx::getJsonFieldU64(fileName, transactionJson, "split") != 0;
+        opCodes = Ctx::getJsonFieldU64(fileName, transactionJson, "op-codes");
+
+        const rapidjson::Value& attributesJson = Ctx::getJsonFieldO(fileName, transactionJson, "attributes");
+        for (auto const& attribute: attributesJson.GetObject()) {
+            const char* key = attribute.name.GetString();
+            attributes.insert_or_assign(key, Ctx::getJsonFieldS(fileName, Ctx::JSON_PARAMETER_LENGTH, attributesJson, key));
+        }
+
+        const rapidjson::Value& chunksJson = Ctx::getJsonFieldA(fileName, transactionJson, "chunks");
+        for (rapidjson::SizeType i = 0; i < chunksJson.Size(); ++i) {
+            if (!ctx->disableChecksSet(Ctx::DISABLE_CHECKS_JSON_TAGS)) {
+                static const char* chunksChildNames[] = {"elements", "size", nullptr};
+                Ctx::checkJsonFields(fileName, chunksJson[i], chunksChildNames);
+            }
+
+            uint64_t elements = Ctx::getJsonFieldU64(fileName, chunksJson[i], "elements");
+            uint64_t chunkSize = Ctx::getJsonFieldU64(fileName, chunksJson[i], "size");
+            if (unlikely(chunkSize > TransactionChunk::DATA_BUFFER_SIZE || elements == 0))
+                throw DataException(20003, "file: " + fileName + " - parse error, invalid chunk of transaction: " + xid.toString());
+
+            TransactionChunk* tc = transactionBuffer->newTransactionChunk();
+            tc->elements = elements;
+            tc->size = chunkSize;
+            tc->prev = lastTc;
+            if (lastTc != nullptr)
+                lastTc->next = tc;
+            else
+                firstTc = tc;
+            lastTc = tc;
+
+            data.read(reinterpret_cast<char*>(tc->buffer), static_cast<std::streamsize>(tc->size));
+            if (unlikely(static_cast<uint64_t>(data.gcount()) != tc->size))
+                throw DataException(20003, "file: " + fileName + " - parse error, data truncated for transaction: " + xid.toString());
+            size += tc->size;
+        }
+    }
+
     std::string Transaction::toString() const {
         uint64_t tcCount = 0;
         TransactionChunk* tc = firstTc;
@@ -634,6 +836,8 @@ namespace OpenLogReplicator {
            " flags: " << std::dec << begin << "/" << rollback << "/" << system <<
            " op: " << std::dec << opCodes <<
            " chunks: " << std::dec << tcCount <<
+           " spilled: " << std::dec << spillChunks <<
+           " compressed: " << std::dec << compressedChunks <<
            " sz: " << std::dec << size;
         return ss.str();
     }
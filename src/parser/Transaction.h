@@ -18,6 +18,8 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 <http://www.gnu.org/licenses/>.  */
 
 #include <map>
+#include <rapidjson/document.h>
+#include <sstream>
 #include <unordered_map>
 #include <vector>
 
@@ -25,6 +27,7 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #include "../common/LobCtx.h"
 #include "../common/RedoLogRecord.h"
 #include "../common/types.h"
+#include "../common/typeLobId.h"
 #include "../common/typeTime.h"
 #include "../common/typeXid.h"
 
@@ -43,6 +46,8 @@ namespace OpenLogReplicator {
         TransactionChunk* deallocTc;
         uint64_t opCodes;
 
+        static void snapshotChunk(std::ostringstream& ss, std::ostream& data, const TransactionChunk* tc, bool& hasPrev);
+
     public:
         uint8_t* mergeBuffer;
         LobCtx lobCtx;
@@ -50,6 +55,7 @@ namespace OpenLogReplicator {
         typeXid xid;
         typeSeq firstSequence;
         uint64_t firstOffset;
+        uint16_t thread;
         typeSeq commitSequence;
         typeScn commitScn;
         TransactionChunk* firstTc;
@@ -62,19 +68,41 @@ namespace OpenLogReplicator {
         bool shutdown;
         bool lastSplit;
         bool dump;
+        bool locked;              // Chunks are being read or moved, they can't be spilled
         uint64_t size;
+        time_t lastTime;
+
+        // Oldest chunks stored in the spill file
+        int spillFd;
+        uint64_t spillChunks;
+        uint64_t spillSize;
+
+        // Chunks compressed when the transaction was idle, after the spilled ones and before the ones in memory
+        TransactionChunk* compressedFirstTc;
+        TransactionChunk* compressedLastTc;
+        uint64_t compressedPos;
+        uint64_t compressedChunks;
+        uint64_t compressedSize;
 
         // Attributes
         std::unordered_map<std::string, std::string> attributes;
 
-        explicit Transaction(typeXid newXid, std::map<LobKey, Lob>* newOrphanedLobs, XmlCtx* newXmlCtx);
+        // LOB ids mapped to this transaction in Ctx::lobIdToXidMap, removed from the map at commit
+        std::vector<typeLobId> lobIdList;
+
+        explicit Transaction(typeXid newXid, std::map<LobKey, Lob>* newOrphanedLobs, std::mutex* newMtxOrphanedLobs, XmlCtx* newXmlCtx);
 
+        void reset(typeXid newXid, XmlCtx* newXmlCtx);
         void add(const Metadata* metadata, TransactionBuffer* transactionBuffer, RedoLogRecord* redoLogRecord1);
         void add(const Metadata* metadata, TransactionBuffer* transactionBuffer, RedoLogRecord* redoLogRecord1, const RedoLogRecord* redoLogRecord2);
         void rollbackLastOp(const Metadata* metadata, TransactionBuffer* transactionBuffer, const RedoLogRecord* redoLogRecord1, const RedoLogRecord* redoLogRecord2);
         void rollbackLastOp(const Metadata* metadata, TransactionBuffer* transactionBuffer, const RedoLogRecord* redoLogRecord1);
         void flush(Metadata* metadata, TransactionBuffer* transactionBuffer, Builder* builder, typeScn lwnScn);
         void purge(TransactionBuffer* transactionBuffer);
+        [[nodiscard]] bool hasLobs() const;
+        void snapshot(const TransactionBuffer* transactionBuffer, std::ostringstream& ss, std::ostream& data, typeXidMap xidMap) const;
+        void restore(const Ctx* ctx, TransactionBuffer* transactionBuffer, const std::string& fileName,
+                     const rapidjson::Value& transactionJson, std::istream& data);
 
         inline void log(const Ctx* ctx, const char* msg, const RedoLogRecord* redoLogRecord1) const {
             if (likely(!dump && (ctx->trace & Ctx::TRACE_DUMP) == 0))
@@ -17,60 +17,137 @@ You should have received a copy of the GNU General Public License
 along with OpenLogReplicator; see the file LICENSE;  If not see
 <http://www.gnu.org/licenses/>.  */
 
+#include <cerrno>
 #include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "../common/RedoLogRecord.h"
+#include "../common/exception/DataException.h"
 #include "../common/exception/RedoLogException.h"
+#include "../common/exception/RuntimeException.h"
 #include "OpCode0501.h"
 #include "OpCode050B.h"
 #include "Transaction.h"
 #include "TransactionBuffer.h"
 
+#ifdef LINK_LZ4
+#include <lz4.h>
+#endif /* LINK_LZ4 */
+
 namespace OpenLogReplicator {
     
-    TransactionChunkRecord::TransactionChunkRecord(TransactionChunk* newTc, uint8_t* newRecord, uint64_t newRecordSize) :
-        tc(newTc),
-        record(newRecord), 
-        recordSize(newRecordSize) {
+    TransactionChunkRecord::TransactionChunkRecord(uint8_t* newRecord) :
+        record(newRecord) {
     }
 
-    uint64_t TransactionChunkRecord::size() {
+    uint64_t TransactionChunkRecord::size() const {
+        uint32_t recordSize;
+        memcpy(reinterpret_cast<void*>(&recordSize), reinterpret_cast<const void*>(record + TransactionChunk::ROW_HEADER_SIZE), sizeof(uint32_t));
         return recordSize;
     }
 
-    typeOp2 TransactionChunkRecord::opCode() {
-        return *reinterpret_cast<typeOp2*>(record + TransactionChunk::ROW_HEADER_OP);
+    typeOp2 TransactionChunkRecord::opCode() const {
+        typeOp2 op;
+        memcpy(reinterpret_cast<void*>(&op), reinterpret_cast<const void*>(record + TransactionChunk::ROW_HEADER_OP), sizeof(typeOp2));
+        return op;
     }
 
-    RedoLogRecord* TransactionChunkRecord::redo1() {
-        return reinterpret_cast<RedoLogRecord*>(record + TransactionChunk::ROW_HEADER_REDO1);
+    void TransactionChunkRecord::decode(RedoLogRecord* redoLogRecord1, RedoLogRecord* redoLogRecord2) const {
+        uint64_t pos = TransactionChunk::ROW_HEADER_REDO1;
+        pos += TransactionChunk::decode(redoLogRecord1, record + pos);
+        pos += TransactionChunk::decode(redoLogRecord2, record + pos);
+        redoLogRecord1->dataExt = record + pos;
+        redoLogRecord2->dataExt = record + pos + redoLogRecord1->size;
     }
 
-    RedoLogRecord* TransactionChunkRecord::redo2() {
-        return reinterpret_cast<RedoLogRecord*>(record + TransactionChunk::ROW_HEADER_REDO2);
+    void TransactionChunkRecord::next() {
+        record += size();
     }
 
-    uint8_t* TransactionChunkRecord::redoData1() {
-        return record + TransactionChunk::ROW_HEADER_DATA;
+    XidTransactionMap::XidTransactionMap() :
+            slots(new Slot[CAPACITY_MIN]),
+            mask(CAPACITY_MIN - 1),
+            count(0) {
+        for (uint64_t i = 0; i <= mask; ++i)
+            slots[i] = Slot(0, nullptr);
     }
 
-    uint8_t* TransactionChunkRecord::redoData2() {
-        RedoLogRecord* redoLogRecord1 = redo1();
-        return record + TransactionChunk::ROW_HEADER_DATA + redoLogRecord1->size;
+    XidTransactionMap::~XidTransactionMap() {
+        delete[] slots;
+        slots = nullptr;
     }
 
-    void TransactionChunkRecord::next() {
-        record = record + recordSize;
-        if (record >= (tc->buffer + tc->size))
-            return;
-        RedoLogRecord* redoLogRecord1 = reinterpret_cast<RedoLogRecord*>(record + TransactionChunk::ROW_HEADER_REDO1);
-        RedoLogRecord* redoLogRecord2 = reinterpret_cast<RedoLogRecord*>(record + TransactionChunk::ROW_HEADER_REDO2);
-        recordSize = *(reinterpret_cast<uint64_t*>(record + TransactionChunk::ROW_HEADER_DATA + redoLogRecord1->size + redoLogRecord2->size));
+    void XidTransactionMap::insert(typeXidMap xidMap, Transaction* transaction) {
+        // Load factor is kept below 1/2, so that the chains of probes are short
+        if ((count + 1) * 2 > mask + 1)
+            grow();
+
+        uint64_t i = hash(xidMap);
+        while (slots[i].second != nullptr && slots[i].first != xidMap)
+            i = (i + 1) & mask;
+        if (slots[i].second == nullptr)
+            ++count;
+        slots[i] = Slot(xidMap, transaction);
+    }
+
+    bool XidTransactionMap::erase(typeXidMap xidMap) {
+        uint64_t i = hash(xidMap);
+        while (slots[i].first != xidMap || slots[i].second == nullptr) {
+            if (slots[i].second == nullptr)
+                return false;
+            i = (i + 1) & mask;
+        }
+
+        // Move back the following slots of the chain which would not be found after the slot is emptied
+        for (uint64_t j = (i + 1) & mask; slots[j].second != nullptr; j = (j + 1) & mask) {
+            uint64_t home = hash(slots[j].first);
+            if (((j - home) & mask) >= ((j - i) & mask)) {
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        slots[i] = Slot(0, nullptr);
+        --count;
+        return true;
+    }
+
+    void XidTransactionMap::clear() {
+        for (uint64_t i = 0; i <= mask; ++i)
+            slots[i] = Slot(0, nullptr);
+        count = 0;
+    }
+
+    void XidTransactionMap::grow() {
+        Slot* oldSlots = slots;
+        uint64_t oldCapacity = mask + 1;
+
+        slots = new Slot[oldCapacity * 2];
+        mask = oldCapacity * 2 - 1;
+        for (uint64_t i = 0; i <= mask; ++i)
+            slots[i] = Slot(0, nullptr);
+
+        for (uint64_t i = 0; i < oldCapacity; ++i) {
+            if (oldSlots[i].second == nullptr)
+                continue;
+            uint64_t j = hash(oldSlots[i].first);
+            while (slots[j].second != nullptr)
+                j = (j + 1) & mask;
+            slots[j] = oldSlots[i];
+        }
+        delete[] oldSlots;
     }
 
     TransactionBuffer::TransactionBuffer(Ctx* newCtx) :
-            ctx(newCtx) {
+            ctx(newCtx),
+            spillSize(0),
+            coldTc(reinterpret_cast<TransactionChunk*>(new uint8_t[TransactionChunk::FULL_BUFFER_SIZE])),
+            compressBuffer(new uint8_t[TransactionChunk::FULL_BUFFER_SIZE]),
+            lwnTime(0),
+            lastCompressTime(0) {
         buffer[0] = 0;
+        positionNodes.reserve(TRANSACTION_POOL_MAX);
     }
 
     TransactionBuffer::~TransactionBuffer() {
@@ -81,15 +158,57 @@ namespace OpenLogReplicator {
         dumpXidList.clear();
         brokenXidMapList.clear();
         orphanedLobs.clear();
+
+        for (Transaction* transaction: transactionPool)
+            delete transaction;
+        transactionPool.clear();
+
+        delete[] reinterpret_cast<uint8_t*>(coldTc);
+        coldTc = nullptr;
+        delete[] compressBuffer;
+        compressBuffer = nullptr;
     }
 
     void TransactionBuffer::purge() {
         for (auto xidTransactionMapIt: xidTransactionMap) {
             Transaction* transaction = xidTransactionMapIt.second;
+            unregisterLobIds(transaction->xid, transaction->lobIdList);
             transaction->purge(this);
-            delete transaction;
+            releaseTransaction(transaction);
+        }
+        for (auto& skipLobIdMapIt: skipLobIdMap)
+            unregisterLobIds(skipLobIdMapIt.first, skipLobIdMapIt.second);
+        skipLobIdMap.clear();
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            xidTransactionMap.clear();
         }
-        xidTransactionMap.clear();
+        positionIndex.clear();
+    }
+
+    Transaction* TransactionBuffer::newTransaction(XmlCtx* xmlCtx, typeXid xid) {
+        Transaction* transaction;
+        {
+            std::unique_lock<std::mutex> lck(mtxMemory);
+            if (transactionPool.empty())
+                return new Transaction(xid, &orphanedLobs, &mtxOrphanedLobs, xmlCtx);
+
+            transaction = transactionPool.back();
+            transactionPool.pop_back();
+        }
+        transaction->reset(xid, xmlCtx);
+        return transaction;
+    }
+
+    void TransactionBuffer::releaseTransaction(Transaction* transaction) {
+        {
+            std::unique_lock<std::mutex> lck(mtxMemory);
+            if (transactionPool.size() < TRANSACTION_POOL_MAX) {
+                transactionPool.push_back(transaction);
+                return;
+            }
+        }
+        delete transaction;
     }
 
     Transaction* TransactionBuffer::findTransaction(XmlCtx* xmlCtx, typeXid xid, typeConId conId, bool old, bool add, bool rollback) {
@@ -97,20 +216,20 @@ namespace OpenLogReplicator {
         typeXidMap xidMap = (xid.getData() >> 32) | ((static_cast<uint64_t>(conId)) << 32);
         Transaction* transaction;
 
-        auto xidTransactionMapIt = xidTransactionMap.find(xidMap);          // Find transaction.
-        if (xidTransactionMapIt != xidTransactionMap.end()) {               // If there is it
-            transaction = xidTransactionMapIt->second;                      // return it,
+        transaction = xidTransactionMap.find(xidMap);                       // Find transaction.
+        if (transaction != nullptr) {                                       // If there is it return it,
             if (unlikely(!rollback && (!old || transaction->xid != xid)))   // ??
                 throw RedoLogException(50039, "transaction " + xid.toString() + " conflicts with " + transaction->xid.toString());
         } else {                                                            // else create transaction
             if (!add)                                                       // if add is true.
                 return nullptr;
 
-            transaction = new Transaction(xid, &orphanedLobs, xmlCtx);      // Create new transaction
+            transaction = newTransaction(xmlCtx, xid);                      // Create new transaction
             {
                 std::unique_lock<std::mutex> lck(mtx);
-                xidTransactionMap.insert_or_assign(xidMap, transaction);    // Save it by xidMap
+                xidTransactionMap.insert(xidMap, transaction);              // Save it by xidMap
             }
+            addPosition(transaction);
 
             if (dumpXidList.find(xid) != dumpXidList.end())                 // If transaction in dump ?, mark it
                 transaction->dump = true;
@@ -121,17 +240,103 @@ namespace OpenLogReplicator {
 
     void TransactionBuffer::dropTransaction(typeXid xid, typeConId conId) {
         typeXidMap xidMap = (xid.getData() >> 32) | (static_cast<uint64_t>(conId) << 32);
+        const Transaction* transaction = xidTransactionMap.find(xidMap);
+        if (transaction == nullptr)
+            return;
+
+        PositionIndex::node_type node = positionIndex.extract(std::make_tuple(transaction->thread, transaction->firstSequence, transaction->firstOffset,
+                                                                              transaction));
+        if (!node.empty() && positionNodes.size() < TRANSACTION_POOL_MAX)
+            positionNodes.push_back(std::move(node));
         {
             std::unique_lock<std::mutex> lck(mtx);
             xidTransactionMap.erase(xidMap);
         }
     }
 
+    void TransactionBuffer::skipTransaction(Transaction* transaction, typeConId conId) {
+        skipXidList.insert(transaction->xid);
+        dropTransaction(transaction->xid, conId);
+        // The LOB ids stay mapped until commit, so that the LOB data of the transaction is also skipped
+        if (!transaction->lobIdList.empty()) {
+            skipLobIdMap.insert_or_assign(transaction->xid, std::move(transaction->lobIdList));
+            transaction->lobIdList.clear();
+        }
+        transaction->purge(this);
+        releaseTransaction(transaction);
+    }
+
+    void TransactionBuffer::dropLobIds(typeXid xid, typeConId conId) {
+        auto skipLobIdMapIt = skipLobIdMap.find(xid);
+        if (skipLobIdMapIt != skipLobIdMap.end()) {
+            unregisterLobIds(xid, skipLobIdMapIt->second);
+            skipLobIdMap.erase(skipLobIdMapIt);
+        }
+
+        typeXidMap xidMap = (xid.getData() >> 32) | (static_cast<uint64_t>(conId) << 32);
+        Transaction* transaction = xidTransactionMap.find(xidMap);
+        if (transaction != nullptr && transaction->xid == xid)
+            unregisterLobIds(xid, transaction->lobIdList);
+    }
+
+    void TransactionBuffer::unregisterLobIds(typeXid xid, std::vector<typeLobId>& lobIdList) {
+        for (const typeLobId& lobId: lobIdList) {
+            auto lobIdToXidMapIt = ctx->lobIdToXidMap.find(lobId);
+            if (lobIdToXidMapIt != ctx->lobIdToXidMap.end() && lobIdToXidMapIt->second == xid)
+                ctx->lobIdToXidMap.erase(lobIdToXidMapIt);
+        }
+        lobIdList.clear();
+    }
+
+    void TransactionBuffer::addPosition(const Transaction* transaction) {
+        if (positionNodes.empty()) {
+            positionIndex.emplace(transaction->thread, transaction->firstSequence, transaction->firstOffset, transaction);
+            return;
+        }
+
+        PositionIndex::node_type node = std::move(positionNodes.back());
+        positionNodes.pop_back();
+        node.value() = std::make_tuple(transaction->thread, transaction->firstSequence, transaction->firstOffset, transaction);
+        positionIndex.insert(std::move(node));
+    }
+
+    void TransactionBuffer::setTransactionPosition(Transaction* transaction, uint16_t thread, typeSeq sequence, uint64_t offset) {
+        // The node is moved to the new position, without allocation
+        PositionIndex::node_type node = positionIndex.extract(std::make_tuple(transaction->thread, transaction->firstSequence, transaction->firstOffset,
+                                                                              transaction));
+        transaction->thread = thread;
+        transaction->firstSequence = sequence;
+        transaction->firstOffset = offset;
+        if (node.empty()) {
+            addPosition(transaction);
+            return;
+        }
+
+        node.value() = std::make_tuple(thread, sequence, offset, transaction);
+        positionIndex.insert(std::move(node));
+    }
+
     TransactionChunk* TransactionBuffer::newTransactionChunk() {
+        if (!ctx->spillPath.empty() && ctx->getAvailableMemory() <= SPILL_RESERVE_MB) {
+            bool spill;
+            {
+                std::unique_lock<std::mutex> lck(mtxMemory);
+                spill = partiallyFullChunks.empty();
+            }
+            if (spill)
+                spillTransactions();
+        }
+
+        return allocateTransactionChunk();
+    }
+
+    TransactionChunk* TransactionBuffer::allocateTransactionChunk() {
         uint8_t* chunk;
         TransactionChunk* tc;
         uint64_t pos;
         uint64_t freeMap;
+        std::unique_lock<std::mutex> lck(mtxMemory);
+
         if (!partiallyFullChunks.empty()) {
             auto partiallyFullChunksIt = partiallyFullChunks.cbegin();  // get random chunk
             chunk = partiallyFullChunksIt->first;                       // exp address: 0xAF78FSF4
@@ -143,9 +348,12 @@ namespace OpenLogReplicator {
             else
                 partiallyFullChunks.insert_or_assign(chunk, freeMap);   // else update chunk info
         } else {
+            // The lock is not held while waiting for memory, the flush thread may release chunks meanwhile
+            lck.unlock();
             chunk = ctx->getMemoryChunk(Ctx::MEMORY_MODULE_TRANSACTIONS, false);    // get chunk 1Mb
             pos = 0;                                                                // pos = 0
             freeMap = BUFFERS_FREE_MASK & (~1);                                     // 0b1111111111111110
+            lck.lock();
             partiallyFullChunks.insert_or_assign(chunk, freeMap);                   // mark 1 chunk full
         }
 
@@ -161,6 +369,7 @@ namespace OpenLogReplicator {
         // get self position
         uint8_t* chunk = tc->header;
         typePos pos = tc->pos;
+        std::unique_lock<std::mutex> lck(mtxMemory);
         uint64_t freeMap = partiallyFullChunks[chunk];
 
         freeMap |= (1 << pos);                          // exp: 0b1111111111110000 | 0b10 = 0b1111111111110010
@@ -183,7 +392,7 @@ namespace OpenLogReplicator {
     }
 
     void TransactionBuffer::addTransactionChunk(Transaction* transaction, RedoLogRecord* redoLogRecord) {
-        uint64_t chunkSize = redoLogRecord->size + TransactionChunk::ROW_HEADER_TOTAL;
+        uint64_t chunkSize = TransactionChunk::recordSize(redoLogRecord);
 
         if (unlikely(chunkSize > TransactionChunk::DATA_BUFFER_SIZE))
             throw RedoLogException(50040, "block size (" + std::to_string(chunkSize) + ") exceeding max block size (" +
@@ -194,14 +403,15 @@ namespace OpenLogReplicator {
                 throw RedoLogException(50041, "bad split offset: " + std::to_string(redoLogRecord->dataOffset) + " xid: " +
                                               transaction->xid.toString());
 
-            TransactionChunkRecord tcr = transaction->lastTc->lastRecord();
-            RedoLogRecord* last501 = tcr.redo1();
-            last501->dataExt = tcr.redoData1();
+            RedoLogRecord last501;
+            RedoLogRecord last501Redo2;
+            transaction->lastTc->lastRecord().decode(&last501, &last501Redo2);
 
-            uint64_t mergeSize = last501->size + redoLogRecord->size;
+            uint64_t mergeSize = last501.size + redoLogRecord->size;
             transaction->mergeBuffer = new uint8_t[mergeSize];
-            mergeBlocks(transaction->mergeBuffer, redoLogRecord, last501);
+            mergeBlocks(transaction->mergeBuffer, redoLogRecord, &last501);
             rollbackTransactionChunk(transaction);
+            chunkSize = TransactionChunk::recordSize(redoLogRecord);
         }
         if ((redoLogRecord->flg & (OpCode::FLG_MULTIBLOCKUNDOTAIL | OpCode::FLG_MULTIBLOCKUNDOMID)) != 0)
             transaction->lastSplit = true;
@@ -226,6 +436,7 @@ namespace OpenLogReplicator {
         TransactionChunk* tc = transaction->lastTc;
         tc->appendTransaction(redoLogRecord);
         transaction->size += chunkSize;
+        transaction->lastTime = lwnTime;
 
         if (transaction->mergeBuffer != nullptr) {
             delete[] transaction->mergeBuffer;
@@ -234,7 +445,7 @@ namespace OpenLogReplicator {
     }
 
     void TransactionBuffer::addTransactionChunk(Transaction* transaction, RedoLogRecord* redoLogRecord1, const RedoLogRecord* redoLogRecord2) {
-        uint64_t chunkSize = redoLogRecord1->size + redoLogRecord2->size + TransactionChunk::ROW_HEADER_TOTAL;
+        uint64_t chunkSize = TransactionChunk::recordSize(redoLogRecord1, redoLogRecord2);
 
         if (unlikely(chunkSize > TransactionChunk::DATA_BUFFER_SIZE))
             throw RedoLogException(50040, "block size (" + std::to_string(chunkSize) + ") exceeding max block size (" +
@@ -248,13 +459,13 @@ namespace OpenLogReplicator {
                 throw RedoLogException(50043, "bad split offset: " + std::to_string(redoLogRecord1->dataOffset) + " xid: " +
                                               transaction->xid.toString() + " second position");
 
-            TransactionChunkRecord tcr = transaction->lastTc->lastRecord();
-            RedoLogRecord* last501 = tcr.redo1();
-            last501->dataExt = tcr.redoData1();
+            RedoLogRecord last501;
+            RedoLogRecord last501Redo2;
+            transaction->lastTc->lastRecord().decode(&last501, &last501Redo2);
 
-            uint32_t mergeSize = last501->size + redoLogRecord1->size;
+            uint32_t mergeSize = last501.size + redoLogRecord1->size;
             transaction->mergeBuffer = new uint8_t[mergeSize];
-            mergeBlocks(transaction->mergeBuffer, redoLogRecord1, last501);
+            mergeBlocks(transaction->mergeBuffer, redoLogRecord1, &last501);
 
             typePos fieldPos = redoLogRecord1->fieldPos;
             typeSize fieldSize = ctx->read16(redoLogRecord1->data() + redoLogRecord1->fieldSizesDelta + 1 * 2);
@@ -262,7 +473,7 @@ namespace OpenLogReplicator {
 
             ctx->write16(redoLogRecord1->data() + fieldPos + 20, redoLogRecord1->flg);
             OpCode0501::process0501(ctx, redoLogRecord1);
-            chunkSize = redoLogRecord1->size + redoLogRecord2->size + TransactionChunk::ROW_HEADER_TOTAL;
+            chunkSize = TransactionChunk::recordSize(redoLogRecord1, redoLogRecord2);
 
             rollbackTransactionChunk(transaction);
             transaction->lastSplit = false;
@@ -286,6 +497,7 @@ namespace OpenLogReplicator {
         TransactionChunk* tc = transaction->lastTc;
         tc->appendTransaction(redoLogRecord1, redoLogRecord2);
         transaction->size += chunkSize;
+        transaction->lastTime = lwnTime;
         
 
         if (transaction->mergeBuffer != nullptr) {
@@ -297,7 +509,7 @@ namespace OpenLogReplicator {
     void TransactionBuffer::rollbackTransactionChunk(Transaction* transaction) {
         if (unlikely(transaction->lastTc == nullptr))
             throw RedoLogException(50044, "trying to remove from empty buffer size: <null> elements: <null>");
-        if (unlikely(transaction->lastTc->size < TransactionChunk::ROW_HEADER_TOTAL || transaction->lastTc->elements == 0))
+        if (unlikely(transaction->lastTc->size < TransactionChunk::ROW_HEADER_MIN || transaction->lastTc->elements == 0))
             throw RedoLogException(50044, "trying to remove from empty buffer size: " + std::to_string(transaction->lastTc->size) +
                                           " elements: " + std::to_string(transaction->lastTc->elements));
 
@@ -317,9 +529,274 @@ namespace OpenLogReplicator {
                 transaction->firstTc = nullptr;
             }
             deleteTransactionChunk(tc);
+
+            // Bring back the last compressed or spilled chunk, so that the rollback can continue
+            if (unlikely(transaction->lastTc == nullptr && transaction->compressedLastTc != nullptr)) {
+                transaction->locked = true;
+                tc = newTransactionChunk();
+                transaction->locked = false;
+
+                TransactionChunk* packedTc = transaction->compressedLastTc;
+                uint32_t frameSize;
+                memcpy(reinterpret_cast<void*>(&frameSize), reinterpret_cast<const void*>(packedTc->end() - sizeof(uint32_t)), sizeof(uint32_t));
+                decompressChunk(packedTc->end() - frameSize, tc);
+                --transaction->compressedChunks;
+                transaction->compressedSize -= tc->size;
+                transaction->firstTc = tc;
+                transaction->lastTc = tc;
+
+                packedTc->size -= frameSize;
+                --packedTc->elements;
+                if (packedTc->elements == 0) {
+                    transaction->compressedLastTc = packedTc->prev;
+                    if (transaction->compressedLastTc != nullptr)
+                        transaction->compressedLastTc->next = nullptr;
+                    else
+                        transaction->compressedFirstTc = nullptr;
+                    deleteTransactionChunk(packedTc);
+                }
+            } else if (unlikely(transaction->lastTc == nullptr && transaction->spillChunks > 0)) {
+                tc = unspillTransactionChunk(transaction, transaction->spillChunks - 1);
+                --transaction->spillChunks;
+                transaction->spillSize -= tc->size;
+                spillSize -= TransactionChunk::FULL_BUFFER_SIZE;
+                transaction->firstTc = tc;
+                transaction->lastTc = tc;
+
+                if (transaction->spillChunks == 0)
+                    dropSpill(transaction);
+                else if (unlikely(ftruncate(transaction->spillFd, transaction->spillChunks * TransactionChunk::FULL_BUFFER_SIZE) != 0))
+                    throw RuntimeException(10007, "file: " + spillFileName(transaction) + " - truncate returned: " + strerror(errno));
+            }
+        }
+    }
+
+    std::string TransactionBuffer::spillFileName(const Transaction* transaction) const {
+        return ctx->spillPath + "/" + transaction->xid.toString() + ".spill";
+    }
+
+    void TransactionBuffer::spillTransactions() {
+        // The biggest transaction in memory, the one being flushed and the last chunk of every transaction are not moved
+        Transaction* spillTransaction = nullptr;
+        uint64_t spillTransactionSize = 0;
+        for (auto xidTransactionMapIt: xidTransactionMap) {
+            Transaction* transaction = xidTransactionMapIt.second;
+            if (transaction->locked || (transaction->compressedFirstTc == nullptr && transaction->firstTc == transaction->lastTc))
+                continue;
+            if (transaction->size - transaction->spillSize - transaction->compressedSize > spillTransactionSize) {
+                spillTransaction = transaction;
+                spillTransactionSize = transaction->size - transaction->spillSize - transaction->compressedSize;
+            }
+        }
+        if (spillTransaction == nullptr)
+            return;
+
+        for (uint64_t i = 0; i < SPILL_BATCH_CHUNKS && (spillTransaction->compressedFirstTc != nullptr ||
+                spillTransaction->firstTc != spillTransaction->lastTc); ++i) {
+            if (ctx->spillSizeMax > 0 && spillSize + TransactionChunk::FULL_BUFFER_SIZE > ctx->spillSizeMax)
+                return;
+            spillTransactionChunk(spillTransaction);
+        }
+    }
+
+    void TransactionBuffer::spillTransactionChunk(Transaction* transaction) {
+        if (transaction->spillFd == -1) {
+            std::string fileName = spillFileName(transaction);
+            transaction->spillFd = open(fileName.c_str(), O_CREAT | O_RDWR | O_TRUNC, S_IRUSR | S_IWUSR);
+            if (unlikely(transaction->spillFd == -1))
+                throw RuntimeException(10006, "file: " + fileName + " - open for write returned: " + strerror(errno));
+
+            // The file has no name, the space is released when it is closed, also after a crash
+            if (unlikely(unlink(fileName.c_str()) != 0))
+                throw RuntimeException(10010, "file: " + fileName + " - delete returned: " + strerror(errno));
+
+            if (unlikely(ctx->trace & Ctx::TRACE_TRANSACTION))
+                ctx->OLR_TRACE(Ctx::TRACE_TRANSACTION, "spill xid: " + transaction->xid.toString() + " size: " + std::to_string(transaction->size));
+        }
+
+        // The compressed chunks are older than the chunks in memory
+        TransactionChunk* tc = transaction->firstTc;
+        if (transaction->compressedFirstTc != nullptr) {
+            tc = coldTc;
+            popCompressedChunk(transaction, tc);
+        }
+
+        int64_t bytesWritten = pwrite(transaction->spillFd, tc, TransactionChunk::FULL_BUFFER_SIZE,
+                                      static_cast<off_t>(transaction->spillChunks * TransactionChunk::FULL_BUFFER_SIZE));
+        if (unlikely(bytesWritten != static_cast<int64_t>(TransactionChunk::FULL_BUFFER_SIZE)))
+            throw RuntimeException(10007, "file: " + spillFileName(transaction) + " - " + std::to_string(bytesWritten) +
+                                          " bytes written instead of " + std::to_string(TransactionChunk::FULL_BUFFER_SIZE) +
+                                          ", code returned: " + strerror(errno));
+
+        ++transaction->spillChunks;
+        transaction->spillSize += tc->size;
+        spillSize += TransactionChunk::FULL_BUFFER_SIZE;
+
+        if (tc == coldTc)
+            return;
+        transaction->firstTc = tc->next;
+        transaction->firstTc->prev = nullptr;
+        deleteTransactionChunk(tc);
+    }
+
+    void TransactionBuffer::compressTransactions(time_t time) {
+        lwnTime = time;
+        if (time == lastCompressTime)
+            return;
+        lastCompressTime = time;
+
+        for (auto xidTransactionMapIt: xidTransactionMap) {
+            Transaction* transaction = xidTransactionMapIt.second;
+            if (transaction->firstTc == transaction->lastTc || transaction->locked ||
+                    transaction->lastTime + static_cast<time_t>(ctx->compressIdleS) > time)
+                continue;
+            compressTransaction(transaction);
+        }
+    }
+
+    void TransactionBuffer::compressTransaction(Transaction* transaction) {
+        transaction->locked = true;
+        while (transaction->firstTc != transaction->lastTc) {
+            TransactionChunk* tc = transaction->firstTc;
+            if (!compressTransactionChunk(transaction, tc))
+                break;
+
+            ++transaction->compressedChunks;
+            transaction->compressedSize += tc->size;
+            transaction->firstTc = tc->next;
+            transaction->firstTc->prev = nullptr;
+            deleteTransactionChunk(tc);
+        }
+        transaction->locked = false;
+    }
+
+    bool TransactionBuffer::compressTransactionChunk(Transaction* transaction, const TransactionChunk* tc) {
+#ifdef LINK_LZ4
+        // Compress to the spare buffer first, the frame is copied to the last compressed chunk of the transaction or to a new one
+        uint8_t* frame = compressBuffer;
+        int compressedSize = LZ4_compress_default(reinterpret_cast<const char*>(tc->buffer),
+                                                  reinterpret_cast<char*>(frame + COMPRESS_FRAME_HEADER), static_cast<int>(tc->size),
+                                                  static_cast<int>(tc->size * COMPRESS_RATIO_MAX_PERCENT / 100));
+        if (compressedSize <= 0)
+            return false;
+
+        uint32_t frameSize = compressedSize + COMPRESS_FRAME_OVERHEAD;
+        uint32_t elements = tc->elements;
+        uint32_t size = tc->size;
+        memcpy(reinterpret_cast<void*>(frame), reinterpret_cast<const void*>(&frameSize), sizeof(uint32_t));
+        memcpy(reinterpret_cast<void*>(frame + sizeof(uint32_t)), reinterpret_cast<const void*>(&elements), sizeof(uint32_t));
+        memcpy(reinterpret_cast<void*>(frame + sizeof(uint32_t) + sizeof(uint32_t)), reinterpret_cast<const void*>(&size), sizeof(uint32_t));
+        memcpy(reinterpret_cast<void*>(frame + frameSize - sizeof(uint32_t)), reinterpret_cast<const void*>(&frameSize), sizeof(uint32_t));
+
+        TransactionChunk* packedTc = transaction->compressedLastTc;
+        if (packedTc == nullptr || packedTc->size + frameSize > TransactionChunk::DATA_BUFFER_SIZE) {
+            packedTc = newTransactionChunk();
+            packedTc->prev = transaction->compressedLastTc;
+            if (transaction->compressedLastTc != nullptr)
+                transaction->compressedLastTc->next = packedTc;
+            else
+                transaction->compressedFirstTc = packedTc;
+            transaction->compressedLastTc = packedTc;
+        }
+
+        memcpy(reinterpret_cast<void*>(packedTc->end()), reinterpret_cast<const void*>(frame), frameSize);
+        packedTc->size += frameSize;
+        ++packedTc->elements;
+        return true;
+#else
+        (void)transaction;
+        (void)tc;
+        return false;
+#endif /* LINK_LZ4 */
+    }
+
+    uint64_t TransactionBuffer::decompressChunk(const uint8_t* frame, TransactionChunk* tc) const {
+        uint32_t frameSize;
+        uint32_t elements;
+        uint32_t size;
+        memcpy(reinterpret_cast<void*>(&frameSize), reinterpret_cast<const void*>(frame), sizeof(uint32_t));
+        memcpy(reinterpret_cast<void*>(&elements), reinterpret_cast<const void*>(frame + sizeof(uint32_t)), sizeof(uint32_t));
+        memcpy(reinterpret_cast<void*>(&size), reinterpret_cast<const void*>(frame + sizeof(uint32_t) + sizeof(uint32_t)), sizeof(uint32_t));
+
+#ifdef LINK_LZ4
+        int decompressedSize = LZ4_decompress_safe(reinterpret_cast<const char*>(frame + COMPRESS_FRAME_HEADER), reinterpret_cast<char*>(tc->buffer),
+                                                   static_cast<int>(frameSize - COMPRESS_FRAME_OVERHEAD),
+                                                   static_cast<int>(TransactionChunk::DATA_BUFFER_SIZE));
+#else
+        int decompressedSize = -1;
+#endif /* LINK_LZ4 */
+        if (unlikely(decompressedSize < 0 || static_cast<uint32_t>(decompressedSize) != size))
+            throw RuntimeException(10078, "transaction chunk decompression failed, size: " + std::to_string(size) + ", result: " +
+                                          std::to_string(decompressedSize));
+
+        tc->elements = elements;
+        tc->size = size;
+        return frameSize;
+    }
+
+    void TransactionBuffer::popCompressedChunk(Transaction* transaction, TransactionChunk* tc) {
+        TransactionChunk* packedTc = transaction->compressedFirstTc;
+        transaction->compressedPos += decompressChunk(packedTc->buffer + transaction->compressedPos, tc);
+        --transaction->compressedChunks;
+        transaction->compressedSize -= tc->size;
+        --packedTc->elements;
+
+        if (packedTc->elements == 0) {
+            transaction->compressedFirstTc = packedTc->next;
+            if (transaction->compressedFirstTc != nullptr)
+                transaction->compressedFirstTc->prev = nullptr;
+            else
+                transaction->compressedLastTc = nullptr;
+            transaction->compressedPos = 0;
+            deleteTransactionChunk(packedTc);
         }
     }
 
+    TransactionChunk* TransactionBuffer::takeColdTransactionChunk(Transaction* transaction, uint64_t& spillPos) {
+        if (spillPos < transaction->spillChunks)
+            return unspillTransactionChunk(transaction, spillPos++);
+
+        if (transaction->compressedFirstTc != nullptr) {
+            TransactionChunk* tc = allocateTransactionChunk();
+            popCompressedChunk(transaction, tc);
+            return tc;
+        }
+
+        return nullptr;
+    }
+
+    void TransactionBuffer::readSpilledChunk(const Transaction* transaction, uint64_t index, TransactionChunk* tc) const {
+        int64_t bytesRead = pread(transaction->spillFd, tc, TransactionChunk::FULL_BUFFER_SIZE,
+                                  static_cast<off_t>(index * TransactionChunk::FULL_BUFFER_SIZE));
+        if (unlikely(bytesRead != static_cast<int64_t>(TransactionChunk::FULL_BUFFER_SIZE)))
+            throw RuntimeException(10005, "file: " + spillFileName(transaction) + " - " + std::to_string(bytesRead) +
+                                          " bytes read instead of " + std::to_string(TransactionChunk::FULL_BUFFER_SIZE));
+    }
+
+    TransactionChunk* TransactionBuffer::unspillTransactionChunk(const Transaction* transaction, uint64_t index) {
+        TransactionChunk* tc = allocateTransactionChunk();
+        uint8_t* header = tc->header;
+        uint64_t pos = tc->pos;
+
+        readSpilledChunk(transaction, index, tc);
+        tc->header = header;
+        tc->pos = pos;
+        tc->prev = nullptr;
+        tc->next = nullptr;
+        return tc;
+    }
+
+    void TransactionBuffer::dropSpill(Transaction* transaction) {
+        if (transaction->spillFd == -1)
+            return;
+
+        close(transaction->spillFd);
+        transaction->spillFd = -1;
+        spillSize -= transaction->spillChunks * TransactionChunk::FULL_BUFFER_SIZE;
+        transaction->spillChunks = 0;
+        transaction->spillSize = 0;
+    }
+
     void TransactionBuffer::mergeBlocks(uint8_t* mergeBuffer, RedoLogRecord* redoLogRecord1, const RedoLogRecord* redoLogRecord2) {
         memcpy(reinterpret_cast<void*>(mergeBuffer),
                reinterpret_cast<const void*>(redoLogRecord1->data()), redoLogRecord1->fieldSizesDelta);
@@ -367,8 +844,10 @@ namespace OpenLogReplicator {
     }
 
     void TransactionBuffer::checkpoint(typeSeq& minSequence, uint64_t& minOffset, typeXid& minXid) {
-        for (auto xidTransactionMapIt: xidTransactionMap) {
-            const Transaction* transaction = xidTransactionMapIt.second;
+        // The first transaction of every redo thread is compared, without merged threads there is usually one
+        auto positionIndexIt = positionIndex.cbegin();
+        while (positionIndexIt != positionIndex.cend()) {
+            const Transaction* transaction = std::get<3>(*positionIndexIt);
             if (transaction->firstSequence < minSequence) {
                 minSequence = transaction->firstSequence;
                 minOffset = transaction->firstOffset;
@@ -377,9 +856,130 @@ namespace OpenLogReplicator {
                 minOffset = transaction->firstOffset;
                 minXid = transaction->xid;
             }
+
+            if (transaction->thread == UINT16_MAX)
+                break;
+            positionIndexIt = positionIndex.lower_bound(PositionIndex::key_type(transaction->thread + 1, 0, 0, nullptr));
         }
     }
 
+    void TransactionBuffer::checkpointThread(uint16_t thread, typeSeq& minSequence, uint64_t& minOffset, typeXid& minXid) {
+        auto positionIndexIt = positionIndex.lower_bound(PositionIndex::key_type(thread, 0, 0, nullptr));
+        if (positionIndexIt == positionIndex.cend() || std::get<0>(*positionIndexIt) != thread)
+            return;
+
+        const Transaction* transaction = std::get<3>(*positionIndexIt);
+        minSequence = transaction->firstSequence;
+        minOffset = transaction->firstOffset;
+        minXid = transaction->xid;
+    }
+
+    bool TransactionBuffer::isSnapshotPossible(uint64_t& dataSize) {
+        {
+            std::unique_lock<std::mutex> lck(mtxOrphanedLobs);
+            if (!orphanedLobs.empty())
+                return false;
+        }
+
+        dataSize = 0;
+        for (auto xidTransactionMapIt: xidTransactionMap) {
+            const Transaction* transaction = xidTransactionMapIt.second;
+            if (transaction->hasLobs() || transaction->mergeBuffer != nullptr)
+                return false;
+            dataSize += transaction->size;
+        }
+        return true;
+    }
+
+    void TransactionBuffer::snapshot(std::ostringstream& ss, std::ostream& data) {
+        ss << R"({"version":)" << std::dec << SNAPSHOT_VERSION <<
+           R"(,"record-size":)" << std::dec << sizeof(RedoLogRecord) <<
+           R"(,"chunk-size":)" << std::dec << TransactionChunk::DATA_BUFFER_SIZE <<
+           R"(,"big-endian":)" << std::dec << (ctx->isBigEndian() ? 1 : 0) <<
+           R"(,"broken-xid-map":[)";
+
+        bool hasPrev = false;
+        for (typeXidMap xidMap: brokenXidMapList) {
+            if (hasPrev)
+                ss << ",";
+            else
+                hasPrev = true;
+            ss << std::dec << xidMap;
+        }
+
+        ss << R"(],"transactions":[)";
+        hasPrev = false;
+        for (auto xidTransactionMapIt: xidTransactionMap) {
+            if (hasPrev)
+                ss << ",";
+            else
+                hasPrev = true;
+            xidTransactionMapIt.second->snapshot(this, ss, data, xidTransactionMapIt.first);
+        }
+        ss << "]}";
+    }
+
+    uint64_t TransactionBuffer::restore(XmlCtx* xmlCtx, const std::string& fileName, const std::string& in, std::istream& data) {
+        rapidjson::Document document;
+        if (unlikely(in.length() == 0 || document.Parse(in.c_str()).HasParseError()))
+            throw DataException(20001, "file: " + fileName + " offset: " + std::to_string(document.GetErrorOffset()) +
+                                       " - parse error: " + GetParseError_En(document.GetParseError()));
+
+        if (!ctx->disableChecksSet(Ctx::DISABLE_CHECKS_JSON_TAGS)) {
+            static const char* documentChildNames[] = {"version", "record-size", "chunk-size", "big-endian", "broken-xid-map", "transactions",
+                                                       nullptr};
+            Ctx::checkJsonFields(fileName, document, documentChildNames);
+        }
+
+        uint64_t version = Ctx::getJsonFieldU64(fileName, document, "version");
+        if (unlikely(version != SNAPSHOT_VERSION))
+            throw DataException(20006, "file: " + fileName + " - incompatible version: " + std::to_string(version) + ", expected: " +
+                                       std::to_string(SNAPSHOT_VERSION));
+
+        // The records are stored in memory layout of the program which created the file
+        uint64_t recordSize = Ctx::getJsonFieldU64(fileName, document, "record-size");
+        uint64_t chunkSize = Ctx::getJsonFieldU64(fileName, document, "chunk-size");
+        uint64_t bigEndian = Ctx::getJsonFieldU64(fileName, document, "big-endian");
+        if (unlikely(recordSize != sizeof(RedoLogRecord) || chunkSize != TransactionChunk::DATA_BUFFER_SIZE ||
+                     bigEndian != (ctx->isBigEndian() ? 1 : 0)))
+            throw DataException(20006, "file: " + fileName + " - incompatible record size: " + std::to_string(recordSize) + ", chunk size: " +
+                                       std::to_string(chunkSize) + ", big-endian: " + std::to_string(bigEndian));
+
+        const rapidjson::Value& brokenXidMapJson = Ctx::getJsonFieldA(fileName, document, "broken-xid-map");
+        for (rapidjson::SizeType i = 0; i < brokenXidMapJson.Size(); ++i) {
+            if (unlikely(!brokenXidMapJson[i].IsUint64()))
+                throw DataException(20003, "file: " + fileName + " - parse error, field broken-xid-map is not an unsigned 64-bit number");
+            brokenXidMapList.insert(brokenXidMapJson[i].GetUint64());
+        }
+
+        const rapidjson::Value& transactionsJson = Ctx::getJsonFieldA(fileName, document, "transactions");
+        for (rapidjson::SizeType i = 0; i < transactionsJson.Size(); ++i) {
+            if (!ctx->disableChecksSet(Ctx::DISABLE_CHECKS_JSON_TAGS)) {
+                static const char* transactionsChildNames[] = {"xid", "xid-map", "seq", "offset", "thread", "begin", "rollback", "system",
+                                                               "schema", "split", "op-codes", "attributes", "chunks", nullptr};
+                Ctx::checkJsonFields(fileName, transactionsJson[i], transactionsChildNames);
+            }
+
+            typeXid xid(Ctx::getJsonFieldU64(fileName, transactionsJson[i], "xid"));
+            typeXidMap xidMap = Ctx::getJsonFieldU64(fileName, transactionsJson[i], "xid-map");
+            Transaction* transaction = newTransaction(xmlCtx, xid);
+            {
+                std::unique_lock<std::mutex> lck(mtx);
+                xidTransactionMap.insert(xidMap, transaction);
+            }
+            if (dumpXidList.find(xid) != dumpXidList.end())
+                transaction->dump = true;
+
+            transaction->restore(ctx, this, fileName, transactionsJson[i], data);
+            addPosition(transaction);
+        }
+
+        if (unlikely(data.peek() != std::istream::traits_type::eof()))
+            throw DataException(20003, "file: " + fileName + " - parse error, data not matching the index");
+
+        return transactionsJson.Size();
+    }
+
     void TransactionBuffer::addOrphanedLob(RedoLogRecord* redoLogRecord1) {
         if (unlikely(ctx->trace & Ctx::TRACE_LOB))
             ctx->OLR_TRACE(Ctx::TRACE_LOB, "id: " + redoLogRecord1->lobId.upper() + " page: " + std::to_string(redoLogRecord1->dba) +
@@ -387,6 +987,7 @@ namespace OpenLogReplicator {
 
         LobKey lobKey(redoLogRecord1->lobId, redoLogRecord1->dba);
 
+        std::unique_lock<std::mutex> lck(mtxOrphanedLobs);
         if (orphanedLobs.find(lobKey) != orphanedLobs.end()) {
             ctx->OLR_WARN(60009, "duplicate orphaned lob: " + redoLogRecord1->lobId.lower() + ", page: " +
                                 std::to_string(redoLogRecord1->dba));
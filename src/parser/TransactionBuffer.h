@@ -17,10 +17,17 @@ You should have received a copy of the GNU General Public License
 along with OpenLogReplicator; see the file LICENSE;  If not see
 <http://www.gnu.org/licenses/>.  */
 
+#include <atomic>
+#include <cstddef>
+#include <cstring>
 #include <map>
 #include <mutex>
 #include <set>
+#include <sstream>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "../common/Ctx.h"
 #include "../common/LobKey.h"
@@ -39,19 +46,18 @@ namespace OpenLogReplicator {
 
     class TransactionChunkRecord {
     public:
-        TransactionChunkRecord(TransactionChunk* newTc, uint8_t* newRecord, uint64_t newRecordSize);
-        uint64_t size();
-        typeOp2 opCode();
-        RedoLogRecord* redo1();
-        RedoLogRecord* redo2();
-        uint8_t* redoData1();
-        uint8_t* redoData2();
+        explicit TransactionChunkRecord(uint8_t* newRecord);
+        uint64_t size() const;
+        typeOp2 opCode() const;
+
+        /// @brief Rebuild the records, the data pointers are set to the data stored in the chunk.
+        /// @param redoLogRecord1 first record
+        /// @param redoLogRecord2 second record, all fields are zero if the operation has just one record
+        void decode(RedoLogRecord* redoLogRecord1, RedoLogRecord* redoLogRecord2) const;
         void next();
 
     private:
-        TransactionChunk* tc;
         uint8_t* record;
-        uint64_t recordSize;
     };
 
     struct TransactionChunk {
@@ -59,12 +65,21 @@ namespace OpenLogReplicator {
         static constexpr uint64_t HEADER_BUFFER_SIZE = sizeof(uint64_t) + sizeof(uint64_t) + sizeof(uint64_t) + sizeof(uint8_t*) + // 48 byte
                                                        sizeof(TransactionChunk*) + sizeof(TransactionChunk*); 
         static constexpr uint64_t DATA_BUFFER_SIZE = FULL_BUFFER_SIZE - HEADER_BUFFER_SIZE;
-        static constexpr uint64_t ROW_HEADER_OP = 0;
-        static constexpr uint64_t ROW_HEADER_REDO1 = sizeof(typeOp2);
-        static constexpr uint64_t ROW_HEADER_REDO2 = sizeof(typeOp2) + sizeof(RedoLogRecord);
-        static constexpr uint64_t ROW_HEADER_DATA = sizeof(typeOp2) + sizeof(RedoLogRecord) + sizeof(RedoLogRecord);
-        static constexpr uint64_t ROW_HEADER_SIZE = sizeof(typeOp2) + sizeof(RedoLogRecord) + sizeof(RedoLogRecord);
-        static constexpr uint64_t ROW_HEADER_TOTAL = sizeof(typeOp2) + sizeof(RedoLogRecord) + sizeof(RedoLogRecord) + sizeof(uint64_t);
+
+        // | size (4) | op (4) | redo1 header (8 - 216) | redo2 header (8 - 216) | redo1 data | redo2 data | size (4) |
+        // The redo header is a bitmap of non-zero 32-bit words of RedoLogRecord followed by the values of these words
+        static constexpr uint64_t RECORD_WORDS = sizeof(RedoLogRecord) / sizeof(uint32_t);
+        static constexpr uint64_t RECORD_WORDS_SKIP = sizeof(uint8_t*) / sizeof(uint32_t); // dataExt is set when the record is read
+        static constexpr uint64_t RECORD_HEADER_MAX = sizeof(uint64_t) + sizeof(RedoLogRecord);
+        static constexpr uint64_t ROW_HEADER_SIZE = 0;
+        static constexpr uint64_t ROW_HEADER_OP = sizeof(uint32_t);
+        static constexpr uint64_t ROW_HEADER_REDO1 = sizeof(uint32_t) + sizeof(typeOp2);
+        static constexpr uint64_t ROW_FOOTER_SIZE = sizeof(uint32_t);
+        static constexpr uint64_t ROW_HEADER_MIN = ROW_HEADER_REDO1 + sizeof(uint64_t) + sizeof(uint64_t) + ROW_FOOTER_SIZE;
+        static constexpr uint64_t ROW_HEADER_TOTAL = ROW_HEADER_REDO1 + RECORD_HEADER_MAX + RECORD_HEADER_MAX + ROW_FOOTER_SIZE;
+
+        static_assert(sizeof(RedoLogRecord) % sizeof(uint32_t) == 0 && RECORD_WORDS <= 64, "RedoLogRecord can't be encoded with 64-bit bitmap");
+        static_assert(offsetof(RedoLogRecord, dataExt) == 0, "RedoLogRecord::dataExt must be the first field");
 
         uint64_t elements;
         uint64_t size;
@@ -83,78 +98,254 @@ namespace OpenLogReplicator {
         }
 
         TransactionChunkRecord firstRecord() {
-            RedoLogRecord* redoLogRecord1 = reinterpret_cast<RedoLogRecord*>(begin() + ROW_HEADER_REDO1);
-            RedoLogRecord* redoLogRecord2 = reinterpret_cast<RedoLogRecord*>(begin() + ROW_HEADER_REDO2);
-            uint64_t lastSize = *(reinterpret_cast<uint64_t*>(begin() + ROW_HEADER_DATA + redoLogRecord1->size + redoLogRecord2->size));
-            return TransactionChunkRecord {
-                this,
-                begin(),
-                lastSize,
-            };
+            return TransactionChunkRecord(begin());
         }
 
         TransactionChunkRecord lastRecord() {
-            uint64_t lastSize = *(reinterpret_cast<uint64_t*>(end() - ROW_HEADER_TOTAL + ROW_HEADER_SIZE));
-            return TransactionChunkRecord {
-                this,
-                end() - lastSize + ROW_HEADER_OP,
-                lastSize,
-            };
-        }
-
-        void appendTransaction(RedoLogRecord* redoLogRecord) {
-            uint64_t chunkSize = redoLogRecord->size + ROW_HEADER_TOTAL;
-
-            *(reinterpret_cast<typeOp2*>(end() + ROW_HEADER_OP)) = (redoLogRecord->opCode << 16);
-            memcpy(reinterpret_cast<void*>(end() + ROW_HEADER_REDO1),
-                reinterpret_cast<const void*>(redoLogRecord), sizeof(RedoLogRecord));
-            memset(reinterpret_cast<void*>(end() + ROW_HEADER_REDO2), 0, sizeof(RedoLogRecord));
-            memcpy(reinterpret_cast<void*>(end() + ROW_HEADER_DATA),
+            uint32_t lastSize;
+            memcpy(reinterpret_cast<void*>(&lastSize), reinterpret_cast<const void*>(end() - ROW_FOOTER_SIZE), sizeof(uint32_t));
+            return TransactionChunkRecord(end() - lastSize);
+        }
+
+        static uint64_t encodedSize(const RedoLogRecord* redoLogRecord) {
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(redoLogRecord);
+            uint64_t encodedSize = sizeof(uint64_t);
+            for (uint64_t i = RECORD_WORDS_SKIP; i < RECORD_WORDS; ++i) {
+                uint32_t word;
+                memcpy(reinterpret_cast<void*>(&word), reinterpret_cast<const void*>(data + i * sizeof(uint32_t)), sizeof(uint32_t));
+                if (word != 0)
+                    encodedSize += sizeof(uint32_t);
+            }
+            return encodedSize;
+        }
+
+        static uint64_t encode(uint8_t* out, const RedoLogRecord* redoLogRecord) {
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(redoLogRecord);
+            uint64_t bitmap = 0;
+            uint64_t encodedSize = sizeof(uint64_t);
+            for (uint64_t i = RECORD_WORDS_SKIP; i < RECORD_WORDS; ++i) {
+                uint32_t word;
+                memcpy(reinterpret_cast<void*>(&word), reinterpret_cast<const void*>(data + i * sizeof(uint32_t)), sizeof(uint32_t));
+                if (word != 0) {
+                    bitmap |= static_cast<uint64_t>(1) << i;
+                    memcpy(reinterpret_cast<void*>(out + encodedSize), reinterpret_cast<const void*>(&word), sizeof(uint32_t));
+                    encodedSize += sizeof(uint32_t);
+                }
+            }
+            memcpy(reinterpret_cast<void*>(out), reinterpret_cast<const void*>(&bitmap), sizeof(uint64_t));
+            return encodedSize;
+        }
+
+        static uint64_t decode(RedoLogRecord* redoLogRecord, const uint8_t* in) {
+            uint8_t* data = reinterpret_cast<uint8_t*>(redoLogRecord);
+            uint64_t bitmap;
+            memcpy(reinterpret_cast<void*>(&bitmap), reinterpret_cast<const void*>(in), sizeof(uint64_t));
+            memset(reinterpret_cast<void*>(data), 0, sizeof(RedoLogRecord));
+            uint64_t encodedSize = sizeof(uint64_t);
+            while (bitmap != 0) {
+                uint64_t i = __builtin_ctzll(bitmap);
+                memcpy(reinterpret_cast<void*>(data + i * sizeof(uint32_t)), reinterpret_cast<const void*>(in + encodedSize), sizeof(uint32_t));
+                encodedSize += sizeof(uint32_t);
+                bitmap &= bitmap - 1;
+            }
+            return encodedSize;
+        }
+
+        static uint64_t recordSize(const RedoLogRecord* redoLogRecord) {
+            return ROW_HEADER_REDO1 + encodedSize(redoLogRecord) + sizeof(uint64_t) + redoLogRecord->size + ROW_FOOTER_SIZE;
+        }
+
+        static uint64_t recordSize(const RedoLogRecord* redoLogRecord1, const RedoLogRecord* redoLogRecord2) {
+            return ROW_HEADER_REDO1 + encodedSize(redoLogRecord1) + encodedSize(redoLogRecord2) + redoLogRecord1->size + redoLogRecord2->size +
+                   ROW_FOOTER_SIZE;
+        }
+
+        void appendTransaction(const RedoLogRecord* redoLogRecord) {
+            uint8_t* record = end();
+            typeOp2 op = (redoLogRecord->opCode << 16);
+            uint64_t recordPos = ROW_HEADER_REDO1;
+            recordPos += encode(record + recordPos, redoLogRecord);
+            memset(reinterpret_cast<void*>(record + recordPos), 0, sizeof(uint64_t));
+            recordPos += sizeof(uint64_t);
+            memcpy(reinterpret_cast<void*>(record + recordPos),
                 reinterpret_cast<const void*>(redoLogRecord->data()), redoLogRecord->size);
+            recordPos += redoLogRecord->size;
 
-            *(reinterpret_cast<uint64_t*>(end() + ROW_HEADER_SIZE + redoLogRecord->size)) = chunkSize;
+            uint32_t chunkSize = recordPos + ROW_FOOTER_SIZE;
+            memcpy(reinterpret_cast<void*>(record + ROW_HEADER_SIZE), reinterpret_cast<const void*>(&chunkSize), sizeof(uint32_t));
+            memcpy(reinterpret_cast<void*>(record + ROW_HEADER_OP), reinterpret_cast<const void*>(&op), sizeof(typeOp2));
+            memcpy(reinterpret_cast<void*>(record + recordPos), reinterpret_cast<const void*>(&chunkSize), sizeof(uint32_t));
 
             size += chunkSize;
             ++elements;
         }
 
-        void appendTransaction(RedoLogRecord* redoLogRecord1, const RedoLogRecord* redoLogRecord2) {
-            uint64_t chunkSize = redoLogRecord1->size + redoLogRecord2->size + ROW_HEADER_TOTAL;
-
-            *(reinterpret_cast<typeOp2*>(end() + ROW_HEADER_OP)) = (redoLogRecord1->opCode << 16) | redoLogRecord2->opCode;
-            memcpy(reinterpret_cast<void*>(end() + ROW_HEADER_REDO1),
-                reinterpret_cast<const void*>(redoLogRecord1), sizeof(RedoLogRecord));
-            memcpy(reinterpret_cast<void*>(end() + ROW_HEADER_REDO2),
-                reinterpret_cast<const void*>(redoLogRecord2), sizeof(RedoLogRecord));
-            memcpy(reinterpret_cast<void*>(end() + ROW_HEADER_DATA),
+        void appendTransaction(const RedoLogRecord* redoLogRecord1, const RedoLogRecord* redoLogRecord2) {
+            uint8_t* record = end();
+            typeOp2 op = (redoLogRecord1->opCode << 16) | redoLogRecord2->opCode;
+            uint64_t recordPos = ROW_HEADER_REDO1;
+            recordPos += encode(record + recordPos, redoLogRecord1);
+            recordPos += encode(record + recordPos, redoLogRecord2);
+            memcpy(reinterpret_cast<void*>(record + recordPos),
                 reinterpret_cast<const void*>(redoLogRecord1->data()), redoLogRecord1->size);
-            memcpy(reinterpret_cast<void*>(end() + ROW_HEADER_DATA + redoLogRecord1->size),
+            recordPos += redoLogRecord1->size;
+            memcpy(reinterpret_cast<void*>(record + recordPos),
                 reinterpret_cast<const void*>(redoLogRecord2->data()), redoLogRecord2->size);
+            recordPos += redoLogRecord2->size;
 
-            *(reinterpret_cast<uint64_t*>(end() + ROW_HEADER_SIZE + redoLogRecord1->size + redoLogRecord2->size)) = chunkSize;
+            uint32_t chunkSize = recordPos + ROW_FOOTER_SIZE;
+            memcpy(reinterpret_cast<void*>(record + ROW_HEADER_SIZE), reinterpret_cast<const void*>(&chunkSize), sizeof(uint32_t));
+            memcpy(reinterpret_cast<void*>(record + ROW_HEADER_OP), reinterpret_cast<const void*>(&op), sizeof(typeOp2));
+            memcpy(reinterpret_cast<void*>(record + recordPos), reinterpret_cast<const void*>(&chunkSize), sizeof(uint32_t));
 
             size += chunkSize;
             ++elements;
         }
     };
 
+    // Open addressing hash table with linear probing, the slots are kept in one array and are reused after the transaction is dropped
+    class XidTransactionMap final {
+    public:
+        typedef std::pair<typeXidMap, Transaction*> Slot;
+
+        class Iterator {
+        public:
+            Iterator(const Slot* newSlot, const Slot* newEnd) :
+                    slot(newSlot),
+                    end(newEnd) {
+                skipEmpty();
+            }
+
+            const Slot& operator*() const {
+                return *slot;
+            }
+
+            Iterator& operator++() {
+                ++slot;
+                skipEmpty();
+                return *this;
+            }
+
+            bool operator!=(const Iterator& other) const {
+                return slot != other.slot;
+            }
+
+        private:
+            const Slot* slot;
+            const Slot* end;
+
+            void skipEmpty() {
+                while (slot != end && slot->second == nullptr)
+                    ++slot;
+            }
+        };
+
+        static constexpr uint64_t CAPACITY_MIN = 1024;
+
+        XidTransactionMap();
+        ~XidTransactionMap();
+
+        [[nodiscard]] Transaction* find(typeXidMap xidMap) const {
+            for (uint64_t i = hash(xidMap);; i = (i + 1) & mask) {
+                if (slots[i].second == nullptr)
+                    return nullptr;
+                if (slots[i].first == xidMap)
+                    return slots[i].second;
+            }
+        }
+
+        void insert(typeXidMap xidMap, Transaction* transaction);
+        bool erase(typeXidMap xidMap);
+        void clear();
+
+        [[nodiscard]] uint64_t size() const {
+            return count;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return count == 0;
+        }
+
+        [[nodiscard]] Iterator begin() const {
+            return {slots, slots + mask + 1};
+        }
+
+        [[nodiscard]] Iterator end() const {
+            return {slots + mask + 1, slots + mask + 1};
+        }
+
+    private:
+        Slot* slots;
+        uint64_t mask;
+        uint64_t count;
+
+        [[nodiscard]] uint64_t hash(typeXidMap xidMap) const {
+            return ((xidMap * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+        }
+
+        void grow();
+    };
+
     class TransactionBuffer {
     public:
         static constexpr uint64_t BUFFERS_FREE_MASK = 0xFFFF;
+        static constexpr uint64_t SPILL_RESERVE_MB = 16;
+        static constexpr uint64_t SPILL_BATCH_CHUNKS = 16;
+        // | frame size (4) | elements (4) | size (4) | compressed data | frame size (4) |
+        static constexpr uint64_t COMPRESS_FRAME_HEADER = sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint32_t);
+        static constexpr uint64_t COMPRESS_FRAME_OVERHEAD = COMPRESS_FRAME_HEADER + sizeof(uint32_t);
+        // Chunks which don't compress to 3/4 of the size are kept in memory
+        static constexpr uint64_t COMPRESS_RATIO_MAX_PERCENT = 75;
+        // Number of released transactions kept for reuse
+        static constexpr uint64_t TRANSACTION_POOL_MAX = 1024;
+        // Format of stored open transactions, changed together with the layout of records in TransactionChunk
+        static constexpr uint64_t SNAPSHOT_VERSION = 3;
 
     protected:
         Ctx* ctx;
         uint8_t buffer[TransactionChunk::DATA_BUFFER_SIZE];
+        // Chunks and the pool are shared with the flush thread, which releases the transactions
+        std::mutex mtxMemory;
         std::unordered_map<uint8_t*, uint64_t> partiallyFullChunks;
+        std::atomic<uint64_t> spillSize;
+        TransactionChunk* coldTc;
+        uint8_t* compressBuffer;
+        time_t lwnTime;
+        time_t lastCompressTime;
+
+        [[nodiscard]] std::string spillFileName(const Transaction* transaction) const;
+
+        /// @brief Move the oldest chunks of the biggest open transaction to its spill file to release memory.
+        void spillTransactions();
+        void spillTransactionChunk(Transaction* transaction);
+
+        /// @brief Compress chunks of the transaction except the last one.
+        void compressTransaction(Transaction* transaction);
+        [[nodiscard]] bool compressTransactionChunk(Transaction* transaction, const TransactionChunk* tc);
+
+        /// @brief Decompress the oldest compressed chunk of the transaction and drop it from the compressed chunks.
+        void popCompressedChunk(Transaction* transaction, TransactionChunk* tc);
+
+        void unregisterLobIds(typeXid xid, std::vector<typeLobId>& lobIdList);
+        void addPosition(const Transaction* transaction);
 
         std::mutex mtx;
-        std::unordered_map<typeXidMap, Transaction*> xidTransactionMap;
+        XidTransactionMap xidTransactionMap;
+        std::vector<Transaction*> transactionPool;
+        // Open transactions ordered by the redo thread and the position of the first record, the oldest one of a thread is first
+        typedef std::set<std::tuple<uint16_t, typeSeq, uint64_t, const Transaction*>> PositionIndex;
+        PositionIndex positionIndex;
+        // Nodes of dropped transactions, reused to not allocate per transaction
+        std::vector<PositionIndex::node_type> positionNodes;
+        std::mutex mtxOrphanedLobs;
         std::map<LobKey, Lob> orphanedLobs;
 
     public:
         std::set<typeXid> skipXidList;
         std::set<typeXid> dumpXidList;
         std::set<typeXidMap> brokenXidMapList;
+        // LOB ids of transactions on the skip list, the transactions are already dropped
+        std::map<typeXid, std::vector<typeLobId>> skipLobIdMap;
         std::string dumpPath;
 
         explicit TransactionBuffer(Ctx* newCtx);
@@ -162,6 +353,16 @@ namespace OpenLogReplicator {
 
         void purge();
 
+        /// @brief Take transaction from the pool of released transactions or allocate new one.
+        /// @param xmlCtx pointer to xml context
+        /// @param xid xid
+        /// @return transaction, not added to the buffer.
+        [[nodiscard]] Transaction* newTransaction(XmlCtx* xmlCtx, typeXid xid);
+
+        /// @brief Return purged transaction to the pool, the containers keep allocated memory for the next transaction.
+        /// @param transaction transaction
+        void releaseTransaction(Transaction* transaction);
+
         /// @brief Find transaction or create it if `add` is true. 
         /// @param xmlCtx pointer to xml context
         /// @param xid xid
@@ -176,6 +377,23 @@ namespace OpenLogReplicator {
         /// @param xid xid
         /// @param conId container id
         void dropTransaction(typeXid xid, typeConId conId);
+
+        /// @brief Drop transaction and put it on the skip list, the rest of its redo records are ignored.
+        /// @param transaction transaction
+        /// @param conId container id
+        void skipTransaction(Transaction* transaction, typeConId conId);
+
+        /// @brief Remove LOB ids registered by the transaction from Ctx::lobIdToXidMap, called at commit or rollback.
+        /// @param xid xid
+        /// @param conId container id
+        void dropLobIds(typeXid xid, typeConId conId);
+
+        /// @brief Set the position of the first record of the transaction, used to find the oldest open transaction.
+        /// @param transaction transaction
+        /// @param thread redo thread
+        /// @param sequence sequence of the redo log
+        /// @param offset offset in the redo log
+        void setTransactionPosition(Transaction* transaction, uint16_t thread, typeSeq sequence, uint64_t offset);
         void addTransactionChunk(Transaction* transaction, RedoLogRecord* redoLogRecord);
         void addTransactionChunk(Transaction* transaction, RedoLogRecord* redoLogRecord1, const RedoLogRecord* redoLogRecord2);
         void rollbackTransactionChunk(Transaction* transaction);
@@ -187,6 +405,10 @@ namespace OpenLogReplicator {
         /// pos     - position in memory chunk (0-31)
         /// @return pointer to transaction chunk.
         [[nodiscard]] TransactionChunk* newTransactionChunk();
+
+        /// @brief Allocate new transaction chunk without moving other transactions to the spill files, safe for the flush thread.
+        /// @return pointer to transaction chunk.
+        [[nodiscard]] TransactionChunk* allocateTransactionChunk();
         
         /// @brief Delete transaction chunk. Mark the space as unusable, or after deleting 16 transaction chunks in one memory block, delete the memory block.
         /// @param tc pointer to transaction
@@ -196,12 +418,69 @@ namespace OpenLogReplicator {
         /// @param tc pointer to transaction
         void deleteTransactionChunks(TransactionChunk* tc);
         void mergeBlocks(uint8_t* mergeBuffer, RedoLogRecord* redoLogRecord1, const RedoLogRecord* redoLogRecord2);
+
+        /// @brief Read chunk stored in the spill file of the transaction.
+        /// @param transaction transaction
+        /// @param index position of the chunk in the spill file
+        /// @param tc memory to read the chunk to, the header fields are overwritten
+        void readSpilledChunk(const Transaction* transaction, uint64_t index, TransactionChunk* tc) const;
+
+        /// @brief Allocate new transaction chunk and read the chunk from the spill file to it.
+        /// @param transaction transaction
+        /// @param index position of the chunk in the spill file
+        /// @return pointer to transaction chunk, not linked with other chunks.
+        [[nodiscard]] TransactionChunk* unspillTransactionChunk(const Transaction* transaction, uint64_t index);
+
+        /// @brief Close the spill file of the transaction, the chunks stored there are dropped.
+        /// @param transaction transaction
+        void dropSpill(Transaction* transaction);
+
+        /// @brief Decompress one chunk.
+        /// @param frame compressed chunk
+        /// @param tc memory to decompress the chunk to, the header fields except elements and size are not changed
+        /// @return size of the compressed frame.
+        uint64_t decompressChunk(const uint8_t* frame, TransactionChunk* tc) const;
+
+        /// @brief Compress chunks of transactions which were not changed for the configured time.
+        /// @param time time of the current LWN
+        void compressTransactions(time_t time);
+
+        /// @brief Take the oldest chunk of the transaction which is not in memory, for flush.
+        /// @param transaction transaction
+        /// @param spillPos position of the next chunk in the spill file, updated
+        /// @return pointer to transaction chunk, not linked with other chunks, or nullptr if all remaining chunks are in memory.
+        [[nodiscard]] TransactionChunk* takeColdTransactionChunk(Transaction* transaction, uint64_t& spillPos);
         
         /// @brief Return information about transactions.
         /// @param minSequence minimum of read sequence 
         /// @param minOffset minimum of read block
         /// @param minXid minimum of read xid
         void checkpoint(typeSeq& minSequence, uint64_t& minOffset, typeXid& minXid);
+
+        /// @brief Return the oldest open transaction started in the redo thread.
+        /// @param thread redo thread
+        /// @param minSequence minimum of read sequence
+        /// @param minOffset minimum of read block
+        /// @param minXid minimum of read xid
+        void checkpointThread(uint16_t thread, typeSeq& minSequence, uint64_t& minOffset, typeXid& minXid);
+
+        /// @brief Check if open transactions can be stored.
+        /// @param dataSize total size of the records data to store
+        /// @return false if some transaction holds LOB data which is not stored.
+        [[nodiscard]] bool isSnapshotPossible(uint64_t& dataSize);
+
+        /// @brief Store open transactions, so that processing can be resumed from the checkpoint position.
+        /// @param ss output stream with the index of the transactions
+        /// @param data output stream for the records data, written chunk by chunk
+        void snapshot(std::ostringstream& ss, std::ostream& data);
+
+        /// @brief Load open transactions stored by snapshot.
+        /// @param xmlCtx pointer to xml context
+        /// @param fileName name of the file for error messages
+        /// @param in content of the index file
+        /// @param data input stream with the records data
+        /// @return number of restored transactions.
+        uint64_t restore(XmlCtx* xmlCtx, const std::string& fileName, const std::string& in, std::istream& data);
         void addOrphanedLob(RedoLogRecord* redoLogRecord1);
 
         /// @brief Allocate data with lob and record data:
@@ -0,0 +1,333 @@
+/* Thread passing committed transactions to the builder in parallel to the parser
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <thread>
+
+#include "../builder/Builder.h"
+#include "../common/Clock.h"
+#include "../common/Ctx.h"
+#include "../common/exception/DataException.h"
+#include "../common/exception/RedoLogException.h"
+#include "../common/exception/RuntimeException.h"
+#include "../common/metrics/Metrics.h"
+#include "../metadata/Metadata.h"
+#include "FormatWorker.h"
+#include "Transaction.h"
+#include "TransactionBuffer.h"
+#include "TransactionFlusher.h"
+
+namespace OpenLogReplicator {
+    TransactionFlusher::TransactionFlusher(Ctx* newCtx, Builder* newBuilder, Metadata* newMetadata, TransactionBuffer* newTransactionBuffer,
+                                           const std::string& newAlias) :
+            Thread(newCtx, newAlias),
+            builder(newBuilder),
+            metadata(newMetadata),
+            transactionBuffer(newTransactionBuffer),
+            started(false),
+            busy(false),
+            shutdown(false),
+            workers(nullptr) {
+    }
+
+    TransactionFlusher::~TransactionFlusher() {
+        // The workers are already stopped
+        for (const FlushSlot& slot: slots)
+            discard(slot.task);
+        slots.clear();
+
+        for (const FlushTask& task: tasks)
+            discard(task);
+        tasks.clear();
+    }
+
+    void TransactionFlusher::start() {
+        std::unique_lock<std::mutex> lck(mtx);
+        started = true;
+        shutdown = false;
+        idleWorkers.clear();
+        if (workers != nullptr)
+            idleWorkers = *workers;
+    }
+
+    bool TransactionFlusher::isStarted() const {
+        return started;
+    }
+
+    void TransactionFlusher::push(const FlushTask& task) {
+        if (!started) {
+            process(task);
+            return;
+        }
+
+        if (task.type == FlushTask::TYPE_TRANSACTION && task.transaction->system) {
+            drain();
+            process(task);
+            return;
+        }
+
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            while (tasks.size() >= ctx->flushQueue && !shutdown && !ctx->hardShutdown) {
+                if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
+                    ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "TransactionFlusher:push:full");
+                condParser.wait(lck);
+            }
+
+            if (!shutdown && !ctx->hardShutdown) {
+                tasks.push_back(task);
+                if (ctx->metrics != nullptr)
+                    ctx->metrics->emitFlushQueueDepth(tasks.size());
+                condFlusher.notify_all();
+                return;
+            }
+        }
+
+        // The thread has stopped, the task is not processed
+        discard(task);
+    }
+
+    void TransactionFlusher::drain() {
+        if (!started)
+            return;
+
+        std::unique_lock<std::mutex> lck(mtx);
+        while ((!tasks.empty() || busy) && !shutdown && !ctx->hardShutdown) {
+            if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
+                ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "TransactionFlusher:drain");
+            condParser.wait(lck);
+        }
+    }
+
+    void TransactionFlusher::stop() {
+        std::unique_lock<std::mutex> lck(mtx);
+        shutdown = true;
+        started = false;
+        condFlusher.notify_all();
+        condParser.notify_all();
+    }
+
+    void TransactionFlusher::wakeUp() {
+        std::unique_lock<std::mutex> lck(mtx);
+        condFlusher.notify_all();
+        condParser.notify_all();
+    }
+
+    void TransactionFlusher::process(const FlushTask& task) {
+        if (task.type != FlushTask::TYPE_TRANSACTION) {
+            flushCheckpoint(task);
+            return;
+        }
+
+        processTransaction(task, nullptr);
+    }
+
+    bool TransactionFlusher::isParallel(const FlushTask& task) const {
+        if (workers == nullptr || workers->empty() || task.type != FlushTask::TYPE_TRANSACTION)
+            return false;
+
+        // Only transactions which would be formatted by flushTransaction(), system transactions are not queued
+        const Transaction* transaction = task.transaction;
+        return !transaction->system && transaction->begin && transaction->commitScn > metadata->firstDataScn &&
+               transaction->size <= FORMAT_TRANSACTION_SIZE_MAX;
+    }
+
+    void TransactionFlusher::processTransaction(const FlushTask& task, FormatWorker* worker) {
+        time_ut start = ctx->clock->getTimeUt();
+        flushTransaction(task.transaction, task.lwnScn, worker);
+        if (ctx->metrics != nullptr)
+            ctx->metrics->emitFlushTimeUs(ctx->clock->getTimeUt() - start);
+
+        task.transaction->purge(transactionBuffer);
+        transactionBuffer->releaseTransaction(task.transaction);
+    }
+
+    void TransactionFlusher::flushTransaction(Transaction* transaction, typeScn lwnScn, FormatWorker* worker) {
+        if ((transaction->commitScn > metadata->firstDataScn && !transaction->system) ||
+            (transaction->commitScn > metadata->firstSchemaScn && transaction->system)) {
+
+            if (transaction->begin) {
+                if (worker != nullptr)
+                    builder->appendMessages(worker->builder);
+                else
+                    transaction->flush(metadata, transactionBuffer, builder, lwnScn);
+                if (ctx->metrics != nullptr) {
+                    if (transaction->rollback)
+                        ctx->metrics->emitTransactionsRollbackOut(1);
+                    else
+                        ctx->metrics->emitTransactionsCommitOut(1);
+                }
+
+                if (ctx->stopTransactions > 0 && metadata->isNewData(lwnScn, builder->lwnIdx)) {
+                    --ctx->stopTransactions;
+                    if (ctx->stopTransactions == 0) {
+                        ctx->OLR_INFO(0, "shutdown started - exhausted number of transactions");
+                        ctx->stopSoft();
+                    }
+                }
+
+                if (transaction->shutdown && metadata->isNewData(lwnScn, builder->lwnIdx)) {
+                    ctx->OLR_INFO(0, "shutdown started - initiated by debug transaction " + transaction->xid.toString() +
+                                 " at scn " + std::to_string(transaction->commitScn));
+                    ctx->stopSoft();
+                }
+            } else {
+                if (ctx->metrics != nullptr) {
+                    if (transaction->rollback)
+                        ctx->metrics->emitTransactionsRollbackPartial(1);
+                    else
+                        ctx->metrics->emitTransactionsCommitPartial(1);
+                }
+                ctx->OLR_WARN(60011, "skipping transaction with no beginning: " + transaction->toString());
+            }
+        } else {
+            if (ctx->metrics != nullptr) {
+                if (transaction->rollback)
+                    ctx->metrics->emitTransactionsRollbackSkip(1);
+                else
+                    ctx->metrics->emitTransactionsCommitSkip(1);
+            }
+            if (unlikely(ctx->trace & Ctx::TRACE_TRANSACTION))
+                ctx->OLR_TRACE(Ctx::TRACE_TRANSACTION, "skipping transaction already committed: " + transaction->toString());
+        }
+    }
+
+    void TransactionFlusher::flushCheckpoint(const FlushTask& task) {
+        builder->processCheckpoint(task.lwnScn, task.sequence, task.lwnTimestamp.toEpoch(ctx->hostTimezone), task.offset, task.switchRedo);
+        if (task.type != FlushTask::TYPE_CHECKPOINT_LWN)
+            return;
+
+        // The position is updated after the transactions committed before are passed to the builder
+        metadata->checkpoint(task.lwnScn, task.lwnTimestamp, task.sequence, task.offset, task.bytes, task.minSequence, task.minOffset,
+                             task.minXid, task.thread, task.transactions);
+
+        if (ctx->stopCheckpoints > 0 && metadata->isNewData(task.lwnScn, builder->lwnIdx)) {
+            --ctx->stopCheckpoints;
+            if (ctx->stopCheckpoints == 0) {
+                ctx->OLR_INFO(0, "shutdown started - exhausted number of checkpoints");
+                ctx->stopSoft();
+            }
+        }
+    }
+
+    void TransactionFlusher::discard(const FlushTask& task) {
+        if (task.type != FlushTask::TYPE_TRANSACTION)
+            return;
+
+        task.transaction->purge(transactionBuffer);
+        transactionBuffer->releaseTransaction(task.transaction);
+    }
+
+    void TransactionFlusher::mainLoop() {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lck(mtx);
+                while (tasks.empty() && slots.empty() && !shutdown && !ctx->hardShutdown) {
+                    if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
+                        ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "TransactionFlusher:mainLoop:idle");
+                    condFlusher.wait(lck);
+                }
+
+                // Queued tasks are processed before the thread stops, unless it is a hard shutdown
+                if ((tasks.empty() && slots.empty()) || ctx->hardShutdown)
+                    break;
+
+                // Look ahead of the oldest task as long as there are free workers to format the transactions
+                uint64_t window = (workers != nullptr ? workers->size() : 0) + 1;
+                while (!tasks.empty() && slots.size() < window) {
+                    FormatWorker* worker = nullptr;
+                    if (isParallel(tasks.front())) {
+                        if (idleWorkers.empty())
+                            break;
+                        worker = idleWorkers.back();
+                        worker->builder->setMaxMessageMb(builder->getMaxMessageMb());
+                        if (!worker->assign(tasks.front().transaction, tasks.front().lwnScn))
+                            break;
+                        idleWorkers.pop_back();
+                    }
+
+                    slots.push_back(FlushSlot{tasks.front(), worker});
+                    tasks.pop_front();
+                }
+
+                busy = true;
+                if (ctx->metrics != nullptr)
+                    ctx->metrics->emitFlushQueueDepth(tasks.size());
+                condParser.notify_all();
+            }
+
+            // The output is in the order of the queue, the next transactions are formatted by the workers in the meantime
+            if (!slots.empty()) {
+                const FlushSlot& slot = slots.front();
+                if (slot.worker != nullptr) {
+                    // The transaction may be still used by the worker, it is released when the thread is destroyed
+                    if (!slot.worker->wait())
+                        break;
+                    processTransaction(slot.task, slot.worker);
+                    idleWorkers.push_back(slot.worker);
+                } else
+                    process(slot.task);
+                slots.pop_front();
+            }
+
+            {
+                std::unique_lock<std::mutex> lck(mtx);
+                if (slots.empty())
+                    busy = false;
+                condParser.notify_all();
+            }
+        }
+    }
+
+    void TransactionFlusher::run() {
+        if (unlikely(ctx->trace & Ctx::TRACE_THREADS)) {
+            std::ostringstream ss;
+            ss << std::this_thread::get_id();
+            ctx->OLR_TRACE(Ctx::TRACE_THREADS, "transaction flusher (" + ss.str() + ") start");
+        }
+
+        try {
+            mainLoop();
+        } catch (DataException& ex) {
+            ctx->OLR_ERROR(ex.code, ex.msg);
+            ctx->stopHard();
+        } catch (RedoLogException& ex) {
+            ctx->OLR_ERROR(ex.code, ex.msg);
+            ctx->stopHard();
+        } catch (RuntimeException& ex) {
+            ctx->OLR_ERROR(ex.code, ex.msg);
+            ctx->stopHard();
+        } catch (std::bad_alloc& ex) {
+            ctx->OLR_ERROR(10018, "memory allocation failed: " + std::string(ex.what()));
+            ctx->stopHard();
+        }
+
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            shutdown = true;
+            busy = false;
+            condParser.notify_all();
+        }
+
+        if (unlikely(ctx->trace & Ctx::TRACE_THREADS)) {
+            std::ostringstream ss;
+            ss << std::this_thread::get_id();
+            ctx->OLR_TRACE(Ctx::TRACE_THREADS, "transaction flusher (" + ss.str() + ") stop");
+        }
+    }
+}
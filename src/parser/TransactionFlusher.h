@@ -0,0 +1,130 @@
+/* Header for TransactionFlusher class
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "../common/Ctx.h"
+#include "../common/Thread.h"
+#include "../common/types.h"
+#include "../common/typeTime.h"
+#include "../common/typeXid.h"
+
+#ifndef TRANSACTION_FLUSHER_H_
+#define TRANSACTION_FLUSHER_H_
+
+namespace OpenLogReplicator {
+    class Builder;
+    class FormatWorker;
+    class Metadata;
+    class Transaction;
+    class TransactionBuffer;
+
+    /*
+        Flush Task - committed transaction or checkpoint, passed to the builder in the order of the redo log.
+    */
+    struct FlushTask {
+        static constexpr uint64_t TYPE_TRANSACTION = 0;
+        static constexpr uint64_t TYPE_CHECKPOINT = 1;
+        // Checkpoint message followed by the update of the checkpoint position
+        static constexpr uint64_t TYPE_CHECKPOINT_LWN = 2;
+
+        uint64_t type;
+        Transaction* transaction;
+        typeScn lwnScn;
+        typeSeq sequence;
+        typeTime lwnTimestamp;
+        uint64_t offset;
+        uint64_t bytes;
+        bool switchRedo;
+        typeSeq minSequence;
+        uint64_t minOffset;
+        typeXid minXid;
+        uint16_t thread;
+        bool transactions;
+    };
+
+    class TransactionFlusher final : public Thread {
+    public:
+        // Bigger transactions are formatted directly to the output queue, the output of the workers is kept in memory until it is in order
+        static constexpr uint64_t FORMAT_TRANSACTION_SIZE_MAX = Ctx::MEMORY_CHUNK_SIZE;
+
+    protected:
+        struct FlushSlot {
+            FlushTask task;
+            FormatWorker* worker;
+        };
+
+        Builder* builder;
+        Metadata* metadata;
+        TransactionBuffer* transactionBuffer;
+        std::mutex mtx;
+        std::condition_variable condFlusher;
+        std::condition_variable condParser;
+        std::deque<FlushTask> tasks;
+        // Tasks taken from the queue in the order of the output, used only by the flush thread
+        std::deque<FlushSlot> slots;
+        std::vector<FormatWorker*> idleWorkers;
+        bool started;
+        bool busy;
+        bool shutdown;
+
+        void mainLoop();
+        [[nodiscard]] bool isParallel(const FlushTask& task) const;
+        void processTransaction(const FlushTask& task, FormatWorker* worker);
+        void flushTransaction(Transaction* transaction, typeScn lwnScn, FormatWorker* worker);
+        void flushCheckpoint(const FlushTask& task);
+        void discard(const FlushTask& task);
+
+    public:
+        // Threads formatting transactions in parallel, set before the flush thread is started
+        std::vector<FormatWorker*>* workers;
+
+        TransactionFlusher(Ctx* newCtx, Builder* newBuilder, Metadata* newMetadata, TransactionBuffer* newTransactionBuffer,
+                           const std::string& newAlias);
+        ~TransactionFlusher() override;
+
+        /// @brief Mark the thread as started, the tasks are queued from now on instead of being processed by the caller.
+        ///
+        /// Transactions are formatted by the workers, if set, and passed to the output in the order of the queue.
+        void start();
+
+        /// @brief Pass the task to the flush thread, wait if the queue is full.
+        ///
+        /// The task is processed by the caller if the thread is not started. System transactions change the schema
+        /// used by the parser, so they are processed by the caller after the queue is empty.
+        /// @param task task, the transaction is already removed from the transaction buffer
+        void push(const FlushTask& task);
+
+        /// @brief Process the task: flush the transaction and release it, or write the checkpoint.
+        /// @param task task
+        void process(const FlushTask& task);
+
+        /// @brief Wait until all queued tasks are processed.
+        void drain();
+        void stop();
+        [[nodiscard]] bool isStarted() const;
+        void wakeUp() override;
+        void run() override;
+    };
+}
+
+#endif
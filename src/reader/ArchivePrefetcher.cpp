@@ -0,0 +1,297 @@
+/* Thread reading ahead archived redo log files queued for parsing
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#define _LARGEFILE_SOURCE
+#define _FILE_OFFSET_BITS 64
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#include "../common/Ctx.h"
+#include "../common/exception/RuntimeException.h"
+#include "ArchivePrefetcher.h"
+
+namespace OpenLogReplicator {
+    ArchivePrefetcher::ArchivePrefetcher(Ctx* newCtx, const std::string& newAlias, uint64_t newLogs) :
+            Thread(newCtx, newAlias),
+            loading(nullptr),
+            fileDescriptor(-1),
+            logs(newLogs),
+            shutdown(false) {
+    }
+
+    ArchivePrefetcher::~ArchivePrefetcher() {
+        fileClose();
+
+        for (PrefetchFile* file: files) {
+            fileRelease(file);
+            delete file;
+        }
+        files.clear();
+    }
+
+    void ArchivePrefetcher::chunkRelease(PrefetchFile* file, uint64_t num) {
+        if (file->chunks[num] == nullptr)
+            return;
+
+        ctx->freeMemoryChunk(Ctx::MEMORY_MODULE_READER, file->chunks[num], false);
+        file->chunks[num] = nullptr;
+        ctx->releaseBuffer();
+        condLoop.notify_all();
+    }
+
+    void ArchivePrefetcher::fileRelease(PrefetchFile* file) {
+        for (uint64_t num = 0; num < file->chunks.size(); ++num)
+            chunkRelease(file, num);
+    }
+
+    PrefetchFile* ArchivePrefetcher::fileFind(const std::string& path) const {
+        for (PrefetchFile* file: files)
+            if (file->path == path)
+                return file;
+        return nullptr;
+    }
+
+    void ArchivePrefetcher::fileOpen(PrefetchFile* file) {
+        struct stat fileStat;
+        filePath = file->path;
+
+        if (stat(filePath.c_str(), &fileStat) != 0) {
+            if (unlikely(ctx->trace & Ctx::TRACE_FILE))
+                ctx->OLR_TRACE(Ctx::TRACE_FILE, "prefetch " + filePath + " - get metadata returned: " + strerror(errno));
+            return;
+        }
+
+        // Same size and flags as used by the reader, so the data can be handed over as is
+        int flags = O_RDONLY;
+#if __linux__
+        if (!ctx->isFlagSet(Ctx::REDO_FLAGS_DIRECT_DISABLE))
+            flags |= O_DIRECT;
+#endif
+
+        fileDescriptor = open(filePath.c_str(), flags);
+        if (fileDescriptor == -1) {
+            if (unlikely(ctx->trace & Ctx::TRACE_FILE))
+                ctx->OLR_TRACE(Ctx::TRACE_FILE, "prefetch " + filePath + " - open for read returned: " + strerror(errno));
+            return;
+        }
+
+#if __APPLE__
+        if (!ctx->isFlagSet(Ctx::REDO_FLAGS_DIRECT_DISABLE))
+            fcntl(fileDescriptor, F_GLOBAL_NOCACHE, 1);
+#endif
+
+        std::unique_lock<std::mutex> lck(mtx);
+        file->fileSize = fileStat.st_size & ~(Ctx::MEMORY_ALIGNMENT - 1);
+    }
+
+    void ArchivePrefetcher::fileClose() {
+        if (fileDescriptor != -1) {
+            close(fileDescriptor);
+            fileDescriptor = -1;
+        }
+        filePath.clear();
+    }
+
+    bool ArchivePrefetcher::bufferAvailable() const {
+        // Never take more than half of the read buffers, the rest is left for the reader of the current file
+        return ctx->buffersFree > ctx->readBufferMax / 2 + 1;
+    }
+
+    void ArchivePrefetcher::loadChunk(PrefetchFile* file) {
+        if (filePath != file->path) {
+            fileClose();
+            fileOpen(file);
+        }
+
+        if (fileDescriptor == -1 || file->bytesRead >= file->fileSize) {
+            std::unique_lock<std::mutex> lck(mtx);
+            file->complete = true;
+            return;
+        }
+
+        uint64_t offset = file->bytesRead;
+        uint64_t toRead = std::min(Ctx::MEMORY_CHUNK_SIZE, file->fileSize - offset);
+        uint8_t* chunk = ctx->getMemoryChunk(Ctx::MEMORY_MODULE_READER, false);
+        ctx->allocateBuffer();
+
+        int64_t bytes = pread(fileDescriptor, chunk, toRead, static_cast<int64_t>(offset));
+        if (unlikely(ctx->trace & Ctx::TRACE_DISK))
+            ctx->OLR_TRACE(Ctx::TRACE_DISK, "prefetch " + file->path + " at " + std::to_string(offset) + " bytes: " +
+                                           std::to_string(toRead) + " returns " + std::to_string(bytes));
+
+        std::unique_lock<std::mutex> lck(mtx);
+        if (file->dropped || bytes != static_cast<int64_t>(toRead)) {
+            // The reader would read the rest of the file by itself
+            ctx->freeMemoryChunk(Ctx::MEMORY_MODULE_READER, chunk, false);
+            ctx->releaseBuffer();
+            file->complete = true;
+            return;
+        }
+
+        file->chunks.push_back(chunk);
+        file->bytesRead += toRead;
+        if (file->bytesRead >= file->fileSize)
+            file->complete = true;
+    }
+
+    void ArchivePrefetcher::mainLoop() {
+        while (!ctx->softShutdown) {
+            PrefetchFile* file = nullptr;
+            {
+                std::unique_lock<std::mutex> lck(mtx);
+                if (shutdown)
+                    break;
+
+                // The file being parsed is read by the reader itself
+                for (uint64_t index = 1; index < files.size(); ++index) {
+                    if (!files[index]->complete) {
+                        file = files[index];
+                        break;
+                    }
+                }
+
+                if (file == nullptr || !bufferAvailable()) {
+                    if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
+                        ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "ArchivePrefetcher:mainLoop");
+                    condLoop.wait_for(lck, std::chrono::microseconds(ctx->redoReadSleepUs));
+                    continue;
+                }
+                loading = file;
+            }
+
+            loadChunk(file);
+
+            std::unique_lock<std::mutex> lck(mtx);
+            loading = nullptr;
+            if (file->dropped)
+                delete file;
+        }
+    }
+
+    void ArchivePrefetcher::schedule(const std::vector<std::string>& paths) {
+        std::unique_lock<std::mutex> lck(mtx);
+        std::vector<PrefetchFile*> newFiles;
+
+        for (uint64_t index = 0; index < paths.size() && index <= logs; ++index) {
+            PrefetchFile* file = fileFind(paths[index]);
+            if (file == nullptr)
+                file = new PrefetchFile{paths[index], 0, 0, {}, false, false};
+            newFiles.push_back(file);
+        }
+
+        for (PrefetchFile* file: files) {
+            if (std::find(newFiles.begin(), newFiles.end(), file) != newFiles.end())
+                continue;
+
+            fileRelease(file);
+            if (file == loading)
+                file->dropped = true;
+            else
+                delete file;
+        }
+
+        files.swap(newFiles);
+        condLoop.notify_all();
+    }
+
+    bool ArchivePrefetcher::copy(const std::string& path, uint64_t fileSize, uint8_t* buf, uint64_t size, uint64_t offset) {
+        if (size == 0)
+            return false;
+
+        std::unique_lock<std::mutex> lck(mtx);
+        PrefetchFile* file = fileFind(path);
+        if (file == nullptr || file->fileSize != fileSize || offset + size > file->bytesRead)
+            return false;
+
+        uint64_t num = offset / Ctx::MEMORY_CHUNK_SIZE;
+        if ((offset + size - 1) / Ctx::MEMORY_CHUNK_SIZE != num || file->chunks[num] == nullptr)
+            return false;
+
+        memcpy(reinterpret_cast<void*>(buf), reinterpret_cast<const void*>(file->chunks[num] + offset % Ctx::MEMORY_CHUNK_SIZE), size);
+
+        // The reader has reached the end of the chunk, it would not be read again
+        if (offset + size == (num + 1) * Ctx::MEMORY_CHUNK_SIZE || offset + size == file->fileSize)
+            chunkRelease(file, num);
+
+        if (unlikely(ctx->trace & Ctx::TRACE_FILE))
+            ctx->OLR_TRACE(Ctx::TRACE_FILE, "read " + path + ", " + std::to_string(offset) + ", " + std::to_string(size) +
+                                           " returns " + std::to_string(size) + " (prefetched)");
+        return true;
+    }
+
+    bool ArchivePrefetcher::contains(const std::string& path, uint64_t fileSize, uint64_t offset) {
+        std::unique_lock<std::mutex> lck(mtx);
+        PrefetchFile* file = fileFind(path);
+        if (file == nullptr || file->fileSize != fileSize || offset >= file->bytesRead)
+            return false;
+
+        return file->chunks[offset / Ctx::MEMORY_CHUNK_SIZE] != nullptr;
+    }
+
+    void ArchivePrefetcher::stop() {
+        std::unique_lock<std::mutex> lck(mtx);
+        shutdown = true;
+        condLoop.notify_all();
+    }
+
+    void ArchivePrefetcher::wakeUp() {
+        std::unique_lock<std::mutex> lck(mtx);
+        condLoop.notify_all();
+    }
+
+    void ArchivePrefetcher::run() {
+        if (unlikely(ctx->trace & Ctx::TRACE_THREADS)) {
+            std::ostringstream ss;
+            ss << std::this_thread::get_id();
+            ctx->OLR_TRACE(Ctx::TRACE_THREADS, "archive prefetcher (" + ss.str() + ") start");
+        }
+
+        try {
+            mainLoop();
+        } catch (RuntimeException& ex) {
+            ctx->OLR_ERROR(ex.code, ex.msg);
+            ctx->stopHard();
+        } catch (std::bad_alloc& ex) {
+            ctx->OLR_ERROR(10018, "memory allocation failed: " + std::string(ex.what()));
+            ctx->stopHard();
+        }
+
+        fileClose();
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            for (PrefetchFile* file: files) {
+                fileRelease(file);
+                delete file;
+            }
+            files.clear();
+        }
+
+        if (unlikely(ctx->trace & Ctx::TRACE_THREADS)) {
+            std::ostringstream ss;
+            ss << std::this_thread::get_id();
+            ctx->OLR_TRACE(Ctx::TRACE_THREADS, "archive prefetcher (" + ss.str() + ") stop");
+        }
+    }
+}
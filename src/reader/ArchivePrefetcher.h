@@ -0,0 +1,74 @@
+/* Header for ArchivePrefetcher class
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "../common/Thread.h"
+#include "../common/types.h"
+
+#ifndef ARCHIVE_PREFETCHER_H_
+#define ARCHIVE_PREFETCHER_H_
+
+namespace OpenLogReplicator {
+    struct PrefetchFile {
+        std::string path;
+        uint64_t fileSize;
+        uint64_t bytesRead;
+        std::vector<uint8_t*> chunks;
+        bool complete;
+        bool dropped;
+    };
+
+    class ArchivePrefetcher final : public Thread {
+    protected:
+        std::mutex mtx;
+        std::condition_variable condLoop;
+        // First element is the file being parsed, the rest are loaded in order
+        std::vector<PrefetchFile*> files;
+        PrefetchFile* loading;
+        std::string filePath;
+        int fileDescriptor;
+        uint64_t logs;
+        bool shutdown;
+
+        void chunkRelease(PrefetchFile* file, uint64_t num);
+        void fileRelease(PrefetchFile* file);
+        PrefetchFile* fileFind(const std::string& path) const;
+        void fileOpen(PrefetchFile* file);
+        void fileClose();
+        [[nodiscard]] bool bufferAvailable() const;
+        void loadChunk(PrefetchFile* file);
+        void mainLoop();
+
+    public:
+        ArchivePrefetcher(Ctx* newCtx, const std::string& newAlias, uint64_t newLogs);
+        ~ArchivePrefetcher() override;
+
+        void schedule(const std::vector<std::string>& paths);
+        bool copy(const std::string& path, uint64_t fileSize, uint8_t* buf, uint64_t size, uint64_t offset);
+        [[nodiscard]] bool contains(const std::string& path, uint64_t fileSize, uint64_t offset);
+        void stop();
+        void wakeUp() override;
+        void run() override;
+    };
+}
+
+#endif
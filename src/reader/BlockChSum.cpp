@@ -0,0 +1,182 @@
+/* Validation of redo log block checksums
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+
+#include <vector>
+
+#include "BlockChSum.h"
+
+namespace OpenLogReplicator {
+    const char* BlockChSum::kernelName = "scalar";
+    const char* BlockChSum::rejectedKernelName = nullptr;
+    BlockChSum::ChSumKernel BlockChSum::kernel = BlockChSum::kernelSelect();
+
+    // The checksum field is part of the block, so the block is valid when all 16-bit words of the block XOR to zero
+    BlockChSum::ChSumKernel BlockChSum::kernelSelect() {
+#if defined(__x86_64__) && defined(__GNUC__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            if (selfTest(checkAvx512)) {
+                kernelName = "avx512";
+                return checkAvx512;
+            }
+            rejectedKernelName = "avx512";
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            if (selfTest(checkAvx2)) {
+                kernelName = "avx2";
+                return checkAvx2;
+            }
+            if (rejectedKernelName == nullptr)
+                rejectedKernelName = "avx2";
+        }
+#endif
+        kernelName = "scalar";
+        return checkScalar;
+    }
+
+    // Runs before main(), so the result is only recorded and reported later by the replicator
+    bool BlockChSum::selfTest(ChSumKernel candidate) {
+        static constexpr uint64_t BLOCK_SIZES[] = {512, 1024, 4096};
+        static constexpr uint64_t BITMAP_WORDS = (SELF_TEST_BLOCKS + 63) / 64;
+        std::vector<uint8_t> buffer(SELF_TEST_BLOCKS * 4096);
+        uint64_t bitmapScalar[BITMAP_WORDS];
+        uint64_t bitmapCandidate[BITMAP_WORDS];
+
+        for (uint64_t blockSize: BLOCK_SIZES) {
+            fillBlocks(buffer.data(), blockSize, SELF_TEST_BLOCKS);
+            // Lengths with full and partial last bitmap words
+            for (uint64_t blocks = 1; blocks <= SELF_TEST_BLOCKS; blocks += 43) {
+                checkScalar(buffer.data(), blockSize, blocks, bitmapScalar);
+                candidate(buffer.data(), blockSize, blocks, bitmapCandidate);
+                if (memcmp(bitmapScalar, bitmapCandidate, ((blocks + 63) / 64) * sizeof(uint64_t)) != 0)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    void BlockChSum::checkScalar(const uint8_t* buffer, uint64_t blockSize, uint64_t blocks, uint64_t* bitmap) {
+        memset(reinterpret_cast<void*>(bitmap), 0, ((blocks + 63) / 64) * sizeof(uint64_t));
+
+        for (uint64_t block = 0; block < blocks; ++block, buffer += blockSize) {
+            uint64_t sum = 0;
+            for (uint64_t i = 0; i < blockSize / 8; ++i)
+                sum ^= *reinterpret_cast<const uint64_t*>(buffer + i * 8);
+            sum ^= (sum >> 32);
+            sum ^= (sum >> 16);
+
+            if ((sum & 0xFFFF) == 0)
+                bitmap[block >> 6] |= 1ULL << (block & 63);
+        }
+    }
+
+#if defined(__x86_64__) && defined(__GNUC__)
+    __attribute__((target("avx2")))
+    void BlockChSum::checkAvx2(const uint8_t* buffer, uint64_t blockSize, uint64_t blocks, uint64_t* bitmap) {
+        memset(reinterpret_cast<void*>(bitmap), 0, ((blocks + 63) / 64) * sizeof(uint64_t));
+
+        for (uint64_t block = 0; block < blocks; ++block, buffer += blockSize) {
+            __m256i acc0 = _mm256_setzero_si256();
+            __m256i acc1 = _mm256_setzero_si256();
+            for (uint64_t i = 0; i < blockSize; i += 64) {
+                acc0 = _mm256_xor_si256(acc0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer + i)));
+                acc1 = _mm256_xor_si256(acc1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer + i + 32)));
+            }
+            acc0 = _mm256_xor_si256(acc0, acc1);
+            __m128i half = _mm_xor_si128(_mm256_castsi256_si128(acc0), _mm256_extracti128_si256(acc0, 1));
+            uint64_t sum = static_cast<uint64_t>(_mm_cvtsi128_si64(half)) ^ static_cast<uint64_t>(_mm_extract_epi64(half, 1));
+            sum ^= (sum >> 32);
+            sum ^= (sum >> 16);
+
+            if ((sum & 0xFFFF) == 0)
+                bitmap[block >> 6] |= 1ULL << (block & 63);
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    void BlockChSum::checkAvx512(const uint8_t* buffer, uint64_t blockSize, uint64_t blocks, uint64_t* bitmap) {
+        memset(reinterpret_cast<void*>(bitmap), 0, ((blocks + 63) / 64) * sizeof(uint64_t));
+
+        for (uint64_t block = 0; block < blocks; ++block, buffer += blockSize) {
+            __m512i acc0 = _mm512_setzero_si512();
+            __m512i acc1 = _mm512_setzero_si512();
+            for (uint64_t i = 0; i < blockSize; i += 128) {
+                acc0 = _mm512_xor_si512(acc0, _mm512_loadu_si512(reinterpret_cast<const void*>(buffer + i)));
+                acc1 = _mm512_xor_si512(acc1, _mm512_loadu_si512(reinterpret_cast<const void*>(buffer + i + 64)));
+            }
+            acc0 = _mm512_xor_si512(acc0, acc1);
+            __m256i quarter = _mm256_xor_si256(_mm512_castsi512_si256(acc0), _mm512_extracti64x4_epi64(acc0, 1));
+            __m128i half = _mm_xor_si128(_mm256_castsi256_si128(quarter), _mm256_extracti128_si256(quarter, 1));
+            uint64_t sum = static_cast<uint64_t>(_mm_cvtsi128_si64(half)) ^ static_cast<uint64_t>(_mm_extract_epi64(half, 1));
+            sum ^= (sum >> 32);
+            sum ^= (sum >> 16);
+
+            if ((sum & 0xFFFF) == 0)
+                bitmap[block >> 6] |= 1ULL << (block & 63);
+        }
+    }
+#endif
+
+    void BlockChSum::check(const uint8_t* buffer, uint64_t blockSize, uint64_t blocks, uint64_t* bitmap) {
+        kernel(buffer, blockSize, blocks, bitmap);
+    }
+
+    bool BlockChSum::valid(const uint64_t* bitmap, uint64_t block) {
+        return ((bitmap[block >> 6] >> (block & 63)) & 1) != 0;
+    }
+
+    const char* BlockChSum::getKernelName() {
+        return kernelName;
+    }
+
+    const char* BlockChSum::getRejectedKernelName() {
+        return rejectedKernelName;
+    }
+
+    void BlockChSum::fillBlocks(uint8_t* buffer, uint64_t blockSize, uint64_t blocks) {
+        uint64_t seed = 0x9E3779B97F4A7C15ULL;
+        for (uint64_t i = 0; i < blocks * blockSize / 8; ++i) {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            memcpy(buffer + i * 8, &seed, 8);
+        }
+
+        for (uint64_t block = 0; block < blocks; ++block) {
+            if (block % 3 == 2)
+                continue;
+
+            uint8_t* data = buffer + block * blockSize;
+            memset(data + 14, 0, 2);
+            uint64_t sum = 0;
+            for (uint64_t i = 0; i < blockSize / 8; ++i)
+                sum ^= *reinterpret_cast<const uint64_t*>(data + i * 8);
+            sum ^= (sum >> 32);
+            sum ^= (sum >> 16);
+            auto chSum = static_cast<uint16_t>(sum & 0xFFFF);
+            memcpy(data + 14, &chSum, 2);
+        }
+    }
+}
@@ -0,0 +1,61 @@
+/* Header for BlockChSum class
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include "../common/types.h"
+
+#ifndef BLOCK_CH_SUM_H_
+#define BLOCK_CH_SUM_H_
+
+namespace OpenLogReplicator {
+    class BlockChSum final {
+    protected:
+        typedef void (* ChSumKernel)(const uint8_t* buffer, uint64_t blockSize, uint64_t blocks, uint64_t* bitmap);
+
+        // Crosses the bitmap word boundary twice
+        static constexpr uint64_t SELF_TEST_BLOCKS = 130;
+
+        static ChSumKernel kernel;
+        static const char* kernelName;
+        static const char* rejectedKernelName;
+
+        static ChSumKernel kernelSelect();
+        static bool selfTest(ChSumKernel candidate);
+#if defined(__x86_64__) && defined(__GNUC__)
+        static void checkAvx2(const uint8_t* buffer, uint64_t blockSize, uint64_t blocks, uint64_t* bitmap);
+        static void checkAvx512(const uint8_t* buffer, uint64_t blockSize, uint64_t blocks, uint64_t* bitmap);
+#endif
+
+    public:
+        // One memory chunk of the smallest blocks
+        static constexpr uint64_t BLOCKS_MAX = 2048;
+        static constexpr uint64_t BITMAP_SIZE = BLOCKS_MAX / 64;
+
+        // Sets bit n of bitmap when block n has a valid checksum
+        static void check(const uint8_t* buffer, uint64_t blockSize, uint64_t blocks, uint64_t* bitmap);
+        static void checkScalar(const uint8_t* buffer, uint64_t blockSize, uint64_t blocks, uint64_t* bitmap);
+        [[nodiscard]] static bool valid(const uint64_t* bitmap, uint64_t block);
+        [[nodiscard]] static const char* getKernelName();
+        // Faster kernel which gave different results than the scalar one, nullptr if none
+        [[nodiscard]] static const char* getRejectedKernelName();
+        // Random blocks, every third one with an invalid checksum
+        static void fillBlocks(uint8_t* buffer, uint64_t blockSize, uint64_t blocks);
+    };
+}
+
+#endif
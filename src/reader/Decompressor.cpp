@@ -0,0 +1,489 @@
+/* Thread decompressing archived redo log files for the reader
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#define _LARGEFILE_SOURCE
+#define _FILE_OFFSET_BITS 64
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+
+#include "../common/Ctx.h"
+#include "../common/exception/RuntimeException.h"
+#include "Decompressor.h"
+
+namespace OpenLogReplicator {
+    Decompressor::Decompressor(Ctx* newCtx, const std::string& newAlias) :
+            Thread(newCtx, newAlias),
+            input(nullptr),
+            inputPos(0),
+            inputSize(0),
+            headerSize(0),
+            fileDescriptor(-1),
+            type(TYPE_NONE),
+            job(0),
+            jobStream(0),
+            produced(0),
+            consumed(0),
+            totalSize(0),
+            active(false),
+            busy(false),
+            eof(false),
+            frameEnd(false),
+            shutdown(false) {
+#ifdef LINK_ZLIB
+        memset(reinterpret_cast<void*>(&zStream), 0, sizeof(zStream));
+        zStreamInit = false;
+#endif /* LINK_ZLIB */
+#ifdef LINK_ZSTD
+        zstdStream = nullptr;
+#endif /* LINK_ZSTD */
+
+        // Decompressed data is kept aside of the read buffer pool, so that no buffer is held by a file which is not read
+        for (uint64_t num = 0; num < BUFFERS; ++num) {
+            buffers[num] = ctx->getMemoryChunk(Ctx::MEMORY_MODULE_READER, false);
+            buffersSize[num] = 0;
+        }
+        input = ctx->getMemoryChunk(Ctx::MEMORY_MODULE_READER, false);
+    }
+
+    Decompressor::~Decompressor() {
+        streamEnd();
+
+        for (uint64_t num = 0; num < BUFFERS; ++num) {
+            if (buffers[num] != nullptr) {
+                ctx->freeMemoryChunk(Ctx::MEMORY_MODULE_READER, buffers[num], false);
+                buffers[num] = nullptr;
+            }
+        }
+        if (input != nullptr) {
+            ctx->freeMemoryChunk(Ctx::MEMORY_MODULE_READER, input, false);
+            input = nullptr;
+        }
+    }
+
+    uint64_t Decompressor::getType(const std::string& path) {
+#ifdef LINK_ZLIB
+        if (path.length() > 3 && path.compare(path.length() - 3, 3, ".gz") == 0)
+            return TYPE_GZIP;
+#endif /* LINK_ZLIB */
+#ifdef LINK_ZSTD
+        if (path.length() > 4 && path.compare(path.length() - 4, 4, ".zst") == 0)
+            return TYPE_ZSTD;
+#endif /* LINK_ZSTD */
+#if !defined(LINK_ZLIB) && !defined(LINK_ZSTD)
+        (void)path;
+#endif
+        return TYPE_NONE;
+    }
+
+    uint64_t Decompressor::extensionLength(const std::string& path) {
+        switch (getType(path)) {
+            case TYPE_GZIP:
+                return 3;
+            case TYPE_ZSTD:
+                return 4;
+            default:
+                return 0;
+        }
+    }
+
+    bool Decompressor::streamReset() {
+        if (lseek(fileDescriptor, 0, SEEK_SET) != 0) {
+            streamError = "seek returned: " + std::string(strerror(errno));
+            return false;
+        }
+        inputPos = 0;
+        inputSize = 0;
+        frameEnd = false;
+
+#ifdef LINK_ZLIB
+        if (type == TYPE_GZIP) {
+            if (zStreamInit) {
+                inflateEnd(&zStream);
+                zStreamInit = false;
+            }
+            memset(reinterpret_cast<void*>(&zStream), 0, sizeof(zStream));
+            int ret = inflateInit2(&zStream, MAX_WBITS + 16);
+            if (ret != Z_OK) {
+                streamError = "inflate initialization returned: " + std::to_string(ret);
+                return false;
+            }
+            zStreamInit = true;
+        }
+#endif /* LINK_ZLIB */
+#ifdef LINK_ZSTD
+        if (type == TYPE_ZSTD) {
+            if (zstdStream == nullptr) {
+                zstdStream = ZSTD_createDStream();
+                if (zstdStream == nullptr) {
+                    streamError = "zstd stream creation failed";
+                    return false;
+                }
+            }
+            size_t ret = ZSTD_initDStream(zstdStream);
+            if (ZSTD_isError(ret)) {
+                streamError = "zstd stream initialization returned: " + std::string(ZSTD_getErrorName(ret));
+                return false;
+            }
+        }
+#endif /* LINK_ZSTD */
+
+        return true;
+    }
+
+    void Decompressor::streamEnd() {
+#ifdef LINK_ZLIB
+        if (zStreamInit) {
+            inflateEnd(&zStream);
+            zStreamInit = false;
+        }
+#endif /* LINK_ZLIB */
+#ifdef LINK_ZSTD
+        if (zstdStream != nullptr) {
+            ZSTD_freeDStream(zstdStream);
+            zstdStream = nullptr;
+        }
+#endif /* LINK_ZSTD */
+    }
+
+    int64_t Decompressor::inputRead() {
+        int64_t bytes;
+        do {
+            bytes = ::read(fileDescriptor, input, Ctx::MEMORY_CHUNK_SIZE);
+        } while (bytes == -1 && errno == EINTR);
+
+        if (unlikely(ctx->trace & Ctx::TRACE_DISK))
+            ctx->OLR_TRACE(Ctx::TRACE_DISK, "decompress " + fileName + " bytes: " + std::to_string(Ctx::MEMORY_CHUNK_SIZE) + " returns " +
+                                           std::to_string(bytes));
+        if (bytes < 0)
+            streamError = "read returned: " + std::string(strerror(errno));
+        return bytes;
+    }
+
+    int64_t Decompressor::decompressChunk(uint8_t* buffer) {
+#if !defined(LINK_ZLIB) && !defined(LINK_ZSTD)
+        (void)buffer;
+#endif
+        switch (type) {
+#ifdef LINK_ZLIB
+            case TYPE_GZIP:
+                return decompressGzip(buffer);
+#endif /* LINK_ZLIB */
+#ifdef LINK_ZSTD
+            case TYPE_ZSTD:
+                return decompressZstd(buffer);
+#endif /* LINK_ZSTD */
+            default:
+                streamError = "unsupported compression type: " + std::to_string(type);
+                return -1;
+        }
+    }
+
+#ifdef LINK_ZLIB
+    int64_t Decompressor::decompressGzip(uint8_t* buffer) {
+        zStream.next_out = buffer;
+        zStream.avail_out = Ctx::MEMORY_CHUNK_SIZE;
+
+        while (zStream.avail_out > 0) {
+            if (zStream.avail_in == 0) {
+                int64_t bytes = inputRead();
+                if (bytes < 0)
+                    return -1;
+                if (bytes == 0) {
+                    if (!frameEnd) {
+                        streamError = "unexpected end of gzip data";
+                        return -1;
+                    }
+                    break;
+                }
+                zStream.next_in = input;
+                zStream.avail_in = bytes;
+            }
+
+            int ret = inflate(&zStream, Z_NO_FLUSH);
+            if (ret == Z_STREAM_END) {
+                // Concatenated gzip members form one stream
+                frameEnd = true;
+                ret = inflateReset(&zStream);
+                if (ret != Z_OK) {
+                    streamError = "inflate reset returned: " + std::to_string(ret);
+                    return -1;
+                }
+            } else if (ret == Z_OK) {
+                frameEnd = false;
+            } else if (ret != Z_BUF_ERROR || zStream.avail_in > 0) {
+                streamError = "inflate returned: " + std::to_string(ret) + (zStream.msg != nullptr ? ", " + std::string(zStream.msg) : "");
+                return -1;
+            }
+        }
+
+        return static_cast<int64_t>(Ctx::MEMORY_CHUNK_SIZE - zStream.avail_out);
+    }
+#endif /* LINK_ZLIB */
+
+#ifdef LINK_ZSTD
+    int64_t Decompressor::decompressZstd(uint8_t* buffer) {
+        ZSTD_outBuffer outBuffer = {buffer, Ctx::MEMORY_CHUNK_SIZE, 0};
+
+        while (outBuffer.pos < outBuffer.size) {
+            if (inputPos == inputSize) {
+                int64_t bytes = inputRead();
+                if (bytes < 0)
+                    return -1;
+                if (bytes == 0) {
+                    if (!frameEnd) {
+                        streamError = "unexpected end of zstd data";
+                        return -1;
+                    }
+                    break;
+                }
+                inputPos = 0;
+                inputSize = bytes;
+            }
+
+            ZSTD_inBuffer inBuffer = {input, inputSize, inputPos};
+            size_t ret = ZSTD_decompressStream(zstdStream, &outBuffer, &inBuffer);
+            inputPos = inBuffer.pos;
+            if (ZSTD_isError(ret)) {
+                streamError = "zstd decompression returned: " + std::string(ZSTD_getErrorName(ret));
+                return -1;
+            }
+            frameEnd = (ret == 0);
+        }
+
+        return static_cast<int64_t>(outBuffer.pos);
+    }
+#endif /* LINK_ZSTD */
+
+    void Decompressor::mainLoop() {
+        while (!ctx->softShutdown) {
+            uint8_t* buffer;
+            uint64_t chunk;
+            uint64_t currentJob;
+            {
+                std::unique_lock<std::mutex> lck(mtx);
+                if (shutdown)
+                    break;
+
+                if (!active || eof || !error.empty() || produced - consumed >= BUFFERS) {
+                    if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
+                        ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "Decompressor:mainLoop");
+                    condProducer.wait(lck);
+                    continue;
+                }
+
+                chunk = produced;
+                currentJob = job;
+                buffer = buffers[chunk % BUFFERS];
+                busy = true;
+            }
+
+            int64_t bytes = -1;
+            if (jobStream == currentJob || streamReset()) {
+                jobStream = currentJob;
+                bytes = decompressChunk(buffer);
+            }
+
+            std::unique_lock<std::mutex> lck(mtx);
+            busy = false;
+            condConsumer.notify_all();
+            // The file was closed or rewound in the meantime
+            if (currentJob != job)
+                continue;
+
+            if (bytes < 0) {
+                error = streamError;
+                continue;
+            }
+
+            if (chunk == 0) {
+                headerSize = std::min(static_cast<uint64_t>(bytes), HEADER_SIZE);
+                memcpy(reinterpret_cast<void*>(header), reinterpret_cast<const void*>(buffer), headerSize);
+            }
+
+            buffersSize[chunk % BUFFERS] = bytes;
+            if (bytes > 0)
+                ++produced;
+            totalSize += bytes;
+            if (static_cast<uint64_t>(bytes) < Ctx::MEMORY_CHUNK_SIZE)
+                eof = true;
+        }
+    }
+
+    void Decompressor::start(int newFileDescriptor, uint64_t newType, const std::string& newFileName) {
+        std::unique_lock<std::mutex> lck(mtx);
+        while (busy)
+            condConsumer.wait(lck);
+
+        fileDescriptor = newFileDescriptor;
+        type = newType;
+        fileName = newFileName;
+        ++job;
+        produced = 0;
+        consumed = 0;
+        totalSize = 0;
+        headerSize = 0;
+        eof = false;
+        error.clear();
+        active = true;
+        condProducer.notify_all();
+    }
+
+    void Decompressor::stop() {
+        std::unique_lock<std::mutex> lck(mtx);
+        active = false;
+        ++job;
+        // After return the file descriptor is not used anymore
+        while (busy)
+            condConsumer.wait(lck);
+    }
+
+    int64_t Decompressor::read(uint8_t* buf, uint64_t size, uint64_t offset) {
+        if (size == 0)
+            return 0;
+
+        std::unique_lock<std::mutex> lck(mtx);
+        if (!active) {
+            error = "no file opened";
+            return -1;
+        }
+
+        // The header is read again when the file is checked, no need to decompress it twice
+        if (offset + size <= HEADER_SIZE) {
+            while (headerSize == 0 && !eof && error.empty() && !ctx->softShutdown)
+                condConsumer.wait(lck);
+            if (offset + size <= headerSize) {
+                memcpy(reinterpret_cast<void*>(buf), reinterpret_cast<const void*>(header + offset), size);
+                return static_cast<int64_t>(size);
+            }
+        }
+
+        uint64_t chunk = offset / Ctx::MEMORY_CHUNK_SIZE;
+        if (chunk < consumed) {
+            // Read backwards, the stream must be decompressed again from the beginning
+            if (unlikely(ctx->trace & Ctx::TRACE_FILE))
+                ctx->OLR_TRACE(Ctx::TRACE_FILE, "decompress " + fileName + " rewind from " + std::to_string(consumed * Ctx::MEMORY_CHUNK_SIZE) +
+                                               " to " + std::to_string(offset));
+            ++job;
+            produced = 0;
+            consumed = 0;
+            totalSize = 0;
+            eof = false;
+            error.clear();
+            condProducer.notify_all();
+        }
+
+        while (chunk >= produced && !eof && error.empty()) {
+            if (ctx->softShutdown)
+                return 0;
+
+            // Data before the requested offset would not be read
+            if (consumed < produced) {
+                consumed = produced;
+                condProducer.notify_all();
+            }
+
+            if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
+                ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "Decompressor:read");
+            condConsumer.wait(lck);
+        }
+
+        if (!error.empty())
+            return -1;
+        if (chunk >= produced)
+            return 0;
+
+        if (consumed < chunk) {
+            consumed = chunk;
+            condProducer.notify_all();
+        }
+
+        uint64_t pos = offset % Ctx::MEMORY_CHUNK_SIZE;
+        uint64_t num = chunk % BUFFERS;
+        if (pos >= buffersSize[num])
+            return 0;
+
+        uint64_t bytes = std::min(size, buffersSize[num] - pos);
+        memcpy(reinterpret_cast<void*>(buf), reinterpret_cast<const void*>(buffers[num] + pos), bytes);
+
+        // The reader has reached the end of the chunk, it would not be read again
+        if (pos + bytes == Ctx::MEMORY_CHUNK_SIZE) {
+            consumed = chunk + 1;
+            condProducer.notify_all();
+        }
+
+        return static_cast<int64_t>(bytes);
+    }
+
+    bool Decompressor::isEof(uint64_t& size) {
+        std::unique_lock<std::mutex> lck(mtx);
+        size = totalSize;
+        return eof;
+    }
+
+    std::string Decompressor::getError() {
+        std::unique_lock<std::mutex> lck(mtx);
+        return error;
+    }
+
+    void Decompressor::finish() {
+        std::unique_lock<std::mutex> lck(mtx);
+        shutdown = true;
+        condProducer.notify_all();
+    }
+
+    void Decompressor::wakeUp() {
+        std::unique_lock<std::mutex> lck(mtx);
+        condProducer.notify_all();
+        condConsumer.notify_all();
+    }
+
+    void Decompressor::run() {
+        if (unlikely(ctx->trace & Ctx::TRACE_THREADS)) {
+            std::ostringstream ss;
+            ss << std::this_thread::get_id();
+            ctx->OLR_TRACE(Ctx::TRACE_THREADS, "decompressor (" + ss.str() + ") start");
+        }
+
+        try {
+            mainLoop();
+        } catch (RuntimeException& ex) {
+            ctx->OLR_ERROR(ex.code, ex.msg);
+            ctx->stopHard();
+        } catch (std::bad_alloc& ex) {
+            ctx->OLR_ERROR(10018, "memory allocation failed: " + std::string(ex.what()));
+            ctx->stopHard();
+        }
+
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            streamEnd();
+            condConsumer.notify_all();
+        }
+
+        if (unlikely(ctx->trace & Ctx::TRACE_THREADS)) {
+            std::ostringstream ss;
+            ss << std::this_thread::get_id();
+            ctx->OLR_TRACE(Ctx::TRACE_THREADS, "decompressor (" + ss.str() + ") stop");
+        }
+    }
+}
@@ -0,0 +1,111 @@
+/* Header for Decompressor class
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <condition_variable>
+#include <mutex>
+
+#include "../common/Thread.h"
+#include "../common/types.h"
+
+#ifdef LINK_ZLIB
+#include <zlib.h>
+#endif /* LINK_ZLIB */
+#ifdef LINK_ZSTD
+#include <zstd.h>
+#endif /* LINK_ZSTD */
+
+#ifndef DECOMPRESSOR_H_
+#define DECOMPRESSOR_H_
+
+namespace OpenLogReplicator {
+    class Decompressor final : public Thread {
+    public:
+        static constexpr uint64_t TYPE_NONE = 0;
+        static constexpr uint64_t TYPE_GZIP = 1;
+        static constexpr uint64_t TYPE_ZSTD = 2;
+
+    protected:
+        static constexpr uint64_t BUFFERS = 4;
+        // Two blocks of the largest block size
+        static constexpr uint64_t HEADER_SIZE = 8192;
+
+        std::mutex mtx;
+        std::condition_variable condProducer;
+        std::condition_variable condConsumer;
+        uint8_t* buffers[BUFFERS];
+        uint64_t buffersSize[BUFFERS];
+        uint8_t* input;
+        uint64_t inputPos;
+        uint64_t inputSize;
+        uint8_t header[HEADER_SIZE];
+        uint64_t headerSize;
+        std::string fileName;
+        std::string error;
+        std::string streamError;
+        int fileDescriptor;
+        uint64_t type;
+        uint64_t job;
+        uint64_t jobStream;
+        uint64_t produced;
+        uint64_t consumed;
+        uint64_t totalSize;
+        bool active;
+        bool busy;
+        bool eof;
+        bool frameEnd;
+        bool shutdown;
+#ifdef LINK_ZLIB
+        z_stream zStream;
+        bool zStreamInit;
+#endif /* LINK_ZLIB */
+#ifdef LINK_ZSTD
+        ZSTD_DStream* zstdStream;
+#endif /* LINK_ZSTD */
+
+        bool streamReset();
+        void streamEnd();
+        int64_t inputRead();
+        int64_t decompressChunk(uint8_t* buffer);
+#ifdef LINK_ZLIB
+        int64_t decompressGzip(uint8_t* buffer);
+#endif /* LINK_ZLIB */
+#ifdef LINK_ZSTD
+        int64_t decompressZstd(uint8_t* buffer);
+#endif /* LINK_ZSTD */
+        void mainLoop();
+
+    public:
+        Decompressor(Ctx* newCtx, const std::string& newAlias);
+        ~Decompressor() override;
+
+        static uint64_t getType(const std::string& path);
+        static uint64_t extensionLength(const std::string& path);
+
+        void start(int newFileDescriptor, uint64_t newType, const std::string& newFileName);
+        void stop();
+        int64_t read(uint8_t* buf, uint64_t size, uint64_t offset);
+        [[nodiscard]] bool isEof(uint64_t& size);
+        [[nodiscard]] std::string getError();
+        void finish();
+        void wakeUp() override;
+        void run() override;
+    };
+}
+
+#endif
@@ -32,6 +32,7 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #include "../common/exception/RuntimeException.h"
 #include "../common/metrics/Metrics.h"
 #include "Reader.h"
+#include "RedoCopier.h"
 
 namespace OpenLogReplicator {
     const char* Reader::REDO_CODE[] = {"OK", "OVERWRITTEN", "FINISHED", "STOPPED", "SHUTDOWN", "EMPTY", "READ ERROR",
@@ -41,7 +42,7 @@ namespace OpenLogReplicator {
     Reader::Reader(Ctx* newCtx, const std::string& newAlias, const std::string& newDatabase, int64_t newGroup, bool newConfiguredBlockSum) :
             Thread(newCtx, newAlias),
             database(newDatabase),
-            fileCopyDescriptor(-1),
+            redoCopier(nullptr),
             fileSize(0),
             fileCopySequence(0),
             hintDisplayed(false),
@@ -53,7 +54,9 @@ namespace OpenLogReplicator {
             numBlocksHeader(Ctx::ZERO_BLK),
             resetlogs(0),
             activation(0),
+            thread(0),
             headerBuffer(nullptr),
+            verifyBuffer(nullptr),
             compatVsn(0),
             firstTimeHeader(0),
             firstScn(Ctx::ZERO_SCN),
@@ -62,6 +65,7 @@ namespace OpenLogReplicator {
             nextScnHeader(Ctx::ZERO_SCN),
             nextTime(0),
             blockSize(0),
+            bufferSizeMax(newCtx->bufferSizeMax),
             bufferScan(0),
             lastRead(0),
             lastReadTime(0),
@@ -71,7 +75,11 @@ namespace OpenLogReplicator {
             bufferEnd(0),
             status(STATUS_SLEEPING),
             ret(REDO_OK),
-            redoBufferList(nullptr) {
+            parserEnd(0),
+            parserWaiting(false),
+            readerWaiting(false),
+            redoBufferList(nullptr),
+            archPrefetcher(nullptr) {
     }
 
     void Reader::initialize() {
@@ -87,9 +95,26 @@ namespace OpenLogReplicator {
                                               " bytes memory for: read header");
         }
 
+        // Only the first sector of every block is read for verification, the rest of the block is covered by the checksum validated
+        // during the first read, without checksums every block is read again; the last page is scratch space for the rest of the blocks
+        if (verifyBuffer == nullptr && group != 0 && ctx->redoVerifyDelayUs > 0 && ctx->redoVerifyMode == Ctx::REDO_VERIFY_MODE_HEADER &&
+                configuredBlockSum && !ctx->disableChecksSet(Ctx::DISABLE_CHECKS_BLOCK_SUM)) {
+            verifyBuffer = reinterpret_cast<uint8_t*>(aligned_alloc(Ctx::MEMORY_ALIGNMENT, Ctx::MEMORY_CHUNK_SIZE / 2 + PAGE_SIZE_MAX));
+            if (unlikely(verifyBuffer == nullptr))
+                throw RuntimeException(10016, "couldn't allocate " + std::to_string(Ctx::MEMORY_CHUNK_SIZE / 2 + PAGE_SIZE_MAX) +
+                                              " bytes memory for: verify headers");
+        }
+
         if (ctx->redoCopyPath.length() > 0) {
             if ((opendir(ctx->redoCopyPath.c_str())) == nullptr)
                 throw RuntimeException(10012, "directory: " + ctx->redoCopyPath + " - can't read");
+
+            if (redoCopier == nullptr) {
+                copyPending.assign(ctx->readBufferMax, 0);
+                copyFreeDeferred.assign(ctx->readBufferMax, false);
+                redoCopier = new RedoCopier(ctx, alias + "-copier", this);
+                ctx->spawnThread(redoCopier);
+            }
         }
     }
 
@@ -98,9 +123,18 @@ namespace OpenLogReplicator {
         condBufferFull.notify_all();
         condReaderSleeping.notify_all();
         condParserSleeping.notify_all();
+        condBufferCopied.notify_all();
     }
 
     Reader::~Reader() {
+        if (redoCopier != nullptr) {
+            redoCopier->fileClose();
+            redoCopier->finish();
+            ctx->finishThread(redoCopier);
+            delete redoCopier;
+            redoCopier = nullptr;
+        }
+
         for (uint64_t num = 0; num < ctx->readBufferMax; ++num)
             bufferFree(num);
 
@@ -114,10 +148,13 @@ namespace OpenLogReplicator {
             headerBuffer = nullptr;
         }
 
-        closeCopyDescriptor();
+        if (verifyBuffer != nullptr) {
+            free(verifyBuffer);
+            verifyBuffer = nullptr;
+        }
     }
 
-    uint64_t Reader::checkBlockHeader(uint8_t* buffer, typeBlk blockNumber, bool showHint) {
+    uint64_t Reader::checkBlockHeader(uint8_t* buffer, typeBlk blockNumber, bool showHint, bool chSumValid) {
         if (buffer[0] == 0 && buffer[1] == 0)
             return REDO_EMPTY;
 
@@ -155,7 +192,7 @@ namespace OpenLogReplicator {
             return REDO_ERROR_BLOCK;
         }
 
-        if (!ctx->disableChecksSet(Ctx::DISABLE_CHECKS_BLOCK_SUM)) {
+        if (!ctx->disableChecksSet(Ctx::DISABLE_CHECKS_BLOCK_SUM) && !chSumValid) {
             typeSum chSum = ctx->read16(buffer + 14);
             typeSum chSumCalculated = calcChSum(buffer, blockSize);
             if (chSum != chSumCalculated) {
@@ -178,6 +215,9 @@ namespace OpenLogReplicator {
         return REDO_OK;
     }
 
+    void Reader::redoDrain() {
+    }
+
     uint64_t Reader::readSize(uint64_t prevRead) {
         if (prevRead < blockSize)
             return blockSize;
@@ -234,7 +274,7 @@ namespace OpenLogReplicator {
             return REDO_ERROR_READ;
         }
 
-        if (actualRead > 0 && ctx->redoCopyPath.length() > 0) {
+        if (actualRead > 0 && redoCopier != nullptr) {
             if (static_cast<uint64_t>(actualRead) > blockSize * 2)
                 actualRead = static_cast<int64_t>(blockSize * 2);
 
@@ -243,21 +283,14 @@ namespace OpenLogReplicator {
                 closeCopyDescriptor();
             }
 
-            if (fileCopyDescriptor == -1) {
+            if (!redoCopier->isOpen()) {
                 fileNameWrite = ctx->redoCopyPath + "/" + database + "_" + std::to_string(sequenceHeader) + ".arc";
-                fileCopyDescriptor = open(fileNameWrite.c_str(), O_CREAT | O_WRONLY, S_IRUSR | S_IWUSR);
-                if (unlikely(fileCopyDescriptor == -1))
-                    throw RuntimeException(10006, "file: " + fileNameWrite + " - open for write returned: " + strerror(errno));
-                ctx->OLR_INFO(0, "writing redo log copy to: " + fileNameWrite);
+                redoCopier->fileOpen(fileNameWrite);
                 fileCopySequence = sequenceHeader;
             }
 
-            int64_t bytesWritten = pwrite(fileCopyDescriptor, headerBuffer, actualRead, 0);
-            if (bytesWritten != actualRead) {
-                ctx->OLR_ERROR(10007, "file: " + fileNameWrite + " - " + std::to_string(bytesWritten) + " bytes written instead of " +
-                                  std::to_string(actualRead) + ", code returned: " + strerror(errno));
+            if (!redoCopier->copyHeader(headerBuffer, actualRead))
                 return REDO_ERROR_WRITE;
-            }
         }
 
         return REDO_OK;
@@ -287,6 +320,7 @@ namespace OpenLogReplicator {
         }
 
         activation = ctx->read32(headerBuffer + blockSize + 52);
+        thread = ctx->read16(headerBuffer + blockSize + 176);
         numBlocksHeader = ctx->read32(headerBuffer + blockSize + 156);
         resetlogs = ctx->read32(headerBuffer + blockSize + 160);
         firstScnHeader = ctx->readScn(headerBuffer + blockSize + 180);
@@ -373,12 +407,106 @@ namespace OpenLogReplicator {
 
     void Reader::closeCopyDescriptor()
     {
-        if (fileCopyDescriptor != -1) {
-            close(fileCopyDescriptor);
-            fileCopyDescriptor = -1;
+        if (redoCopier != nullptr)
+            redoCopier->fileClose();
+    }
+
+    bool Reader::bufferCopy(uint64_t num, uint64_t pos, uint64_t size, uint64_t offset) {
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            ++copyPending[num];
+        }
+
+        // Written in background, the buffer is released after the write
+        if (!redoCopier->copy(redoBufferList[num] + pos, size, offset, num)) {
+            bufferCopyDone(num);
+            return false;
+        }
+        return true;
+    }
+
+    bool Reader::bufferCopyHold(uint64_t num) {
+        if (redoCopier == nullptr)
+            return false;
+
+        std::unique_lock<std::mutex> lck(mtx);
+        if (copyPending[num] == 0)
+            return false;
+        copyFreeDeferred[num] = true;
+        return true;
+    }
+
+    void Reader::bufferCopyWait(uint64_t num) {
+        if (redoCopier == nullptr)
+            return;
+
+        std::unique_lock<std::mutex> lck(mtx);
+        while (copyFreeDeferred[num] && !ctx->softShutdown) {
+            if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
+                ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "Reader:bufferCopyWait");
+            condBufferCopied.wait(lck);
         }
     }
 
+    void Reader::bufferCopyDone(uint64_t num) {
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            --copyPending[num];
+            if (copyPending[num] > 0 || !copyFreeDeferred[num])
+                return;
+        }
+
+        // Freeing was requested by the parser while the copy was not written yet
+        bufferFree(num);
+
+        std::unique_lock<std::mutex> lck(mtx);
+        copyFreeDeferred[num] = false;
+        condBufferCopied.notify_all();
+        condBufferFull.notify_all();
+    }
+
+    uint64_t Reader::redoReadHeaders(uint8_t* buf, uint64_t offset, uint64_t blocks, uint64_t& bytes) {
+        for (uint64_t numBlock = 0; numBlock < blocks; ++numBlock) {
+            int64_t actualRead = redoRead(buf + numBlock * VERIFY_SECTOR_SIZE, VERIFY_SECTOR_SIZE, offset + numBlock * blockSize);
+            if (actualRead != static_cast<int64_t>(VERIFY_SECTOR_SIZE))
+                return numBlock;
+            bytes += VERIFY_SECTOR_SIZE;
+        }
+        return blocks;
+    }
+
+    uint64_t Reader::verifyHeaders(uint8_t* buffer, uint64_t blocks, uint64_t offset) {
+        uint64_t bytes = 0;
+        uint64_t headerBlocks = redoReadHeaders(verifyBuffer, offset, blocks, bytes);
+        if (ctx->metrics)
+            ctx->metrics->emitBytesRead(bytes);
+
+        uint64_t numBlock = 0;
+        for (; numBlock < headerBlocks; ++numBlock) {
+            const uint8_t* sector = verifyBuffer + numBlock * VERIFY_SECTOR_SIZE;
+            uint8_t* block = buffer + numBlock * blockSize;
+
+            // A block without checksum can't be verified by its first sector
+            if (ctx->read16(block + 14) == 0)
+                break;
+
+            // The beginning of the block holds the time of the first read, the rest must be unchanged
+            if (memcmp(reinterpret_cast<const void*>(sector + sizeof(time_ut)), reinterpret_cast<const void*>(block + sizeof(time_ut)),
+                       VERIFY_SECTOR_SIZE - sizeof(time_ut)) != 0)
+                break;
+            memcpy(reinterpret_cast<void*>(block), reinterpret_cast<const void*>(sector), sizeof(time_ut));
+        }
+
+        // Nothing is saved when whole blocks had to be read to get the sectors
+        if (ctx->metrics && numBlock > 0 && bytes < headerBlocks * blockSize)
+            ctx->metrics->emitBytesVerifySaved(numBlock * (blockSize - bytes / headerBlocks));
+
+        if (unlikely(ctx->trace & Ctx::TRACE_DISK))
+            ctx->OLR_TRACE(Ctx::TRACE_DISK, "verify " + fileName + " at " + std::to_string(offset) + " blocks: " + std::to_string(blocks) +
+                                           " headers read: " + std::to_string(headerBlocks) + " unchanged: " + std::to_string(numBlock));
+        return numBlock;
+    }
+
     bool Reader::read1() {
         uint64_t toRead = readSize(lastRead);
         toRead = std::min(toRead, fileSize - bufferScan);
@@ -412,12 +540,8 @@ namespace OpenLogReplicator {
         if (ctx->metrics)
             ctx->metrics->emitBytesRead(actualRead);
 
-        if (actualRead > 0 && fileCopyDescriptor != -1 && (ctx->redoVerifyDelayUs == 0 || group == 0)) {
-            int64_t bytesWritten = pwrite(fileCopyDescriptor, redoBufferList[redoBufferNum] + redoBufferPos, actualRead,
-                                          static_cast<int64_t>(bufferEnd));
-            if (bytesWritten != actualRead) {
-                ctx->OLR_ERROR(10007, "file: " + fileNameWrite + " - " + std::to_string(bytesWritten) + " bytes written instead of " +
-                                  std::to_string(actualRead) + ", code returned: " + strerror(errno));
+        if (actualRead > 0 && redoCopier != nullptr && (ctx->redoVerifyDelayUs == 0 || group == 0)) {
+            if (!bufferCopy(redoBufferNum, redoBufferPos, actualRead, bufferEnd)) {
                 ret = REDO_ERROR_WRITE;
                 return false;
             }
@@ -428,10 +552,15 @@ namespace OpenLogReplicator {
         uint64_t goodBlocks = 0;
         uint64_t currentRet = REDO_OK;
 
+        bool chSumChecked = !ctx->disableChecksSet(Ctx::DISABLE_CHECKS_BLOCK_SUM);
+        if (chSumChecked)
+            BlockChSum::check(redoBufferList[redoBufferNum] + redoBufferPos, blockSize, maxNumBlock, chSumBitmap);
+
         // Check which blocks are good
         for (uint64_t numBlock = 0; numBlock < maxNumBlock; ++numBlock) {
             currentRet = checkBlockHeader(redoBufferList[redoBufferNum] + redoBufferPos + numBlock * blockSize, bufferScanBlock + numBlock,
-                                          ctx->redoVerifyDelayUs == 0 || group == 0);
+                                          ctx->redoVerifyDelayUs == 0 || group == 0,
+                                          chSumChecked && BlockChSum::valid(chSumBitmap, numBlock));
             if (unlikely(ctx->trace & Ctx::TRACE_DISK))
                 ctx->OLR_TRACE(Ctx::TRACE_DISK, "block: " + std::to_string(bufferScanBlock + numBlock) + " check: " +
                                                std::to_string(currentRet));
@@ -486,10 +615,8 @@ namespace OpenLogReplicator {
                     *readTimeP = lastReadTime;
                 }
             } else {
-                std::unique_lock<std::mutex> lck(mtx);
-                bufferEnd += goodBlocks * blockSize;
+                dataPublish(bufferEnd + goodBlocks * blockSize);
                 bufferScan = bufferEnd;
-                condParserSleeping.notify_all();
             }
         }
 
@@ -545,29 +672,35 @@ namespace OpenLogReplicator {
                 return false;
             }
 
-            if (unlikely(ctx->trace & Ctx::TRACE_DISK))
-                ctx->OLR_TRACE(Ctx::TRACE_DISK, "reading#2 " + fileName + " at (" + std::to_string(bufferStart) + "/" +
-                                               std::to_string(bufferEnd) + "/" + std::to_string(bufferScan) + ") bytes: " + std::to_string(toRead));
-            int64_t actualRead = redoRead(redoBufferList[redoBufferNum] + redoBufferPos, toRead, bufferEnd);
+            // Blocks with unchanged headers are not read again
+            uint64_t verifiedBlocks = 0;
+            if (verifyBuffer != nullptr && blockSize > VERIFY_SECTOR_SIZE)
+                verifiedBlocks = verifyHeaders(redoBufferList[redoBufferNum] + redoBufferPos, toRead / blockSize, bufferEnd);
 
-            if (unlikely(ctx->trace & Ctx::TRACE_DISK))
-                ctx->OLR_TRACE(Ctx::TRACE_DISK, "reading#2 " + fileName + " at (" + std::to_string(bufferStart) + "/" +
-                                               std::to_string(bufferEnd) + "/" + std::to_string(bufferScan) + ") got: " + std::to_string(actualRead));
+            int64_t actualRead;
+            if (verifiedBlocks > 0)
+                actualRead = static_cast<int64_t>(verifiedBlocks * blockSize);
+            else {
+                if (unlikely(ctx->trace & Ctx::TRACE_DISK))
+                    ctx->OLR_TRACE(Ctx::TRACE_DISK, "reading#2 " + fileName + " at (" + std::to_string(bufferStart) + "/" +
+                                                   std::to_string(bufferEnd) + "/" + std::to_string(bufferScan) + ") bytes: " + std::to_string(toRead));
+                actualRead = redoRead(redoBufferList[redoBufferNum] + redoBufferPos, toRead, bufferEnd);
 
-            if (actualRead < 0) {
-                ctx->OLR_ERROR(40003, "read file: " + fileName + " - " + strerror(errno));
-                ret = REDO_ERROR_READ;
-                return false;
+                if (unlikely(ctx->trace & Ctx::TRACE_DISK))
+                    ctx->OLR_TRACE(Ctx::TRACE_DISK, "reading#2 " + fileName + " at (" + std::to_string(bufferStart) + "/" +
+                                                   std::to_string(bufferEnd) + "/" + std::to_string(bufferScan) + ") got: " + std::to_string(actualRead));
+
+                if (actualRead < 0) {
+                    ctx->OLR_ERROR(40003, "read file: " + fileName + " - " + strerror(errno));
+                    ret = REDO_ERROR_READ;
+                    return false;
+                }
+                if (ctx->metrics)
+                    ctx->metrics->emitBytesRead(actualRead);
             }
-            if (ctx->metrics)
-                ctx->metrics->emitBytesRead(actualRead);
-
-            if (actualRead > 0 && fileCopyDescriptor != -1) {
-                int64_t bytesWritten = pwrite(fileCopyDescriptor, redoBufferList[redoBufferNum] + redoBufferPos, actualRead,
-                                              static_cast<int64_t>(bufferEnd));
-                if (bytesWritten != actualRead) {
-                    ctx->OLR_ERROR(10007, "file: " + fileNameWrite + " - " + std::to_string(bytesWritten) +
-                                      " bytes written instead of " + std::to_string(actualRead) + ", code returned: " + strerror(errno));
+
+            if (actualRead > 0 && redoCopier != nullptr) {
+                if (!bufferCopy(redoBufferNum, redoBufferPos, actualRead, bufferEnd)) {
                     ret = REDO_ERROR_WRITE;
                     return false;
                 }
@@ -578,10 +711,14 @@ namespace OpenLogReplicator {
             maxNumBlock = actualRead / blockSize;
             typeBlk bufferEndBlock = bufferEnd / blockSize;
 
+            bool chSumChecked = !ctx->disableChecksSet(Ctx::DISABLE_CHECKS_BLOCK_SUM);
+            if (chSumChecked)
+                BlockChSum::check(redoBufferList[redoBufferNum] + redoBufferPos, blockSize, maxNumBlock, chSumBitmap);
+
             // Check which blocks are good
             for (uint64_t numBlock = 0; numBlock < maxNumBlock; ++numBlock) {
                 currentRet = checkBlockHeader(redoBufferList[redoBufferNum] + redoBufferPos + numBlock * blockSize,
-                                              bufferEndBlock + numBlock, true);
+                                              bufferEndBlock + numBlock, true, chSumChecked && BlockChSum::valid(chSumBitmap, numBlock));
                 if (unlikely(ctx->trace & Ctx::TRACE_DISK))
                     ctx->OLR_TRACE(Ctx::TRACE_DISK, "block: " + std::to_string(bufferEndBlock + numBlock) + " check: " +
                                                    std::to_string(currentRet));
@@ -600,11 +737,7 @@ namespace OpenLogReplicator {
                 return false;
             }
 
-            {
-                std::unique_lock<std::mutex> lck(mtx);
-                bufferEnd += actualRead;
-                condParserSleeping.notify_all();
-            }
+            dataPublish(bufferEnd + actualRead);
         }
 
         return true;
@@ -620,11 +753,16 @@ namespace OpenLogReplicator {
                     if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
                         ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "Reader:mainLoop:sleep");
                     condReaderSleeping.wait(lck);
-                } else if (status == STATUS_READ && !ctx->softShutdown && ctx->buffersFree == 0 && (bufferEnd % Ctx::MEMORY_CHUNK_SIZE) == 0) {
-                    // Buffer full
-                    if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
-                        ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "Reader:mainLoop:buffer");
-                    condBufferFull.wait(lck);
+                } else {
+                    // The parser notifies only a waiting reader, the flag is set before the buffers are checked
+                    readerWaiting = true;
+                    if (status == STATUS_READ && !ctx->softShutdown && ctx->buffersFree == 0 && (bufferEnd % Ctx::MEMORY_CHUNK_SIZE) == 0) {
+                        // Buffer full
+                        if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
+                            ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "Reader:mainLoop:buffer");
+                        condBufferFull.wait(lck);
+                    }
+                    readerWaiting = false;
                 }
             }
 
@@ -634,6 +772,9 @@ namespace OpenLogReplicator {
             if (status == STATUS_CHECK) {
                 if (unlikely(ctx->trace & Ctx::TRACE_FILE))
                     ctx->OLR_TRACE(Ctx::TRACE_FILE, "trying to open: " + fileName);
+                // Pending copy requests may still point to the data of the closed file
+                if (redoCopier != nullptr)
+                    redoCopier->drain();
                 redoClose();
                 uint64_t currentRet = redoOpen();
                 {
@@ -645,6 +786,7 @@ namespace OpenLogReplicator {
                 continue;
 
             } else if (status == STATUS_UPDATE) {
+                redoDrain();
                 closeCopyDescriptor();
 
                 statistic.sumRead = 0;
@@ -692,14 +834,20 @@ namespace OpenLogReplicator {
                     }
 
                     // Buffer full?
-                    if (bufferStart + ctx->bufferSizeMax == bufferEnd) {
+                    if (isBufferFull()) {
+                        for (uint64_t spin = 0; spin < ReaderRing::SPIN_MAX && !ctx->softShutdown && isBufferFull(); ++spin)
+                            ReaderRing::relax();
+
                         std::unique_lock<std::mutex> lck(mtx);
-                        if (!ctx->softShutdown && bufferStart + ctx->bufferSizeMax == bufferEnd) {
+                        readerWaiting = true;
+                        if (!ctx->softShutdown && isBufferFull()) {
                             if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
                                 ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "Reader:mainLoop:bufferFull");
                             condBufferFull.wait(lck);
+                            readerWaiting = false;
                             continue;
                         }
+                        readerWaiting = false;
                     }
 
                     if (bufferEnd < bufferScan)
@@ -707,7 +855,7 @@ namespace OpenLogReplicator {
                             break;
 
                     // #1 read
-                    if (bufferScan < fileSize && (ctx->buffersFree > 0 || (bufferScan % Ctx::MEMORY_CHUNK_SIZE) > 0)
+                    if (bufferScan < fileSize && (ctx->buffersFree > 0 || (bufferScan % Ctx::MEMORY_CHUNK_SIZE) > 0 || bufferPrefetched(bufferScan))
                         && (!reachedZero || lastReadTime + static_cast<time_t>(ctx->redoReadSleepUs) < loopTime))
                         if (!read1())
                             break;
@@ -739,6 +887,7 @@ namespace OpenLogReplicator {
                         }
                     }
                 }
+                redoDrain();
 
                 {
                     std::unique_lock<std::mutex> lck(mtx);
@@ -779,8 +928,8 @@ namespace OpenLogReplicator {
             ctx->stopHard();
         }
 
-        redoClose();
         closeCopyDescriptor();
+        redoClose();
 
         if (unlikely(ctx->trace & Ctx::TRACE_THREADS)) {
             std::ostringstream ss;
@@ -790,6 +939,7 @@ namespace OpenLogReplicator {
     }
 
     void Reader::bufferAllocate(uint64_t num) {
+        bufferCopyWait(num);
         if (redoBufferList[num] == nullptr) {
             redoBufferList[num] = ctx->getMemoryChunk(Ctx::MEMORY_MODULE_READER, false);
             if (unlikely(ctx->buffersFree == 0))
@@ -800,11 +950,27 @@ namespace OpenLogReplicator {
         }
     }
 
+    bool Reader::bufferPrefetched(uint64_t offset) const {
+        // Chunk already allocated ahead of the scan position, but not the one still owned by the parser
+        if (offset / Ctx::MEMORY_CHUNK_SIZE >= bufferStart / Ctx::MEMORY_CHUNK_SIZE + ctx->readBufferMax)
+            return false;
+        return redoBufferList[(offset / Ctx::MEMORY_CHUNK_SIZE) % ctx->readBufferMax] != nullptr;
+    }
+
     void Reader::bufferFree(uint64_t num) {
+        if (bufferCopyHold(num))
+            return;
+
         if (redoBufferList[num] != nullptr) {
             ctx->freeMemoryChunk(Ctx::MEMORY_MODULE_READER, redoBufferList[num], false);
             redoBufferList[num] = nullptr;
             ctx->releaseBuffer();
+
+            // The reader sets the flag before it checks the free buffers, so the wakeup is not lost
+            if (readerWaiting) {
+                std::unique_lock<std::mutex> lck(mtx);
+                condBufferFull.notify_all();
+            }
         }
     }
 
@@ -845,7 +1011,6 @@ namespace OpenLogReplicator {
         memcpy(reinterpret_cast<void*>(descrip),
                reinterpret_cast<const void*>(headerBuffer + blockSize + 92), 64);
         descrip[64] = 0;
-        uint16_t thread = ctx->read16(headerBuffer + blockSize + 176);
         uint32_t hws = ctx->read32(headerBuffer + blockSize + 172);
         uint8_t eot = headerBuffer[blockSize + 204];
         uint8_t dis = headerBuffer[blockSize + 205];
@@ -988,6 +1153,30 @@ namespace OpenLogReplicator {
         return bufferEnd;
     }
 
+    uint64_t Reader::getDataEnd() {
+        ReaderRange range;
+        time_ut oldestTime = 0;
+        bool taken = false;
+
+        while (ring.pop(range)) {
+            if (!taken)
+                oldestTime = range.time;
+            parserEnd = range.end;
+            taken = true;
+        }
+
+        if (taken) {
+            if (oldestTime != 0 && ctx->metrics)
+                ctx->metrics->emitParserReadLagUs(ctx->clock->getTimeUt() - oldestTime);
+
+            if (readerWaiting) {
+                std::unique_lock<std::mutex> lck(mtx);
+                condBufferFull.notify_all();
+            }
+        }
+        return parserEnd;
+    }
+
     uint64_t Reader::getRet() const {
         return ret;
     }
@@ -1028,6 +1217,10 @@ namespace OpenLogReplicator {
         return activation;
     }
 
+    uint16_t Reader::getThread() const {
+        return thread;
+    }
+
     uint64_t Reader::getSumRead() const {
         return statistic.sumRead;
     }
@@ -1043,6 +1236,49 @@ namespace OpenLogReplicator {
     void Reader::setBufferStartEnd(uint64_t newBufferStart, uint64_t newBufferEnd) {
         bufferStart = newBufferStart;
         bufferEnd = newBufferEnd;
+        // The reader is not running, ranges of the previous file are dropped
+        ring.clear();
+        parserEnd = newBufferEnd;
+    }
+
+    bool Reader::isBufferFull() const {
+        // The next chunk to read would overwrite the chunk still used by the parser
+        return bufferEnd / Ctx::MEMORY_CHUNK_SIZE >= bufferStart / Ctx::MEMORY_CHUNK_SIZE + bufferSizeMax / Ctx::MEMORY_CHUNK_SIZE;
+    }
+
+    void Reader::dataPublish(uint64_t newBufferEnd) {
+        bufferEnd = newBufferEnd;
+        time_ut publishTime = 0;
+        if (ctx->metrics)
+            publishTime = ctx->clock->getTimeUt();
+
+        for (uint64_t spin = 0; !ring.push(newBufferEnd, publishTime); ++spin) {
+            if (ctx->softShutdown)
+                return;
+
+            if (spin < ReaderRing::SPIN_MAX) {
+                ReaderRing::relax();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lck(mtx);
+            readerWaiting = true;
+            if (!ctx->softShutdown && ring.full()) {
+                if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
+                    ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "Reader:dataPublish");
+                condBufferFull.wait(lck);
+            }
+            readerWaiting = false;
+        }
+
+        if (parserWaiting) {
+            std::unique_lock<std::mutex> lck(mtx);
+            condParserSleeping.notify_all();
+        }
+    }
+
+    void Reader::setBufferSizeMax(uint64_t newBufferSizeMax) {
+        bufferSizeMax = newBufferSizeMax;
     }
 
     bool Reader::checkRedoLog() {
@@ -1102,26 +1338,39 @@ namespace OpenLogReplicator {
     }
 
     void Reader::confirmReadData(uint64_t confirmedBufferStart) {
-        std::unique_lock<std::mutex> lck(mtx);
         bufferStart = confirmedBufferStart;
-        if (status == STATUS_READ) {
+        if (readerWaiting) {
+            std::unique_lock<std::mutex> lck(mtx);
             condBufferFull.notify_all();
         }
     }
 
     bool Reader::checkFinished(uint64_t confirmedBufferStart) {
-        std::unique_lock<std::mutex> lck(mtx);
-        if (bufferStart < confirmedBufferStart)
-            bufferStart = confirmedBufferStart;
+        // The parser confirms the read data itself, it may still hold some of the buffer
+        for (uint64_t spin = 0; spin < ReaderRing::SPIN_MAX; ++spin) {
+            // The state is read before the data, the reader publishes all data before it finishes
+            uint64_t currentRet = ret;
+            uint64_t currentStatus = status;
+            if (confirmedBufferStart < getDataEnd())
+                return false;
 
-        // All work done
-        if (confirmedBufferStart == bufferEnd) {
-            if (ret == REDO_STOPPED || ret == REDO_OVERWRITTEN || ret == REDO_FINISHED || status == STATUS_SLEEPING)
+            // All work done
+            if (currentRet == REDO_STOPPED || currentRet == REDO_OVERWRITTEN || currentRet == REDO_FINISHED || currentStatus == STATUS_SLEEPING)
                 return true;
+            if (ctx->softShutdown)
+                return false;
+            ReaderRing::relax();
+        }
+
+        std::unique_lock<std::mutex> lck(mtx);
+        parserWaiting = true;
+        if (confirmedBufferStart == getDataEnd() && ret != REDO_STOPPED && ret != REDO_OVERWRITTEN && ret != REDO_FINISHED &&
+            status != STATUS_SLEEPING && !ctx->softShutdown) {
             if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
                 ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "Reader:checkFinished");
             condParserSleeping.wait(lck);
         }
+        parserWaiting = false;
         return false;
     }
 }
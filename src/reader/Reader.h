@@ -23,11 +23,15 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #include "../common/Thread.h"
 #include "../common/types.h"
 #include "../common/typeTime.h"
+#include "BlockChSum.h"
+#include "ReaderRing.h"
 
 #ifndef READER_H_
 #define READER_H_
 
 namespace OpenLogReplicator {
+    class ArchivePrefetcher;
+    class RedoCopier;
 
     struct ReaderStat {
         uint64_t sumRead = 0;
@@ -49,10 +53,11 @@ namespace OpenLogReplicator {
         static constexpr uint64_t STATUS_READ = 3;
 
         static constexpr uint64_t PAGE_SIZE_MAX = 4096;
+        static constexpr uint64_t VERIFY_SECTOR_SIZE = 512;
         static constexpr uint64_t BAD_CDC_MAX_CNT = 20;
 
         std::string database;
-        int fileCopyDescriptor;
+        RedoCopier* redoCopier;
         uint64_t fileSize;
         typeSeq fileCopySequence;
         bool hintDisplayed;
@@ -65,7 +70,9 @@ namespace OpenLogReplicator {
         typeBlk numBlocksHeader;
         typeResetlogs resetlogs;
         typeActivation activation;
+        uint16_t thread;
         uint8_t* headerBuffer;
+        uint8_t* verifyBuffer;
         uint32_t compatVsn;
         typeTime firstTimeHeader;
         typeScn firstScn;
@@ -74,7 +81,9 @@ namespace OpenLogReplicator {
         typeScn nextScnHeader;
         typeTime nextTime;
         uint64_t blockSize;
+        uint64_t bufferSizeMax;
         ReaderStat statistic;
+        uint64_t chSumBitmap[BlockChSum::BITMAP_SIZE];
         uint64_t bufferScan;
         uint64_t lastRead;
         time_ut lastReadTime;
@@ -89,20 +98,38 @@ namespace OpenLogReplicator {
         std::condition_variable condBufferFull;
         std::condition_variable condReaderSleeping;
         std::condition_variable condParserSleeping;
+        std::condition_variable condBufferCopied;
+        // Data hand-off to the parser, the condition variables are used only after spinning
+        ReaderRing ring;
+        uint64_t parserEnd;
+        std::atomic<bool> parserWaiting;
+        std::atomic<bool> readerWaiting;
+        // Number of copy requests not yet written for every buffer
+        std::vector<uint64_t> copyPending;
+        std::vector<bool> copyFreeDeferred;
 
         virtual void redoClose() = 0;
         virtual uint64_t redoOpen() = 0;
         virtual int64_t redoRead(uint8_t* buf, uint64_t size, uint64_t offset = 0) = 0;
+        virtual void redoDrain();
         virtual uint64_t readSize(uint64_t lastRead);
         virtual uint64_t reloadHeaderRead();
+        virtual uint64_t redoReadHeaders(uint8_t* buf, uint64_t offset, uint64_t blocks, uint64_t& bytes);
         /// @brief Check the correctness of readed block 
         /// @param buffer pointer to memory with block 
         /// @param blockNumber number of checking block
         /// @param showHint show result of check sum
+        /// @param chSumValid check sum already verified by BlockChSum::check
         /// @return Status: REDO_OK, REDO_EMPTY, REDO_ERROR_BAD_DATA, REDO_ERROR_SEQUENCE, REDO_OVERWRITTEN, REDO_ERROR_BLOCK, REDO_ERROR_CRC
-        uint64_t checkBlockHeader(uint8_t* buffer, typeBlk blockNumber, bool showHint);
+        uint64_t checkBlockHeader(uint8_t* buffer, typeBlk blockNumber, bool showHint, bool chSumValid = false);
         uint64_t reloadHeader();
         void closeCopyDescriptor();
+        bool bufferCopy(uint64_t num, uint64_t pos, uint64_t size, uint64_t offset);
+        bool bufferCopyHold(uint64_t num);
+        void bufferCopyWait(uint64_t num);
+        uint64_t verifyHeaders(uint8_t* buffer, uint64_t blocks, uint64_t offset);
+        [[nodiscard]] bool isBufferFull() const;
+        void dataPublish(uint64_t newBufferEnd);
         bool read1();
         bool read2();
         void mainLoop();
@@ -124,6 +151,7 @@ namespace OpenLogReplicator {
 
         const static char* REDO_CODE[13];
         uint8_t** redoBufferList;
+        ArchivePrefetcher* archPrefetcher;
         std::vector<std::string> paths;
         std::string fileName;
 
@@ -133,13 +161,16 @@ namespace OpenLogReplicator {
         void initialize();
         void wakeUp() override;
         void run() override;
-        void bufferAllocate(uint64_t num);
-        void bufferFree(uint64_t num);
+        virtual void bufferAllocate(uint64_t num);
+        virtual void bufferFree(uint64_t num);
+        void bufferCopyDone(uint64_t num);
+        [[nodiscard]] bool bufferPrefetched(uint64_t offset) const;
         typeSum calcChSum(uint8_t* buffer, uint64_t size) const;
         void printHeaderInfo(std::ostringstream& ss, const std::string& path) const;
         [[nodiscard]] uint64_t getBlockSize() const;
         [[nodiscard]] uint64_t getBufferStart() const;
         [[nodiscard]] uint64_t getBufferEnd() const;
+        [[nodiscard]] uint64_t getDataEnd();
         [[nodiscard]] uint64_t getRet() const;
         [[nodiscard]] typeScn getFirstScn() const;
         [[nodiscard]] typeScn getFirstScnHeader() const;
@@ -150,11 +181,13 @@ namespace OpenLogReplicator {
         [[nodiscard]] typeSeq getSequence() const;
         [[nodiscard]] typeResetlogs getResetlogs() const;
         [[nodiscard]] typeActivation getActivation() const;
+        [[nodiscard]] uint16_t getThread() const;
         [[nodiscard]] uint64_t getSumRead() const;
         [[nodiscard]] uint64_t getSumTime() const;
 
         void setRet(uint64_t newRet);
         void setBufferStartEnd(uint64_t newBufferStart, uint64_t newBufferEnd);
+        void setBufferSizeMax(uint64_t newBufferSizeMax);
         bool checkRedoLog();
         bool updateRedoLog();
         void setStatusRead();
@@ -0,0 +1,120 @@
+/* Class reading compressed archived redo log files
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#define _LARGEFILE_SOURCE
+#define _FILE_OFFSET_BITS 64
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../common/Clock.h"
+#include "../common/Ctx.h"
+#include "Decompressor.h"
+#include "ReaderCompressed.h"
+
+namespace OpenLogReplicator {
+    ReaderCompressed::ReaderCompressed(Ctx* newCtx, const std::string& newAlias, const std::string& newDatabase, int64_t newGroup,
+                                       bool newConfiguredBlockSum) :
+            ReaderFilesystem(newCtx, newAlias, newDatabase, newGroup, newConfiguredBlockSum),
+            decompressor(nullptr),
+            compression(Decompressor::TYPE_NONE) {
+    }
+
+    ReaderCompressed::~ReaderCompressed() {
+        ReaderCompressed::redoClose();
+
+        if (decompressor != nullptr) {
+            decompressor->finish();
+            ctx->finishThread(decompressor);
+            delete decompressor;
+            decompressor = nullptr;
+        }
+    }
+
+    void ReaderCompressed::redoClose() {
+        if (compression != Decompressor::TYPE_NONE) {
+            decompressor->stop();
+            compression = Decompressor::TYPE_NONE;
+        }
+
+        ReaderFilesystem::redoClose();
+    }
+
+    uint64_t ReaderCompressed::redoOpen() {
+        uint64_t type = Decompressor::getType(fileName);
+        if (type == Decompressor::TYPE_NONE)
+            return ReaderFilesystem::redoOpen();
+
+        // Compressed data is read sequentially through the page cache, direct IO brings no benefit here
+        flags = O_RDONLY;
+        fileDescriptor = open(fileName.c_str(), flags);
+        if (fileDescriptor == -1) {
+            ctx->OLR_ERROR(10001, "file: " + fileName + " - open for read returned: " + strerror(errno));
+            return REDO_ERROR;
+        }
+
+#if __linux__
+        posix_fadvise(fileDescriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+        if (decompressor == nullptr) {
+            decompressor = new Decompressor(ctx, alias + "-decompressor");
+            ctx->spawnThread(decompressor);
+        }
+
+        compression = type;
+        decompressor->start(fileDescriptor, compression, fileName);
+        fileSize = FILE_SIZE_UNKNOWN;
+        return REDO_OK;
+    }
+
+    int64_t ReaderCompressed::redoRead(uint8_t* buf, uint64_t size, uint64_t offset) {
+        if (compression == Decompressor::TYPE_NONE)
+            return ReaderFilesystem::redoRead(buf, size, offset);
+
+        uint64_t startTime = 0;
+        if (unlikely(ctx->trace & Ctx::TRACE_PERFORMANCE))
+            startTime = ctx->clock->getTimeUt();
+
+        int64_t bytes = decompressor->read(buf, size, offset);
+        if (unlikely(ctx->trace & Ctx::TRACE_FILE))
+            ctx->OLR_TRACE(Ctx::TRACE_FILE, "read " + fileName + ", " + std::to_string(offset) + ", " + std::to_string(size) +
+                                           " returns " + std::to_string(bytes) + " (decompressed)");
+
+        if (bytes < 0)
+            ctx->OLR_ERROR(10075, "file: " + fileName + " - decompression failed: " + decompressor->getError());
+
+        uint64_t totalSize;
+        if (decompressor->isEof(totalSize)) {
+            totalSize &= ~(Ctx::MEMORY_ALIGNMENT - 1);
+            if (totalSize < fileSize)
+                fileSize = totalSize;
+        }
+
+        if (unlikely(ctx->trace & Ctx::TRACE_PERFORMANCE)) {
+            if (bytes > 0)
+                statistic.sumRead += bytes;
+            statistic.sumTime += ctx->clock->getTimeUt() - startTime;
+        }
+
+        return bytes;
+    }
+}
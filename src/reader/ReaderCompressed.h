@@ -0,0 +1,46 @@
+/* Header for ReaderCompressed class
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include "ReaderFilesystem.h"
+
+#ifndef READER_COMPRESSED_H_
+#define READER_COMPRESSED_H_
+
+namespace OpenLogReplicator {
+    class Decompressor;
+
+    class ReaderCompressed final : public ReaderFilesystem {
+    protected:
+        // Real size is known only after the whole file is decompressed, until then limited by the size from the header
+        static constexpr uint64_t FILE_SIZE_UNKNOWN = 0xFFFFFFFFFFFFF000;
+
+        Decompressor* decompressor;
+        uint64_t compression;
+
+        void redoClose() override;
+        uint64_t redoOpen() override;
+        int64_t redoRead(uint8_t* buf, uint64_t size, uint64_t offset = 0) override;
+
+    public:
+        ReaderCompressed(Ctx* newCtx, const std::string& newAlias, const std::string& newDatabase, int64_t newGroup, bool newConfiguredBlockSum);
+        ~ReaderCompressed() override;
+    };
+}
+
+#endif
@@ -24,10 +24,12 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #include <cstring>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "../common/Clock.h"
 #include "../common/Ctx.h"
+#include "ArchivePrefetcher.h"
 #include "ReaderFilesystem.h"
 
 namespace OpenLogReplicator {
@@ -92,6 +94,11 @@ namespace OpenLogReplicator {
         int64_t bytes = 0;
         uint64_t tries = ctx->archReadTries;
 
+        if (archPrefetcher != nullptr && group == 0 && archPrefetcher->copy(fileName, fileSize, buf, size, offset)) {
+            bytes = static_cast<int64_t>(size);
+            tries = 0;
+        }
+
         while (tries > 0) {
             if (ctx->hardShutdown)
                 break;
@@ -131,4 +138,49 @@ namespace OpenLogReplicator {
 
         return bytes;
     }
+    uint64_t ReaderFilesystem::redoReadHeaders(uint8_t* buf, uint64_t offset, uint64_t blocks, uint64_t& bytes) {
+        // The sectors are not adjacent, so the range is read with one vectored call: the first sector of every block goes to the
+        // verification buffer, the rest of the block is dropped to the scratch page behind it
+        uint8_t* scratch = verifyBuffer + Ctx::MEMORY_CHUNK_SIZE / 2;
+        iovec iov[VERIFY_IOVECS_MAX];
+        uint64_t numBlock = 0;
+
+        while (numBlock < blocks) {
+            uint64_t startTime = 0;
+            if (unlikely(ctx->trace & Ctx::TRACE_PERFORMANCE))
+                startTime = ctx->clock->getTimeUt();
+
+            uint64_t batch = std::min(blocks - numBlock, VERIFY_IOVECS_MAX / 2);
+            for (uint64_t index = 0; index < batch; ++index) {
+                iov[index * 2].iov_base = buf + (numBlock + index) * VERIFY_SECTOR_SIZE;
+                iov[index * 2].iov_len = VERIFY_SECTOR_SIZE;
+                iov[index * 2 + 1].iov_base = scratch;
+                iov[index * 2 + 1].iov_len = blockSize - VERIFY_SECTOR_SIZE;
+            }
+
+            int64_t actualRead;
+            do {
+                actualRead = preadv(fileDescriptor, iov, static_cast<int>(batch * 2), static_cast<off_t>(offset + numBlock * blockSize));
+            } while (actualRead < 0 && errno == EINTR);
+            if (unlikely(ctx->trace & Ctx::TRACE_FILE))
+                ctx->OLR_TRACE(Ctx::TRACE_FILE, "read headers " + fileName + ", " + std::to_string(offset + numBlock * blockSize) + ", " +
+                                               std::to_string(batch) + " blocks returns " + std::to_string(actualRead));
+
+            if (unlikely(ctx->trace & Ctx::TRACE_PERFORMANCE)) {
+                if (actualRead > 0)
+                    statistic.sumRead += actualRead;
+                statistic.sumTime += ctx->clock->getTimeUt() - startTime;
+            }
+
+            // A failed or short read leaves the rest of the blocks for the full read
+            if (actualRead <= 0)
+                break;
+            bytes += actualRead;
+            numBlock += static_cast<uint64_t>(actualRead) / blockSize;
+            if (static_cast<uint64_t>(actualRead) < batch * blockSize)
+                break;
+        }
+
+        return numBlock;
+    }
 }
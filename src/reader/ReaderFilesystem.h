@@ -23,13 +23,16 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #define READER_FILESYSTEM_H_
 
 namespace OpenLogReplicator {
-    class ReaderFilesystem final : public Reader {
+    class ReaderFilesystem : public Reader {
     protected:
+        static constexpr uint64_t VERIFY_IOVECS_MAX = 1024;
+
         int fileDescriptor;
         int flags;
         void redoClose() override;
         uint64_t redoOpen() override;
         int64_t redoRead(uint8_t* buf, uint64_t size, uint64_t offset = 0) override;
+        uint64_t redoReadHeaders(uint8_t* buf, uint64_t offset, uint64_t blocks, uint64_t& bytes) override;
 
     public:
         ReaderFilesystem(Ctx* newCtx, const std::string& newAlias, const std::string& newDatabase, int64_t newGroup, bool newConfiguredBlockSum);
@@ -0,0 +1,144 @@
+/* Class reading archived redo logs using memory mapped files
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#define _LARGEFILE_SOURCE
+#define _FILE_OFFSET_BITS 64
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+
+#include "../common/Clock.h"
+#include "../common/Ctx.h"
+#include "ReaderMmap.h"
+
+namespace OpenLogReplicator {
+    ReaderMmap::ReaderMmap(Ctx* newCtx, const std::string& newAlias, const std::string& newDatabase, int64_t newGroup, bool newConfiguredBlockSum) :
+            ReaderFilesystem(newCtx, newAlias, newDatabase, newGroup, newConfiguredBlockSum),
+            mapAddress(nullptr),
+            mapSize(0) {
+    }
+
+    ReaderMmap::~ReaderMmap() {
+        ReaderMmap::redoClose();
+    }
+
+    void ReaderMmap::redoClose() {
+        if (mapAddress != nullptr) {
+            // Buffers point to the mapping which is going away
+            if (redoBufferList != nullptr) {
+                for (uint64_t num = 0; num < ctx->readBufferMax; ++num)
+                    if (redoBufferList[num] >= mapAddress && redoBufferList[num] < mapAddress + mapSize)
+                        redoBufferList[num] = nullptr;
+            }
+
+            munmap(mapAddress, mapSize);
+            mapAddress = nullptr;
+            mapSize = 0;
+        }
+        ReaderFilesystem::redoClose();
+    }
+
+    uint64_t ReaderMmap::redoOpen() {
+        uint64_t currentRet = ReaderFilesystem::redoOpen();
+        if (currentRet != REDO_OK || group != 0 || fileSize == 0)
+            return currentRet;
+
+        // Private mapping, the file is never modified even if the buffer is
+        void* address = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0);
+        if (address == MAP_FAILED) {
+            ctx->OLR_ERROR(10074, "file: " + fileName + " - mmap returned: " + strerror(errno));
+            ReaderFilesystem::redoClose();
+            return REDO_ERROR;
+        }
+
+        mapAddress = reinterpret_cast<uint8_t*>(address);
+        mapSize = fileSize;
+        madvise(mapAddress, mapSize, MADV_SEQUENTIAL);
+        return REDO_OK;
+    }
+
+    int64_t ReaderMmap::redoRead(uint8_t* buf, uint64_t size, uint64_t offset) {
+        if (mapAddress == nullptr)
+            return ReaderFilesystem::redoRead(buf, size, offset);
+
+        uint64_t startTime = 0;
+        if (unlikely(ctx->trace & Ctx::TRACE_PERFORMANCE))
+            startTime = ctx->clock->getTimeUt();
+
+        if (offset >= mapSize)
+            return 0;
+        if (size > mapSize - offset)
+            size = mapSize - offset;
+
+        // Buffers allocated by bufferAllocate() already point to the data, only the header is copied
+        if (buf != mapAddress + offset)
+            memcpy(reinterpret_cast<void*>(buf), reinterpret_cast<const void*>(mapAddress + offset), size);
+
+        if (unlikely(ctx->trace & Ctx::TRACE_FILE))
+            ctx->OLR_TRACE(Ctx::TRACE_FILE, "read " + fileName + ", " + std::to_string(offset) + ", " + std::to_string(size) +
+                                           " returns " + std::to_string(size) + " (mapped)");
+
+        if (unlikely(ctx->trace & Ctx::TRACE_PERFORMANCE)) {
+            statistic.sumRead += size;
+            statistic.sumTime += ctx->clock->getTimeUt() - startTime;
+        }
+
+        return static_cast<int64_t>(size);
+    }
+
+    uint64_t ReaderMmap::readSize(uint64_t prevRead) {
+        // Archived redo log is complete, check whole chunks
+        if (mapAddress != nullptr)
+            return Ctx::MEMORY_CHUNK_SIZE;
+
+        return Reader::readSize(prevRead);
+    }
+
+    void ReaderMmap::bufferAllocate(uint64_t num) {
+        if (mapAddress == nullptr) {
+            Reader::bufferAllocate(num);
+            return;
+        }
+
+        // Called by read1() for the chunk at the scan position
+        bufferCopyWait(num);
+        if (redoBufferList[num] == nullptr) {
+            uint64_t offset = (bufferScan / Ctx::MEMORY_CHUNK_SIZE) * Ctx::MEMORY_CHUNK_SIZE;
+            redoBufferList[num] = mapAddress + offset;
+            madvise(mapAddress + offset, std::min(Ctx::MEMORY_CHUNK_SIZE, mapSize - offset), MADV_WILLNEED);
+        }
+    }
+
+    void ReaderMmap::bufferFree(uint64_t num) {
+        if (redoBufferList[num] == nullptr || bufferCopyHold(num))
+            return;
+
+        if (mapAddress == nullptr || redoBufferList[num] < mapAddress || redoBufferList[num] >= mapAddress + mapSize) {
+            Reader::bufferFree(num);
+            return;
+        }
+
+        // The pages are not needed any more, release them from the process
+        uint64_t offset = redoBufferList[num] - mapAddress;
+        madvise(redoBufferList[num], std::min(Ctx::MEMORY_CHUNK_SIZE, mapSize - offset), MADV_DONTNEED);
+        redoBufferList[num] = nullptr;
+    }
+}
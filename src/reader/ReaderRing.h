@@ -0,0 +1,99 @@
+/* Header for ReaderRing class
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <atomic>
+
+#include "../common/types.h"
+
+#ifndef READER_RING_H_
+#define READER_RING_H_
+
+namespace OpenLogReplicator {
+    struct ReaderRange {
+        uint64_t end;
+        time_ut time;
+    };
+
+    /*
+        Ring of validated block ranges passed from the reader thread to the parser thread.
+        Safe only for one producer and one consumer.
+    */
+    class ReaderRing final {
+    public:
+        static constexpr uint64_t SIZE = 1024;
+        static constexpr uint64_t SPIN_MAX = 4096;
+
+    protected:
+        ReaderRange ranges[SIZE];
+        alignas(64) std::atomic<uint64_t> head;
+        alignas(64) std::atomic<uint64_t> tail;
+
+    public:
+        ReaderRing() :
+                head(0),
+                tail(0) {
+        }
+
+        static void relax() {
+#if defined(__x86_64__) && defined(__GNUC__)
+            __builtin_ia32_pause();
+#elif defined(__aarch64__) && defined(__GNUC__)
+            asm volatile("yield");
+#endif
+        }
+
+        // Producer side
+        bool push(uint64_t end, time_ut time) {
+            uint64_t currentHead = head.load(std::memory_order_relaxed);
+            if (currentHead - tail.load(std::memory_order_acquire) == SIZE)
+                return false;
+
+            ranges[currentHead % SIZE].end = end;
+            ranges[currentHead % SIZE].time = time;
+            head.store(currentHead + 1);
+            return true;
+        }
+
+        // Consumer side
+        bool pop(ReaderRange& range) {
+            uint64_t currentTail = tail.load(std::memory_order_relaxed);
+            if (currentTail == head.load())
+                return false;
+
+            range = ranges[currentTail % SIZE];
+            tail.store(currentTail + 1);
+            return true;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return tail.load() == head.load();
+        }
+
+        [[nodiscard]] bool full() const {
+            return head.load() - tail.load() == SIZE;
+        }
+
+        // Consumer side, only when the producer is idle
+        void clear() {
+            tail.store(head.load());
+        }
+    };
+}
+
+#endif
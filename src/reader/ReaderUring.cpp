@@ -0,0 +1,469 @@
+/* Class for reading redo from file system using io_uring
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#define _LARGEFILE_SOURCE
+#define _FILE_OFFSET_BITS 64
+
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "../common/Clock.h"
+#include "../common/Ctx.h"
+#include "../common/exception/RuntimeException.h"
+#include "../common/metrics/Metrics.h"
+#include "ArchivePrefetcher.h"
+#include "ReaderUring.h"
+
+namespace OpenLogReplicator {
+    ReaderUring::ReaderUring(Ctx* newCtx, const std::string& newAlias, const std::string& newDatabase, int64_t newGroup, bool newConfiguredBlockSum,
+                             uint64_t newQueueDepth) :
+            ReaderFilesystem(newCtx, newAlias, newDatabase, newGroup, newConfiguredBlockSum),
+            ringDescriptor(-1),
+            queueDepth(newQueueDepth),
+            sqRing(nullptr),
+            sqRingSize(0),
+            cqRing(nullptr),
+            cqRingSize(0),
+            sqes(nullptr),
+            sqesSize(0),
+            sqHead(nullptr),
+            sqTail(nullptr),
+            sqMask(nullptr),
+            sqArray(nullptr),
+            cqHead(nullptr),
+            cqTail(nullptr),
+            cqMask(nullptr),
+            cqes(nullptr),
+            requestsInFlight(0),
+            requestsQueued(0),
+            prefetchOffset(0),
+            speedBytes(0),
+            speedTime(0) {
+        if (queueDepth < 1)
+            queueDepth = 1;
+        if (queueDepth > QUEUE_DEPTH_MAX)
+            queueDepth = QUEUE_DEPTH_MAX;
+
+        // The last request is reserved for synchronous reads
+        requests.resize(queueDepth + 1);
+        for (UringRequest& request: requests)
+            request = {nullptr, 0, 0, 0, false, false};
+    }
+
+    ReaderUring::~ReaderUring() {
+        ReaderUring::redoClose();
+        ringTeardown();
+    }
+
+    void ReaderUring::ringSetup() {
+        io_uring_params params;
+        memset(reinterpret_cast<void*>(&params), 0, sizeof(params));
+
+        ringDescriptor = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(queueDepth + 1), &params));
+        if (ringDescriptor < 0)
+            throw RuntimeException(10072, "io_uring setup for " + std::to_string(queueDepth + 1) + " entries returned: " + strerror(errno));
+
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+            if (cqRingSize > sqRingSize)
+                sqRingSize = cqRingSize;
+            cqRingSize = 0;
+        }
+
+        void* ptr = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringDescriptor, IORING_OFF_SQ_RING);
+        if (ptr == MAP_FAILED)
+            throw RuntimeException(10072, "io_uring map of submission queue returned: " + std::string(strerror(errno)));
+        sqRing = reinterpret_cast<uint8_t*>(ptr);
+
+        if (cqRingSize > 0) {
+            ptr = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringDescriptor, IORING_OFF_CQ_RING);
+            if (ptr == MAP_FAILED)
+                throw RuntimeException(10072, "io_uring map of completion queue returned: " + std::string(strerror(errno)));
+            cqRing = reinterpret_cast<uint8_t*>(ptr);
+        } else
+            cqRing = sqRing;
+
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        ptr = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringDescriptor, IORING_OFF_SQES);
+        if (ptr == MAP_FAILED)
+            throw RuntimeException(10072, "io_uring map of submission entries returned: " + std::string(strerror(errno)));
+        sqes = reinterpret_cast<io_uring_sqe*>(ptr);
+
+        sqHead = reinterpret_cast<uint32_t*>(sqRing + params.sq_off.head);
+        sqTail = reinterpret_cast<uint32_t*>(sqRing + params.sq_off.tail);
+        sqMask = reinterpret_cast<uint32_t*>(sqRing + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<uint32_t*>(sqRing + params.sq_off.array);
+        cqHead = reinterpret_cast<uint32_t*>(cqRing + params.cq_off.head);
+        cqTail = reinterpret_cast<uint32_t*>(cqRing + params.cq_off.tail);
+        cqMask = reinterpret_cast<uint32_t*>(cqRing + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cqRing + params.cq_off.cqes);
+
+        if (unlikely(ctx->trace & Ctx::TRACE_FILE))
+            ctx->OLR_TRACE(Ctx::TRACE_FILE, "io_uring initialized with " + std::to_string(params.sq_entries) + " entries");
+    }
+
+    void ReaderUring::ringTeardown() {
+        if (sqes != nullptr) {
+            munmap(sqes, sqesSize);
+            sqes = nullptr;
+        }
+
+        if (cqRing != nullptr && cqRing != sqRing)
+            munmap(cqRing, cqRingSize);
+        cqRing = nullptr;
+
+        if (sqRing != nullptr) {
+            munmap(sqRing, sqRingSize);
+            sqRing = nullptr;
+        }
+
+        if (ringDescriptor != -1) {
+            close(ringDescriptor);
+            ringDescriptor = -1;
+        }
+        requestsQueued = 0;
+    }
+
+    bool ReaderUring::ringQueue(uint64_t index) {
+        UringRequest& request = requests[index];
+        uint32_t tail = *sqTail;
+        uint32_t head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+        if (tail - head > *sqMask)
+            return false;
+
+        uint32_t slot = tail & *sqMask;
+        io_uring_sqe* sqe = sqes + slot;
+        memset(reinterpret_cast<void*>(sqe), 0, sizeof(io_uring_sqe));
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = fileDescriptor;
+        sqe->addr = reinterpret_cast<uintptr_t>(request.buffer);
+        sqe->len = static_cast<uint32_t>(request.size);
+        sqe->off = request.offset;
+        sqe->user_data = index;
+        sqArray[slot] = slot;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+
+        request.inFlight = true;
+        request.done = false;
+        ++requestsInFlight;
+        ++requestsQueued;
+        return true;
+    }
+
+    void ReaderUring::ringEnter(uint64_t minComplete) {
+        // All queued entries are submitted with one system call which also waits for the completions
+        uint32_t enterFlags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0U;
+        while (requestsQueued > 0 || minComplete > 0) {
+            int64_t entered;
+            do {
+                entered = syscall(__NR_io_uring_enter, ringDescriptor, static_cast<unsigned>(requestsQueued), static_cast<unsigned>(minComplete),
+                                  enterFlags, nullptr, 0);
+            } while (entered < 0 && errno == EINTR);
+
+            if (entered < 0)
+                throw RuntimeException(10073, "file: " + fileName + " - io_uring submit returned: " + strerror(errno));
+            if (entered == 0 && requestsQueued > 0)
+                throw RuntimeException(10073, "file: " + fileName + " - io_uring submitted no entries of " + std::to_string(requestsQueued));
+
+            requestsQueued -= std::min(requestsQueued, static_cast<uint64_t>(entered));
+            minComplete = 0;
+            enterFlags = 0U;
+        }
+    }
+
+    void ReaderUring::ringReap(bool wait) {
+        uint32_t head = *cqHead;
+        uint32_t tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+
+        // Entries still queued are submitted in the same call which waits for the completion
+        if (requestsQueued > 0 || (head == tail && wait)) {
+            ringEnter(head == tail && wait ? 1 : 0);
+            tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        }
+
+        while (head != tail) {
+            const io_uring_cqe* cqe = cqes + (head & *cqMask);
+            UringRequest& request = requests[cqe->user_data];
+            request.result = cqe->res;
+            request.inFlight = false;
+            request.done = true;
+            --requestsInFlight;
+            ++head;
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+    }
+
+    int64_t ReaderUring::ringReadSync(uint8_t* buf, uint64_t size, uint64_t offset) {
+        UringRequest& request = requests[queueDepth];
+        int64_t bytes = 0;
+        uint64_t tries = ctx->archReadTries;
+
+        while (tries > 0) {
+            if (ctx->hardShutdown)
+                break;
+
+            request = {buf, size, offset, 0, false, false};
+            if (!ringQueue(queueDepth)) {
+                errno = EBUSY;
+                bytes = -1;
+                break;
+            }
+            while (!request.done)
+                ringReap(true);
+            request.done = false;
+
+            bytes = request.result;
+            if (bytes < 0) {
+                errno = static_cast<int>(-bytes);
+                bytes = -1;
+            }
+            if (unlikely(ctx->trace & Ctx::TRACE_FILE))
+                ctx->OLR_TRACE(Ctx::TRACE_FILE, "read " + fileName + ", " + std::to_string(offset) + ", " + std::to_string(size) +
+                                               " returns " + std::to_string(bytes));
+
+            if (bytes > 0)
+                break;
+
+            // Retry for SSHFS broken connection: Transport endpoint is not isConnected
+            if (bytes == -1 && errno != ENOTCONN)
+                break;
+
+            ctx->OLR_ERROR(10005, "file: " + fileName + " - " + std::to_string(bytes) + " bytes read instead of " + std::to_string(size));
+
+            if (ctx->hardShutdown)
+                break;
+
+            ctx->OLR_INFO(0, "sleeping " + std::to_string(ctx->archReadSleepUs) + " us before retrying read");
+            usleep(ctx->archReadSleepUs);
+            --tries;
+        }
+
+        return bytes;
+    }
+
+    void ReaderUring::prefetch(uint64_t offset) {
+        // Only archived redo log files are immutable, online redo log files are read just in time
+        if (group != 0 || ringDescriptor == -1)
+            return;
+
+        uint64_t endOffset = fileSize;
+        if (numBlocksHeader != Ctx::ZERO_BLK && static_cast<uint64_t>(numBlocksHeader) * blockSize < endOffset)
+            endOffset = static_cast<uint64_t>(numBlocksHeader) * blockSize;
+
+        if (prefetchOffset < offset)
+            prefetchOffset = offset;
+
+        for (uint64_t index = 0; index < queueDepth && prefetchOffset < endOffset; ++index) {
+            if (requests[index].inFlight || requests[index].done)
+                continue;
+
+            // Never touch the chunk which is still owned by the parser
+            if (prefetchOffset / Ctx::MEMORY_CHUNK_SIZE >= bufferStart / Ctx::MEMORY_CHUNK_SIZE + bufferSizeMax / Ctx::MEMORY_CHUNK_SIZE)
+                break;
+
+            // Already loaded by the archive prefetcher
+            if (archPrefetcher != nullptr && archPrefetcher->contains(fileName, fileSize, prefetchOffset))
+                break;
+
+            uint64_t redoBufferPos = prefetchOffset % Ctx::MEMORY_CHUNK_SIZE;
+            uint64_t redoBufferNum = (prefetchOffset / Ctx::MEMORY_CHUNK_SIZE) % ctx->readBufferMax;
+            uint64_t toRead = std::min(readSize(Ctx::MEMORY_CHUNK_SIZE), endOffset - prefetchOffset);
+            if (redoBufferPos + toRead > Ctx::MEMORY_CHUNK_SIZE)
+                toRead = Ctx::MEMORY_CHUNK_SIZE - redoBufferPos;
+
+            if (redoBufferList[redoBufferNum] == nullptr) {
+                if (ctx->buffersFree == 0)
+                    break;
+                bufferAllocate(redoBufferNum);
+            }
+
+            requests[index] = {redoBufferList[redoBufferNum] + redoBufferPos, toRead, prefetchOffset, 0, false, false};
+            if (!ringQueue(index))
+                break;
+
+            if (unlikely(ctx->trace & Ctx::TRACE_DISK))
+                ctx->OLR_TRACE(Ctx::TRACE_DISK, "prefetch " + fileName + " at " + std::to_string(prefetchOffset) + " bytes: " +
+                                               std::to_string(toRead) + " queued: " + std::to_string(requestsInFlight));
+            prefetchOffset += toRead;
+        }
+
+        // The whole queue is submitted with one system call
+        if (requestsQueued > 0)
+            ringEnter(0);
+    }
+
+    void ReaderUring::emitMetrics(int64_t bytes) {
+        if (ctx->metrics == nullptr)
+            return;
+
+        ctx->metrics->emitReadQueueDepth(static_cast<int64_t>(requestsInFlight));
+
+        if (bytes > 0)
+            speedBytes += bytes;
+        time_ut now = ctx->clock->getTimeUt();
+        if (speedTime == 0)
+            speedTime = now;
+        if (now - speedTime >= static_cast<time_ut>(SPEED_INTERVAL_US)) {
+            ctx->metrics->emitReadSpeedMb(static_cast<int64_t>(speedBytes * 1000000 / static_cast<uint64_t>(now - speedTime) / 1024 / 1024));
+            speedBytes = 0;
+            speedTime = now;
+        }
+    }
+
+    void ReaderUring::redoClose() {
+        if (ringDescriptor != -1)
+            redoDrain();
+        ReaderFilesystem::redoClose();
+    }
+
+    uint64_t ReaderUring::redoOpen() {
+        uint64_t currentRet = ReaderFilesystem::redoOpen();
+        if (currentRet != REDO_OK)
+            return currentRet;
+
+        if (ringDescriptor == -1) {
+            try {
+                ringSetup();
+            } catch (RuntimeException& ex) {
+                ctx->OLR_ERROR(ex.code, ex.msg);
+                ringTeardown();
+                return REDO_ERROR;
+            }
+        }
+
+        return REDO_OK;
+    }
+
+    int64_t ReaderUring::redoRead(uint8_t* buf, uint64_t size, uint64_t offset) {
+        uint64_t startTime = 0;
+        if (unlikely(ctx->trace & Ctx::TRACE_PERFORMANCE))
+            startTime = ctx->clock->getTimeUt();
+        int64_t bytes = -1;
+        bool served = false;
+
+        if (buf != headerBuffer) {
+            // The read might be already queued
+            for (uint64_t index = 0; index < queueDepth; ++index) {
+                UringRequest& request = requests[index];
+                if ((!request.inFlight && !request.done) || request.buffer != buf || request.offset != offset || request.size != size)
+                    continue;
+
+                while (!request.done)
+                    ringReap(true);
+                request.done = false;
+
+                bytes = request.result;
+                if (bytes > 0) {
+                    served = true;
+                    if (unlikely(ctx->trace & Ctx::TRACE_FILE))
+                        ctx->OLR_TRACE(Ctx::TRACE_FILE, "read " + fileName + ", " + std::to_string(offset) + ", " + std::to_string(size) +
+                                                       " returns " + std::to_string(bytes) + " (queued)");
+                }
+                break;
+            }
+
+            // Unexpected read position, the queued reads are worthless
+            if (!served)
+                redoDrain();
+        }
+
+        if (!served && archPrefetcher != nullptr && group == 0 && archPrefetcher->copy(fileName, fileSize, buf, size, offset)) {
+            bytes = static_cast<int64_t>(size);
+            served = true;
+        }
+
+        if (!served)
+            bytes = ringReadSync(buf, size, offset);
+
+        // Maybe direct IO does not work
+        if (bytes < 0 && !ctx->isFlagSet(Ctx::REDO_FLAGS_DIRECT_DISABLE)) {
+            ctx->hint("if problem is related to Direct IO, try to restart with Direct IO mode disabled, set 'flags' to value: " +
+                      std::to_string(Ctx::REDO_FLAGS_DIRECT_DISABLE));
+        }
+
+        if (bytes > 0 && buf != headerBuffer && static_cast<uint64_t>(bytes) == size)
+            prefetch(offset + size);
+
+        if (unlikely(ctx->trace & Ctx::TRACE_PERFORMANCE)) {
+            if (bytes > 0)
+                statistic.sumRead += bytes;
+            statistic.sumTime += ctx->clock->getTimeUt() - startTime;
+        }
+        emitMetrics(bytes);
+
+        return bytes;
+    }
+
+    uint64_t ReaderUring::redoReadHeaders(uint8_t* buf, uint64_t offset, uint64_t blocks, uint64_t& bytes) {
+        if (ringDescriptor == -1)
+            return ReaderFilesystem::redoReadHeaders(buf, offset, blocks, bytes);
+
+        redoDrain();
+        uint64_t numBlock = 0;
+        while (numBlock < blocks) {
+            // Queue a batch of sector reads, submit it and wait for all of them with one system call
+            uint64_t batch = 0;
+            for (; batch < queueDepth && numBlock + batch < blocks; ++batch) {
+                requests[batch] = {buf + (numBlock + batch) * VERIFY_SECTOR_SIZE, VERIFY_SECTOR_SIZE, offset + (numBlock + batch) * blockSize,
+                                   0, false, false};
+                if (!ringQueue(batch))
+                    break;
+            }
+            if (batch == 0)
+                break;
+            ringEnter(batch);
+            while (requestsInFlight > 0)
+                ringReap(true);
+
+            for (uint64_t index = 0; index < batch; ++index) {
+                requests[index].done = false;
+                if (requests[index].result != static_cast<int64_t>(VERIFY_SECTOR_SIZE)) {
+                    if (unlikely(ctx->trace & Ctx::TRACE_FILE))
+                        ctx->OLR_TRACE(Ctx::TRACE_FILE, "read " + fileName + ", " + std::to_string(requests[index].offset) + ", " +
+                                                       std::to_string(VERIFY_SECTOR_SIZE) + " returns " + std::to_string(requests[index].result));
+                    return numBlock + index;
+                }
+                bytes += VERIFY_SECTOR_SIZE;
+            }
+            numBlock += batch;
+        }
+        return numBlock;
+    }
+
+    void ReaderUring::redoDrain() {
+        while (requestsInFlight > 0)
+            ringReap(true);
+
+        for (uint64_t index = 0; index < queueDepth; ++index)
+            requests[index].done = false;
+        prefetchOffset = 0;
+    }
+
+    uint64_t ReaderUring::readSize(uint64_t prevRead) {
+        // Archived redo log is complete, read whole chunks
+        if (group == 0)
+            return Ctx::MEMORY_CHUNK_SIZE;
+
+        return Reader::readSize(prevRead);
+    }
+}
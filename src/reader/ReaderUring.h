@@ -0,0 +1,88 @@
+/* Header for ReaderUring class
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <linux/io_uring.h>
+#include <vector>
+
+#include "ReaderFilesystem.h"
+
+#ifndef READER_URING_H_
+#define READER_URING_H_
+
+namespace OpenLogReplicator {
+    struct UringRequest {
+        uint8_t* buffer;
+        uint64_t size;
+        uint64_t offset;
+        int64_t result;
+        bool inFlight;
+        bool done;
+    };
+
+    class ReaderUring final : public ReaderFilesystem {
+    protected:
+        static constexpr uint64_t QUEUE_DEPTH_MAX = 256;
+        static constexpr uint64_t SPEED_INTERVAL_US = 1000000;
+
+        int ringDescriptor;
+        uint64_t queueDepth;
+        uint8_t* sqRing;
+        uint64_t sqRingSize;
+        uint8_t* cqRing;
+        uint64_t cqRingSize;
+        io_uring_sqe* sqes;
+        uint64_t sqesSize;
+        uint32_t* sqHead;
+        uint32_t* sqTail;
+        uint32_t* sqMask;
+        uint32_t* sqArray;
+        uint32_t* cqHead;
+        uint32_t* cqTail;
+        uint32_t* cqMask;
+        io_uring_cqe* cqes;
+        std::vector<UringRequest> requests;
+        uint64_t requestsInFlight;
+        uint64_t requestsQueued;
+        uint64_t prefetchOffset;
+        uint64_t speedBytes;
+        time_ut speedTime;
+
+        void ringSetup();
+        void ringTeardown();
+        bool ringQueue(uint64_t index);
+        void ringEnter(uint64_t minComplete);
+        void ringReap(bool wait);
+        int64_t ringReadSync(uint8_t* buf, uint64_t size, uint64_t offset);
+        void prefetch(uint64_t offset);
+        void emitMetrics(int64_t bytes);
+        void redoClose() override;
+        uint64_t redoOpen() override;
+        int64_t redoRead(uint8_t* buf, uint64_t size, uint64_t offset = 0) override;
+        void redoDrain() override;
+        uint64_t redoReadHeaders(uint8_t* buf, uint64_t offset, uint64_t blocks, uint64_t& bytes) override;
+        uint64_t readSize(uint64_t prevRead) override;
+
+    public:
+        ReaderUring(Ctx* newCtx, const std::string& newAlias, const std::string& newDatabase, int64_t newGroup, bool newConfiguredBlockSum,
+                    uint64_t newQueueDepth);
+        ~ReaderUring() override;
+    };
+}
+
+#endif
@@ -0,0 +1,365 @@
+/* Thread writing copy of read redo log data
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#define _LARGEFILE_SOURCE
+#define _FILE_OFFSET_BITS 64
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <thread>
+#include <unistd.h>
+
+#include "../common/Ctx.h"
+#include "../common/exception/RuntimeException.h"
+#include "Reader.h"
+#include "RedoCopier.h"
+
+namespace OpenLogReplicator {
+    RedoCopier::RedoCopier(Ctx* newCtx, const std::string& newAlias, Reader* newReader) :
+            Thread(newCtx, newAlias),
+            reader(newReader),
+            headerSize(0),
+            headerDirty(false),
+            fileDescriptor(-1),
+            position(0),
+            writing(false),
+            failed(false),
+            stopped(false),
+            shutdown(false) {
+#ifdef LINK_ZLIB
+        gzFileCopy = nullptr;
+#endif /* LINK_ZLIB */
+    }
+
+    RedoCopier::~RedoCopier() {
+        fileClose();
+    }
+
+    bool RedoCopier::writeHeader(const uint8_t* data, uint64_t size) {
+#ifdef LINK_ZLIB
+        if (gzFileCopy != nullptr) {
+            // Compressed stream can't be rewritten, only the first version of the header is kept
+            if (position > 0)
+                return true;
+            return writeCompressed({data, size, 0, 0});
+        }
+#endif /* LINK_ZLIB */
+
+        int64_t bytesWritten = pwrite(fileDescriptor, data, size, 0);
+        if (bytesWritten != static_cast<int64_t>(size)) {
+            ctx->OLR_ERROR(10007, "file: " + fileName + " - " + std::to_string(bytesWritten) + " bytes written instead of " +
+                              std::to_string(size) + ", code returned: " + strerror(errno));
+            return false;
+        }
+        return true;
+    }
+
+    bool RedoCopier::writeBatch(const std::vector<RedoCopyRequest>& requests) {
+#ifdef LINK_ZLIB
+        if (gzFileCopy != nullptr) {
+            for (const RedoCopyRequest& request: requests)
+                if (!writeCompressed(request))
+                    return false;
+            return true;
+        }
+#endif /* LINK_ZLIB */
+
+        // Adjacent requests are written with one call
+        struct iovec iov[BATCH_MAX];
+        uint64_t index = 0;
+        while (index < requests.size()) {
+            uint64_t offset = requests[index].offset;
+            uint64_t size = 0;
+            uint64_t count = 0;
+            while (index < requests.size() && requests[index].offset == offset + size) {
+                iov[count].iov_base = const_cast<uint8_t*>(requests[index].data);
+                iov[count].iov_len = requests[index].size;
+                size += requests[index].size;
+                ++count;
+                ++index;
+            }
+
+            int64_t bytesWritten = pwritev(fileDescriptor, iov, static_cast<int>(count), static_cast<int64_t>(offset));
+            if (unlikely(ctx->trace & Ctx::TRACE_DISK))
+                ctx->OLR_TRACE(Ctx::TRACE_DISK, "copy " + fileName + " at " + std::to_string(offset) + " bytes: " + std::to_string(size) +
+                                               " in " + std::to_string(count) + " parts returns " + std::to_string(bytesWritten));
+            if (bytesWritten != static_cast<int64_t>(size)) {
+                ctx->OLR_ERROR(10007, "file: " + fileName + " - " + std::to_string(bytesWritten) + " bytes written instead of " +
+                                  std::to_string(size) + ", code returned: " + strerror(errno));
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool RedoCopier::writeCompressed(const RedoCopyRequest& request __attribute__((unused))) {
+#ifdef LINK_ZLIB
+        // Data already written is not written again, gap is filled with zeros
+        if (request.offset + request.size <= position)
+            return true;
+
+        uint64_t skip = 0;
+        if (request.offset < position) {
+            skip = position - request.offset;
+        } else if (request.offset > position) {
+            if (gzseek(gzFileCopy, static_cast<z_off_t>(request.offset), SEEK_SET) < 0) {
+                int code;
+                ctx->OLR_ERROR(10007, "file: " + fileName + " - seek to " + std::to_string(request.offset) + " returned: " +
+                                  gzerror(gzFileCopy, &code));
+                return false;
+            }
+            position = request.offset;
+        }
+
+        uint64_t size = request.size - skip;
+        int bytesWritten = gzwrite(gzFileCopy, request.data + skip, static_cast<unsigned>(size));
+        if (bytesWritten != static_cast<int>(size)) {
+            int code;
+            ctx->OLR_ERROR(10007, "file: " + fileName + " - " + std::to_string(bytesWritten) + " bytes written instead of " +
+                              std::to_string(size) + ", code returned: " + gzerror(gzFileCopy, &code));
+            return false;
+        }
+        position += size;
+        return true;
+#else
+        return false;
+#endif /* LINK_ZLIB */
+    }
+
+    bool RedoCopier::sync() {
+#ifdef LINK_ZLIB
+        if (gzFileCopy != nullptr && gzflush(gzFileCopy, Z_SYNC_FLUSH) != Z_OK) {
+            int code;
+            ctx->OLR_ERROR(10076, "file: " + fileName + " - sync returned: " + gzerror(gzFileCopy, &code));
+            return false;
+        }
+#endif /* LINK_ZLIB */
+
+        if (fdatasync(fileDescriptor) != 0) {
+            ctx->OLR_ERROR(10076, "file: " + fileName + " - sync returned: " + strerror(errno));
+            return false;
+        }
+        return true;
+    }
+
+    void RedoCopier::mainLoop() {
+        std::vector<RedoCopyRequest> requests;
+        requests.reserve(BATCH_MAX);
+
+        while (true) {
+            uint64_t writeHeaderSize = 0;
+            bool ok;
+            {
+                std::unique_lock<std::mutex> lck(mtx);
+                while (queue.empty() && !headerDirty && !shutdown && !ctx->softShutdown) {
+                    if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
+                        ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "RedoCopier:mainLoop");
+                    condLoop.wait(lck);
+                }
+                // Data already read is written also on shutdown
+                if (ctx->hardShutdown || ((shutdown || ctx->softShutdown) && queue.empty() && !headerDirty))
+                    break;
+
+                requests.clear();
+                while (!queue.empty() && requests.size() < BATCH_MAX) {
+                    requests.push_back(queue.front());
+                    queue.pop_front();
+                }
+
+                if (headerDirty) {
+                    memcpy(reinterpret_cast<void*>(headerWrite), reinterpret_cast<const void*>(header), headerSize);
+                    writeHeaderSize = headerSize;
+                    headerDirty = false;
+                }
+
+                ok = !failed && fileDescriptor != -1;
+                writing = true;
+            }
+
+            if (ok && writeHeaderSize > 0)
+                ok = writeHeader(headerWrite, writeHeaderSize);
+            if (ok && !requests.empty())
+                ok = writeBatch(requests);
+            if (ok && ctx->redoCopyFsync == Ctx::REDO_COPY_FSYNC_BATCH)
+                ok = sync();
+
+            // The reader buffers are not referenced any more
+            for (const RedoCopyRequest& request: requests)
+                reader->bufferCopyDone(request.num);
+
+            std::unique_lock<std::mutex> lck(mtx);
+            writing = false;
+            if (!ok)
+                failed = true;
+            condDone.notify_all();
+        }
+    }
+
+    bool RedoCopier::isOpen() {
+        std::unique_lock<std::mutex> lck(mtx);
+        return fileDescriptor != -1;
+    }
+
+    void RedoCopier::fileOpen(const std::string& newFileName) {
+        std::string path = newFileName;
+        int flags = O_CREAT | O_WRONLY;
+#ifdef LINK_ZLIB
+        if (ctx->redoCopyCompress > 0) {
+            path += ".gz";
+            flags |= O_TRUNC;
+        }
+#endif /* LINK_ZLIB */
+
+        int newFileDescriptor = open(path.c_str(), flags, S_IRUSR | S_IWUSR);
+        if (unlikely(newFileDescriptor == -1))
+            throw RuntimeException(10006, "file: " + path + " - open for write returned: " + strerror(errno));
+
+#ifdef LINK_ZLIB
+        gzFile newGzFile = nullptr;
+        if (ctx->redoCopyCompress > 0) {
+            newGzFile = gzdopen(newFileDescriptor, ("wb" + std::to_string(ctx->redoCopyCompress)).c_str());
+            if (unlikely(newGzFile == nullptr)) {
+                close(newFileDescriptor);
+                throw RuntimeException(10006, "file: " + path + " - open for compressed write failed");
+            }
+        }
+#endif /* LINK_ZLIB */
+        ctx->OLR_INFO(0, "writing redo log copy to: " + path);
+
+        std::unique_lock<std::mutex> lck(mtx);
+        fileName = path;
+        fileDescriptor = newFileDescriptor;
+#ifdef LINK_ZLIB
+        gzFileCopy = newGzFile;
+#endif /* LINK_ZLIB */
+        position = 0;
+        headerDirty = false;
+        failed = false;
+    }
+
+    void RedoCopier::fileClose() {
+        drain();
+
+        std::unique_lock<std::mutex> lck(mtx);
+        if (fileDescriptor == -1)
+            return;
+
+        if (ctx->redoCopyFsync != Ctx::REDO_COPY_FSYNC_NONE && !failed)
+            sync();
+
+#ifdef LINK_ZLIB
+        if (gzFileCopy != nullptr) {
+            // Closes the file descriptor as well
+            gzclose(gzFileCopy);
+            gzFileCopy = nullptr;
+            fileDescriptor = -1;
+        }
+#endif /* LINK_ZLIB */
+        if (fileDescriptor != -1) {
+            close(fileDescriptor);
+            fileDescriptor = -1;
+        }
+    }
+
+    bool RedoCopier::copyHeader(const uint8_t* data, uint64_t size) {
+        std::unique_lock<std::mutex> lck(mtx);
+        if (failed)
+            return false;
+
+        headerSize = std::min(size, HEADER_SIZE);
+        memcpy(reinterpret_cast<void*>(header), reinterpret_cast<const void*>(data), headerSize);
+        headerDirty = true;
+        condLoop.notify_all();
+        return true;
+    }
+
+    bool RedoCopier::copy(const uint8_t* data, uint64_t size, uint64_t offset, uint64_t num) {
+        std::unique_lock<std::mutex> lck(mtx);
+        if (failed || stopped)
+            return false;
+
+        queue.push_back({data, size, offset, num});
+        condLoop.notify_all();
+        return true;
+    }
+
+    void RedoCopier::drain() {
+        std::unique_lock<std::mutex> lck(mtx);
+        while ((!queue.empty() || headerDirty || writing) && !stopped) {
+            if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
+                ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "RedoCopier:drain");
+            condDone.wait(lck);
+        }
+    }
+
+    void RedoCopier::finish() {
+        std::unique_lock<std::mutex> lck(mtx);
+        shutdown = true;
+        condLoop.notify_all();
+    }
+
+    void RedoCopier::wakeUp() {
+        std::unique_lock<std::mutex> lck(mtx);
+        condLoop.notify_all();
+        condDone.notify_all();
+    }
+
+    void RedoCopier::run() {
+        if (unlikely(ctx->trace & Ctx::TRACE_THREADS)) {
+            std::ostringstream ss;
+            ss << std::this_thread::get_id();
+            ctx->OLR_TRACE(Ctx::TRACE_THREADS, "redo copier (" + ss.str() + ") start");
+        }
+
+        try {
+            mainLoop();
+        } catch (RuntimeException& ex) {
+            ctx->OLR_ERROR(ex.code, ex.msg);
+            ctx->stopHard();
+        } catch (std::bad_alloc& ex) {
+            ctx->OLR_ERROR(10018, "memory allocation failed: " + std::string(ex.what()));
+            ctx->stopHard();
+        }
+
+        // Not written requests still hold the reader buffers
+        std::deque<RedoCopyRequest> discarded;
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            stopped = true;
+            headerDirty = false;
+            discarded.swap(queue);
+        }
+        for (const RedoCopyRequest& request: discarded)
+            reader->bufferCopyDone(request.num);
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            condDone.notify_all();
+        }
+
+        if (unlikely(ctx->trace & Ctx::TRACE_THREADS)) {
+            std::ostringstream ss;
+            ss << std::this_thread::get_id();
+            ctx->OLR_TRACE(Ctx::TRACE_THREADS, "redo copier (" + ss.str() + ") stop");
+        }
+    }
+}
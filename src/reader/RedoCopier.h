@@ -0,0 +1,93 @@
+/* Header for RedoCopier class
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "../common/Thread.h"
+#include "../common/types.h"
+
+#ifdef LINK_ZLIB
+#include <zlib.h>
+#endif /* LINK_ZLIB */
+
+#ifndef REDO_COPIER_H_
+#define REDO_COPIER_H_
+
+namespace OpenLogReplicator {
+    class Reader;
+
+    struct RedoCopyRequest {
+        const uint8_t* data;
+        uint64_t size;
+        uint64_t offset;
+        uint64_t num;
+    };
+
+    class RedoCopier final : public Thread {
+    protected:
+        static constexpr uint64_t BATCH_MAX = 64;
+        // Two blocks of the largest block size
+        static constexpr uint64_t HEADER_SIZE = 8192;
+
+        Reader* reader;
+        std::mutex mtx;
+        std::condition_variable condLoop;
+        std::condition_variable condDone;
+        std::deque<RedoCopyRequest> queue;
+        uint8_t header[HEADER_SIZE];
+        uint64_t headerSize;
+        uint8_t headerWrite[HEADER_SIZE];
+        bool headerDirty;
+        std::string fileName;
+        int fileDescriptor;
+        uint64_t position;
+        bool writing;
+        bool failed;
+        bool stopped;
+        bool shutdown;
+#ifdef LINK_ZLIB
+        gzFile gzFileCopy;
+#endif /* LINK_ZLIB */
+
+        bool writeHeader(const uint8_t* data, uint64_t size);
+        bool writeBatch(const std::vector<RedoCopyRequest>& requests);
+        bool writeCompressed(const RedoCopyRequest& request);
+        bool sync();
+        void mainLoop();
+
+    public:
+        RedoCopier(Ctx* newCtx, const std::string& newAlias, Reader* newReader);
+        ~RedoCopier() override;
+
+        [[nodiscard]] bool isOpen();
+        void fileOpen(const std::string& newFileName);
+        void fileClose();
+        bool copyHeader(const uint8_t* data, uint64_t size);
+        bool copy(const uint8_t* data, uint64_t size, uint64_t offset, uint64_t num);
+        void drain();
+        void finish();
+        void wakeUp() override;
+        void run() override;
+    };
+}
+
+#endif
@@ -0,0 +1,184 @@
+/* Watching archived redo log directories for new files
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "../common/Ctx.h"
+#include "ArchiveWatcher.h"
+
+namespace OpenLogReplicator {
+    ArchiveWatcher::ArchiveWatcher(Ctx* newCtx) :
+            ctx(newCtx),
+            baseWatch(-1),
+            fileDescriptor(-1),
+            rescan(true),
+            failed(false) {
+    }
+
+    ArchiveWatcher::~ArchiveWatcher() {
+        close();
+    }
+
+    bool ArchiveWatcher::isActive() const {
+        return fileDescriptor != -1;
+    }
+
+    bool ArchiveWatcher::needsRescan() const {
+        return rescan;
+    }
+
+    const std::string& ArchiveWatcher::getBasePath() const {
+        return basePath;
+    }
+
+    void ArchiveWatcher::requestRescan() {
+        rescan = true;
+    }
+
+    void ArchiveWatcher::disable(const std::string& message) {
+        ctx->OLR_WARN(60037, message + ", falling back to scanning of archived redo log directories");
+        close();
+        failed = true;
+    }
+
+    bool ArchiveWatcher::initialize(const std::string& newBasePath) {
+        close();
+        if (failed)
+            return false;
+        basePath = newBasePath;
+
+        fileDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fileDescriptor == -1) {
+            disable("directory: " + basePath + " - inotify init returned: " + strerror(errno));
+            return false;
+        }
+
+        // New day directories
+        baseWatch = inotify_add_watch(fileDescriptor, basePath.c_str(), IN_CREATE | IN_MOVED_TO | IN_ONLYDIR);
+        if (baseWatch == -1) {
+            disable("directory: " + basePath + " - inotify add watch returned: " + strerror(errno));
+            return false;
+        }
+
+        rescan = false;
+        if (unlikely(ctx->trace & Ctx::TRACE_ARCHIVE_LIST))
+            ctx->OLR_TRACE(Ctx::TRACE_ARCHIVE_LIST, "watching path: " + basePath);
+        return true;
+    }
+
+    bool ArchiveWatcher::watchDirectory(const std::string& path) {
+        if (fileDescriptor == -1)
+            return false;
+
+        // Archived redo log files are complete when closed by the archiver or moved into the directory
+        int watch = inotify_add_watch(fileDescriptor, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_ONLYDIR);
+        if (watch == -1) {
+            disable("directory: " + path + " - inotify add watch returned: " + strerror(errno));
+            return false;
+        }
+
+        watches[watch] = path;
+        if (unlikely(ctx->trace & Ctx::TRACE_ARCHIVE_LIST))
+            ctx->OLR_TRACE(Ctx::TRACE_ARCHIVE_LIST, "watching path: " + path);
+        return true;
+    }
+
+    void ArchiveWatcher::read(std::vector<std::string>& files, std::vector<std::string>& dirs) {
+        alignas(struct inotify_event) char buffer[EVENT_BUFFER_SIZE];
+
+        while (fileDescriptor != -1) {
+            ssize_t bytes = ::read(fileDescriptor, buffer, EVENT_BUFFER_SIZE);
+            if (bytes <= 0) {
+                if (bytes == -1 && errno != EAGAIN && errno != EINTR)
+                    disable("directory: " + basePath + " - inotify read returned: " + strerror(errno));
+                break;
+            }
+
+            for (ssize_t pos = 0; pos < bytes;) {
+                const auto event = reinterpret_cast<const struct inotify_event*>(buffer + pos);
+                pos += static_cast<ssize_t>(sizeof(struct inotify_event) + event->len);
+
+                // Events were lost, the directories need to be scanned again
+                if ((event->mask & IN_Q_OVERFLOW) != 0) {
+                    if (unlikely(ctx->trace & Ctx::TRACE_ARCHIVE_LIST))
+                        ctx->OLR_TRACE(Ctx::TRACE_ARCHIVE_LIST, "watch queue overflow for path: " + basePath);
+                    rescan = true;
+                    continue;
+                }
+
+                if ((event->mask & IN_IGNORED) != 0) {
+                    if (event->wd == baseWatch) {
+                        baseWatch = -1;
+                        rescan = true;
+                    } else
+                        watches.erase(event->wd);
+                    continue;
+                }
+
+                if (event->len == 0)
+                    continue;
+
+                if (event->wd == baseWatch) {
+                    if ((event->mask & IN_ISDIR) == 0)
+                        continue;
+
+                    std::string path(basePath + "/" + event->name);
+                    if (!watchDirectory(path))
+                        break;
+                    dirs.push_back(path);
+                    continue;
+                }
+
+                auto it = watches.find(event->wd);
+                if (it == watches.end() || (event->mask & IN_ISDIR) != 0)
+                    continue;
+
+                files.push_back(it->second + "/" + event->name);
+            }
+        }
+
+        // Without the watcher all directories are scanned again
+        if (fileDescriptor == -1)
+            rescan = true;
+    }
+
+    bool ArchiveWatcher::wait(uint64_t timeUs) const {
+        struct pollfd pollDescriptor = {fileDescriptor, POLLIN, 0};
+        int ret;
+        do {
+            ret = poll(&pollDescriptor, 1, static_cast<int>((timeUs + 999) / 1000));
+        } while (ret == -1 && errno == EINTR && !ctx->softShutdown);
+
+        return ret > 0;
+    }
+
+    void ArchiveWatcher::close() {
+        if (fileDescriptor != -1) {
+            ::close(fileDescriptor);
+            fileDescriptor = -1;
+        }
+        baseWatch = -1;
+        watches.clear();
+        rescan = true;
+    }
+}
@@ -0,0 +1,62 @@
+/* Header for ArchiveWatcher class
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../common/types.h"
+
+#ifndef ARCHIVE_WATCHER_H_
+#define ARCHIVE_WATCHER_H_
+
+namespace OpenLogReplicator {
+    class Ctx;
+
+    class ArchiveWatcher final {
+    protected:
+        static constexpr uint64_t EVENT_BUFFER_SIZE = 16384;
+
+        Ctx* ctx;
+        std::string basePath;
+        int baseWatch;
+        std::unordered_map<int, std::string> watches;
+        int fileDescriptor;
+        bool rescan;
+        bool failed;
+
+        void disable(const std::string& message);
+
+    public:
+        explicit ArchiveWatcher(Ctx* newCtx);
+        ~ArchiveWatcher();
+
+        [[nodiscard]] bool isActive() const;
+        [[nodiscard]] bool needsRescan() const;
+        [[nodiscard]] const std::string& getBasePath() const;
+        void requestRescan();
+        bool initialize(const std::string& newBasePath);
+        bool watchDirectory(const std::string& path);
+        void read(std::vector<std::string>& files, std::vector<std::string>& dirs);
+        bool wait(uint64_t timeUs) const;
+        void close();
+    };
+}
+
+#endif
@@ -0,0 +1,304 @@
+/* Thread staging archived redo log files for parallel batch processing
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <thread>
+#include <unistd.h>
+
+#include "../common/Ctx.h"
+#include "../common/exception/DataException.h"
+#include "../common/exception/RedoLogException.h"
+#include "../common/exception/RuntimeException.h"
+#include "../parser/Parser.h"
+#include "../reader/Reader.h"
+#include "BatchWorker.h"
+
+namespace OpenLogReplicator {
+    BatchWorker::BatchWorker(Ctx* newCtx, const std::string& newAlias, Builder* newBuilder, Metadata* newMetadata,
+                             TransactionBuffer* newTransactionBuffer, Reader* newReader) :
+            Thread(newCtx, newAlias),
+            builder(newBuilder),
+            metadata(newMetadata),
+            transactionBuffer(newTransactionBuffer),
+            reader(newReader),
+            parser(nullptr),
+            startOffset(0),
+            stagedChunks(0),
+            stagedRecords(0),
+            ret(Reader::REDO_OK),
+            pending(false),
+            busy(false),
+            opened(false),
+            staged(false),
+            released(false),
+            shutdown(false) {
+    }
+
+    BatchWorker::~BatchWorker() {
+        for (LwnGroup* lwnGroup: groups)
+            groupFree(lwnGroup);
+        groups.clear();
+
+        for (LwnDecoded* lwnDecoded: decodedFree)
+            delete lwnDecoded;
+        decodedFree.clear();
+
+        // Members of the last staged group may still point to chunks owned by the parser
+        if (parser != nullptr) {
+            delete parser;
+            parser = nullptr;
+        }
+    }
+
+    void BatchWorker::groupFree(LwnGroup* lwnGroup) {
+        for (uint8_t* chunk: lwnGroup->chunks)
+            ctx->freeMemoryChunk(Ctx::MEMORY_MODULE_PARSER, chunk, false);
+        // The decoded records keep their memory for the next groups
+        decodedFree.insert(decodedFree.end(), lwnGroup->decoded.begin(), lwnGroup->decoded.end());
+        delete lwnGroup;
+    }
+
+    Reader* BatchWorker::getReader() const {
+        return reader;
+    }
+
+    void BatchWorker::schedule(const std::string& newPath, uint64_t newStartOffset) {
+        std::unique_lock<std::mutex> lck(mtx);
+        // A file which was given up is still being drained
+        while (busy && !shutdown && !ctx->softShutdown)
+            condMerge.wait(lck);
+
+        path = newPath;
+        startOffset = newStartOffset;
+        ret = Reader::REDO_OK;
+        pending = true;
+        busy = true;
+        opened = false;
+        staged = false;
+        released = false;
+        condWorker.notify_all();
+    }
+
+    Reader* BatchWorker::waitOpened() {
+        std::unique_lock<std::mutex> lck(mtx);
+        while (!opened && !shutdown && !ctx->softShutdown)
+            condMerge.wait(lck);
+
+        if (!opened)
+            return nullptr;
+        return reader;
+    }
+
+    void BatchWorker::decodedAllocate(std::vector<LwnDecoded*>& decoded, uint64_t count) {
+        decoded.reserve(count);
+        std::unique_lock<std::mutex> lck(mtx);
+        while (decoded.size() < count && !decodedFree.empty()) {
+            decoded.push_back(decodedFree.back());
+            decodedFree.pop_back();
+        }
+        while (decoded.size() < count)
+            decoded.push_back(new LwnDecoded);
+    }
+
+    bool BatchWorker::push(LwnGroup* lwnGroup) {
+        std::unique_lock<std::mutex> lck(mtx);
+        while (!released && !shutdown && !ctx->softShutdown &&
+                (stagedChunks >= STAGED_CHUNKS_MAX || stagedRecords >= STAGED_RECORDS_MAX || groups.size() >= STAGED_GROUPS_MAX)) {
+            if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
+                ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "BatchWorker:push");
+            condWorker.wait(lck);
+        }
+
+        if (shutdown || ctx->softShutdown) {
+            groupFree(lwnGroup);
+            return false;
+        }
+
+        // The merge gave up the file, just drain it
+        if (released) {
+            groupFree(lwnGroup);
+            return true;
+        }
+
+        stagedChunks += lwnGroup->chunks.size();
+        stagedRecords += lwnGroup->records;
+        groups.push_back(lwnGroup);
+        condMerge.notify_all();
+        return true;
+    }
+
+    LwnGroup* BatchWorker::pop() {
+        std::unique_lock<std::mutex> lck(mtx);
+        while (groups.empty() && !staged && !shutdown && !ctx->softShutdown) {
+            if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
+                ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "BatchWorker:pop");
+            condMerge.wait(lck);
+        }
+
+        if (groups.empty())
+            return nullptr;
+
+        LwnGroup* lwnGroup = groups.front();
+        groups.pop_front();
+        return lwnGroup;
+    }
+
+    void BatchWorker::release(LwnGroup* lwnGroup) {
+        std::unique_lock<std::mutex> lck(mtx);
+        stagedChunks -= lwnGroup->chunks.size();
+        stagedRecords -= lwnGroup->records;
+        groupFree(lwnGroup);
+        condWorker.notify_all();
+    }
+
+    uint64_t BatchWorker::getRet() {
+        std::unique_lock<std::mutex> lck(mtx);
+        return ret;
+    }
+
+    void BatchWorker::done() {
+        std::unique_lock<std::mutex> lck(mtx);
+        for (LwnGroup* lwnGroup: groups) {
+            stagedChunks -= lwnGroup->chunks.size();
+            stagedRecords -= lwnGroup->records;
+            groupFree(lwnGroup);
+        }
+        groups.clear();
+        released = true;
+        condWorker.notify_all();
+    }
+
+    void BatchWorker::stop() {
+        std::unique_lock<std::mutex> lck(mtx);
+        shutdown = true;
+        condWorker.notify_all();
+        condMerge.notify_all();
+    }
+
+    void BatchWorker::wakeUp() {
+        std::unique_lock<std::mutex> lck(mtx);
+        condWorker.notify_all();
+        condMerge.notify_all();
+    }
+
+    void BatchWorker::mainLoop() {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lck(mtx);
+                while (!pending && !shutdown && !ctx->softShutdown) {
+                    if (unlikely(ctx->trace & Ctx::TRACE_SLEEP))
+                        ctx->OLR_TRACE(Ctx::TRACE_SLEEP, "BatchWorker:mainLoop:idle");
+                    condWorker.wait(lck);
+                }
+
+                if (shutdown || ctx->softShutdown)
+                    break;
+                pending = false;
+            }
+
+            reader->fileName = path;
+            uint64_t retry = ctx->archReadTries;
+
+            while (true) {
+                if (reader->checkRedoLog() && reader->updateRedoLog())
+                    break;
+
+                if (ctx->softShutdown)
+                    return;
+
+                if (retry == 0)
+                    throw RuntimeException(10009, "file: " + path + " - failed to open after " +
+                                                  std::to_string(ctx->archReadTries) + " tries");
+
+                ctx->OLR_INFO(0, "archived redo log " + path + " is not ready for read, sleeping " +
+                                 std::to_string(ctx->archReadSleepUs) + " us");
+                usleep(ctx->archReadSleepUs);
+                --retry;
+            }
+
+            parser = new Parser(ctx, builder, metadata, transactionBuffer, 0, path);
+            parser->reader = reader;
+            {
+                std::unique_lock<std::mutex> lck(mtx);
+                opened = true;
+                condMerge.notify_all();
+            }
+
+            uint64_t newRet = parser->stage(this, startOffset);
+
+            {
+                std::unique_lock<std::mutex> lck(mtx);
+                ret = newRet;
+                staged = true;
+                condMerge.notify_all();
+
+                while (!released && !shutdown && !ctx->softShutdown)
+                    condWorker.wait(lck);
+
+                // The merge may still be analyzing records stored in the parser
+                if (!released)
+                    break;
+            }
+
+            delete parser;
+            parser = nullptr;
+
+            {
+                std::unique_lock<std::mutex> lck(mtx);
+                busy = false;
+                condMerge.notify_all();
+            }
+        }
+    }
+
+    void BatchWorker::run() {
+        if (unlikely(ctx->trace & Ctx::TRACE_THREADS)) {
+            std::ostringstream ss;
+            ss << std::this_thread::get_id();
+            ctx->OLR_TRACE(Ctx::TRACE_THREADS, "batch worker (" + ss.str() + ") start");
+        }
+
+        try {
+            mainLoop();
+        } catch (DataException& ex) {
+            ctx->OLR_ERROR(ex.code, ex.msg);
+            ctx->stopHard();
+        } catch (RedoLogException& ex) {
+            ctx->OLR_ERROR(ex.code, ex.msg);
+            ctx->stopHard();
+        } catch (RuntimeException& ex) {
+            ctx->OLR_ERROR(ex.code, ex.msg);
+            ctx->stopHard();
+        } catch (std::bad_alloc& ex) {
+            ctx->OLR_ERROR(10018, "memory allocation failed: " + std::string(ex.what()));
+            ctx->stopHard();
+        }
+
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            shutdown = true;
+            condMerge.notify_all();
+        }
+
+        if (unlikely(ctx->trace & Ctx::TRACE_THREADS)) {
+            std::ostringstream ss;
+            ss << std::this_thread::get_id();
+            ctx->OLR_TRACE(Ctx::TRACE_THREADS, "batch worker (" + ss.str() + ") stop");
+        }
+    }
+}
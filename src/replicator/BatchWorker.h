@@ -0,0 +1,92 @@
+/* Header for BatchWorker class
+   Copyright (C) 2018-2024 Adam Leszczynski (aleszczynski@bersler.com)
+
+This file is part of OpenLogReplicator.
+
+OpenLogReplicator is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 3, or (at your option)
+any later version.
+
+OpenLogReplicator is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenLogReplicator; see the file LICENSE;  If not see
+<http://www.gnu.org/licenses/>.  */
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "../common/Thread.h"
+#include "../common/types.h"
+
+#ifndef BATCH_WORKER_H_
+#define BATCH_WORKER_H_
+
+namespace OpenLogReplicator {
+    class Builder;
+    class Metadata;
+    class Parser;
+    class Reader;
+    class TransactionBuffer;
+    struct LwnDecoded;
+    struct LwnGroup;
+
+    class BatchWorker final : public Thread {
+    protected:
+        // Limit of memory staged ahead of the merge
+        static constexpr uint64_t STAGED_CHUNKS_MAX = 16;
+        static constexpr uint64_t STAGED_GROUPS_MAX = 4096;
+        static constexpr uint64_t STAGED_RECORDS_MAX = 65536;
+
+        Builder* builder;
+        Metadata* metadata;
+        TransactionBuffer* transactionBuffer;
+        Reader* reader;
+        Parser* parser;
+        std::mutex mtx;
+        std::condition_variable condWorker;
+        std::condition_variable condMerge;
+        std::deque<LwnGroup*> groups;
+        std::vector<LwnDecoded*> decodedFree;
+        std::string path;
+        uint64_t startOffset;
+        uint64_t stagedChunks;
+        uint64_t stagedRecords;
+        uint64_t ret;
+        bool pending;
+        bool busy;
+        bool opened;
+        bool staged;
+        bool released;
+        bool shutdown;
+
+        void groupFree(LwnGroup* lwnGroup);
+        void mainLoop();
+
+    public:
+        BatchWorker(Ctx* newCtx, const std::string& newAlias, Builder* newBuilder, Metadata* newMetadata,
+                    TransactionBuffer* newTransactionBuffer, Reader* newReader);
+        ~BatchWorker() override;
+
+        [[nodiscard]] Reader* getReader() const;
+        void schedule(const std::string& newPath, uint64_t newStartOffset);
+        Reader* waitOpened();
+        void decodedAllocate(std::vector<LwnDecoded*>& decoded, uint64_t count);
+        bool push(LwnGroup* lwnGroup);
+        LwnGroup* pop();
+        void release(LwnGroup* lwnGroup);
+        [[nodiscard]] uint64_t getRet();
+        void done();
+        void stop();
+        void wakeUp() override;
+        void run() override;
+    };
+}
+
+#endif
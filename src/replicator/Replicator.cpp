@@ -28,17 +28,33 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #include "../common/Ctx.h"
 #include "../common/OracleIncarnation.h"
 #include "../common/exception/BootException.h"
+#include "../common/exception/DataException.h"
 #include "../common/exception/RedoLogException.h"
 #include "../common/exception/RuntimeException.h"
 #include "../metadata/Metadata.h"
 #include "../metadata/RedoLog.h"
 #include "../metadata/Schema.h"
+#include "../parser/FormatWorker.h"
+#include "../parser/LwnDecoder.h"
 #include "../parser/Parser.h"
 #include "../parser/Transaction.h"
 #include "../parser/TransactionBuffer.h"
+#include "../parser/TransactionFlusher.h"
+#include "../reader/ArchivePrefetcher.h"
+#include "../reader/BlockChSum.h"
 #include "../reader/ReaderFilesystem.h"
+#include "../reader/ReaderMmap.h"
+#include "ArchiveWatcher.h"
 #include "Replicator.h"
 
+#if defined(LINK_ZLIB) || defined(LINK_ZSTD)
+#include "../reader/Decompressor.h"
+#include "../reader/ReaderCompressed.h"
+#endif /* LINK_ZLIB || LINK_ZSTD */
+#ifdef LINK_URING
+#include "../reader/ReaderUring.h"
+#endif /* LINK_URING */
+
 namespace OpenLogReplicator {
     Replicator::Replicator(Ctx* newCtx, void (* newArchGetLog)(Replicator* replicator), Builder* newBuilder, Metadata* newMetadata,
                            TransactionBuffer* newTransactionBuffer, const std::string& newAlias, const char* newDatabase) :
@@ -48,10 +64,17 @@ namespace OpenLogReplicator {
             metadata(newMetadata),
             transactionBuffer(newTransactionBuffer),
             database(newDatabase),
-            archReader(nullptr) {
+            archReader(nullptr),
+            archPrefetcher(nullptr),
+            archWatcher(nullptr),
+            flusher(new TransactionFlusher(ctx, builder, metadata, transactionBuffer, alias + "-flusher")) {
     }
 
     Replicator::~Replicator() {
+        decodersDrop();
+        flusherDrop();
+        delete flusher;
+        flusher = nullptr;
         readerDropAll();
 
         if (transactionBuffer != nullptr)
@@ -67,6 +90,11 @@ namespace OpenLogReplicator {
             delete onlineRedo;
         onlineRedoSet.clear();
 
+        if (archWatcher != nullptr) {
+            delete archWatcher;
+            archWatcher = nullptr;
+        }
+
         pathMapping.clear();
         redoLogsBatch.clear();
     }
@@ -74,12 +102,120 @@ namespace OpenLogReplicator {
     void Replicator::initialize() {
     }
 
+    void Replicator::archPrefetchSchedule() {
+        // Memory mapped files are read by the kernel directly
+        if (ctx->archPrefetchLogs == 0 || ctx->readMode == Ctx::READ_MODE_MMAP)
+            return;
+
+        if (archPrefetcher == nullptr) {
+            archPrefetcher = new ArchivePrefetcher(ctx, alias + "-prefetcher", ctx->archPrefetchLogs);
+            ctx->spawnThread(archPrefetcher);
+        }
+        archReader->archPrefetcher = archPrefetcher;
+
+        // Only the logs which directly follow the current one
+        std::priority_queue<Parser*, std::vector<Parser*>, parserCompare> queue(archiveRedoQueue);
+        std::vector<std::string> paths;
+        typeSeq sequence = queue.top()->sequence;
+        while (!queue.empty() && paths.size() <= ctx->archPrefetchLogs) {
+            Parser* parser = queue.top();
+            queue.pop();
+            if (parser->sequence < sequence)
+                continue;
+            if (parser->sequence > sequence)
+                break;
+#if defined(LINK_ZLIB) || defined(LINK_ZSTD)
+            // Compressed files are decompressed by the reader
+            if (Decompressor::getType(parser->path) != Decompressor::TYPE_NONE)
+                break;
+#endif /* LINK_ZLIB || LINK_ZSTD */
+            paths.push_back(parser->path);
+            ++sequence;
+        }
+
+        archPrefetcher->schedule(paths);
+    }
+
     void Replicator::cleanArchList() {
         while (!archiveRedoQueue.empty()) {
             Parser* parser = archiveRedoQueue.top();
             archiveRedoQueue.pop();
             delete parser;
         }
+
+        // The list is built from scratch
+        if (archWatcher != nullptr)
+            archWatcher->requestRescan();
+    }
+
+    void Replicator::archAddFile(const std::string& fileName, const char* name) {
+        if (unlikely(ctx->trace & Ctx::TRACE_ARCHIVE_LIST))
+            ctx->OLR_TRACE(Ctx::TRACE_ARCHIVE_LIST, "checking path: " + fileName);
+
+        uint16_t thread;
+        uint64_t sequence = getSequenceFromFileName(this, name, thread);
+
+        if (unlikely(ctx->trace & Ctx::TRACE_ARCHIVE_LIST))
+            ctx->OLR_TRACE(Ctx::TRACE_ARCHIVE_LIST, "found seq: " + std::to_string(sequence) + ", thread: " + std::to_string(thread));
+
+        if (sequence == 0 || sequence < metadata->getThreadSequence(thread))
+            return;
+
+        auto parser = new Parser(ctx, builder, metadata, transactionBuffer, 0, fileName);
+
+        parser->firstScn = Ctx::ZERO_SCN;
+        parser->nextScn = Ctx::ZERO_SCN;
+        parser->sequence = sequence;
+        parser->thread = thread;
+        archiveRedoQueue.push(parser);
+    }
+
+    void Replicator::restoreTransactions() {
+        std::string transactionsName(metadata->transactionsName);
+        metadata->transactionsName.clear();
+        if (ctx->checkpointTransactions == 0)
+            return;
+
+        // Without the open transactions processing starts from the oldest one
+        std::string in;
+        if (!metadata->stateRead(transactionsName, Metadata::TRANSACTIONS_FILE_MAX_SIZE, in)) {
+            ctx->OLR_WARN(60040, "file: " + transactionsName + " - open transactions not restored: file not read, starting from the oldest "
+                                 "open transaction");
+            return;
+        }
+
+        std::istream* data = metadata->stateReadData(transactionsName);
+        if (data == nullptr) {
+            ctx->OLR_WARN(60040, "file: " + transactionsName + " - open transactions not restored: data not read, starting from the oldest "
+                                 "open transaction");
+            return;
+        }
+
+        try {
+            uint64_t transactions = transactionBuffer->restore(metadata->schema->xmlCtxDefault, transactionsName, in, *data);
+            delete data;
+            metadata->setSeqOffset(metadata->transactionsSequence, metadata->transactionsOffset);
+            {
+                // Merged redo threads continue from their checkpoint positions too
+                std::unique_lock<std::mutex> lck(metadata->mtxCheckpoint);
+                if (!metadata->threadPositions.empty())
+                    metadata->threadPositions = metadata->threadTransactionsPositions;
+            }
+            ctx->OLR_INFO(0, "restored open transactions: " + std::to_string(transactions) + " from: " + transactionsName);
+        } catch (DataException& ex) {
+            delete data;
+            transactionBuffer->purge();
+            ctx->OLR_WARN(60040, "file: " + transactionsName + " - open transactions not restored: " + ex.msg + ", starting from the oldest "
+                                 "open transaction");
+        }
+    }
+
+    void Replicator::archWait(uint64_t timeUs) {
+        // Wake up as soon as a new archived redo log appears
+        if (archWatcher != nullptr && archWatcher->isActive() && !archWatcher->needsRescan())
+            archWatcher->wait(timeUs);
+        else
+            usleep(timeUs);
     }
 
     void Replicator::updateOnlineLogs() {
@@ -106,6 +242,13 @@ namespace OpenLogReplicator {
             usleep(1000);
         }
 
+        if (archPrefetcher != nullptr) {
+            archPrefetcher->stop();
+            ctx->finishThread(archPrefetcher);
+            delete archPrefetcher;
+            archPrefetcher = nullptr;
+        }
+
         while (!readers.empty()) {
             Reader* reader = *(readers.begin());
             ctx->finishThread(reader);
@@ -117,6 +260,73 @@ namespace OpenLogReplicator {
         readers.clear();
     }
 
+    void Replicator::decodersCreate() {
+        // Dump of redo logs needs the records to be decoded in order
+        if (!lwnDecoders.empty() || ctx->decodeWorkers == 0 || ctx->dumpRedoLog > 0)
+            return;
+
+        for (uint64_t num = 0; num < ctx->decodeWorkers; ++num) {
+            auto lwnDecoder = new LwnDecoder(ctx, alias + "-decoder-" + std::to_string(num));
+            lwnDecoders.push_back(lwnDecoder);
+            ctx->spawnThread(lwnDecoder);
+        }
+    }
+
+    void Replicator::decodersDrop() {
+        for (LwnDecoder* lwnDecoder: lwnDecoders)
+            lwnDecoder->stop();
+
+        for (LwnDecoder* lwnDecoder: lwnDecoders) {
+            ctx->finishThread(lwnDecoder);
+            delete lwnDecoder;
+        }
+        lwnDecoders.clear();
+    }
+
+    void Replicator::decodersAttach(Parser* parser) {
+        if (lwnDecoders.empty())
+            parser->decoders = nullptr;
+        else
+            parser->decoders = &lwnDecoders;
+        parser->flusher = flusher;
+    }
+
+    void Replicator::flusherCreate() {
+        // Without the queue committed transactions are flushed by the parser
+        if (flusher->isStarted() || ctx->flushQueue == 0)
+            return;
+
+        for (Builder* formatBuilder: formatBuilders) {
+            auto formatWorker = new FormatWorker(ctx, formatBuilder, metadata, transactionBuffer,
+                                                 alias + "-format-" + std::to_string(formatWorkers.size()));
+            formatWorkers.push_back(formatWorker);
+            ctx->spawnThread(formatWorker);
+        }
+        flusher->workers = &formatWorkers;
+
+        flusher->start();
+        ctx->spawnThread(flusher);
+    }
+
+    void Replicator::flusherDrop() {
+        if (!flusher->isStarted())
+            return;
+
+        // Queued transactions are flushed before the thread stops
+        flusher->stop();
+        ctx->finishThread(flusher);
+
+        for (FormatWorker* formatWorker: formatWorkers)
+            formatWorker->stop();
+
+        for (FormatWorker* formatWorker: formatWorkers) {
+            ctx->finishThread(formatWorker);
+            delete formatWorker;
+        }
+        formatWorkers.clear();
+        flusher->workers = nullptr;
+    }
+
     void Replicator::loadDatabaseMetadata() {
         archReader = readerCreate(0);
     }
@@ -202,6 +412,8 @@ namespace OpenLogReplicator {
                     else
                         metadata->allowCheckpoints();
                     metadata->schema->updateXmlCtx();
+                    if (!metadata->transactionsName.empty())
+                        restoreTransactions();
 
                     if (metadata->sequence == Ctx::ZERO_SEQ)
                         throw BootException(10028, "starting sequence is unknown");
@@ -233,6 +445,8 @@ namespace OpenLogReplicator {
                 metadata->setStatusReplicate();
             } while (metadata->status != Metadata::STATUS_REPLICATE);
 
+            decodersCreate();
+            flusherCreate();
             while (!ctx->softShutdown) {
                 bool logsProcessed = false;
 
@@ -251,7 +465,7 @@ namespace OpenLogReplicator {
                     break;
 
                 if (!logsProcessed)
-                    usleep(ctx->redoReadSleepUs);
+                    archWait(ctx->redoReadSleepUs);
             }
         } catch (DataException& ex) {
             ctx->OLR_ERROR(ex.code, ex.msg);
@@ -268,6 +482,8 @@ namespace OpenLogReplicator {
         }
 
         ctx->OLR_INFO(0, "Oracle replicator for: " + database + " is shutting down");
+        decodersDrop();
+        flusherDrop();
 
         ctx->replicatorFinished = true;
         ctx->OLR_INFO(0, "Oracle replicator for: " + database + " allocated at most " + std::to_string(ctx->getMaxUsedMemory()) +
@@ -285,13 +501,32 @@ namespace OpenLogReplicator {
             if (reader->getGroup() == group)
                 return reader;
 
-        auto readerFS = new ReaderFilesystem(ctx, alias + "-reader-" + std::to_string(group), database, group,
-                                             metadata->dbBlockChecksum != "OFF" && metadata->dbBlockChecksum != "FALSE");
-        readers.insert(readerFS);
-        readerFS->initialize();
+        Reader* reader = readerSpawn(group, alias + "-reader-" + std::to_string(group));
+        readers.insert(reader);
+        return reader;
+    }
 
-        ctx->spawnThread(readerFS);
-        return readerFS;
+    Reader* Replicator::readerSpawn(int64_t group, const std::string& readerAlias) {
+        Reader* reader;
+        bool configuredBlockSum = metadata->dbBlockChecksum != "OFF" && metadata->dbBlockChecksum != "FALSE";
+#ifdef LINK_URING
+        if (ctx->readMode == Ctx::READ_MODE_URING)
+            reader = new ReaderUring(ctx, readerAlias, database, group, configuredBlockSum, ctx->readQueueDepth);
+        else
+#endif /* LINK_URING */
+        if (ctx->readMode == Ctx::READ_MODE_MMAP && group == 0)
+            reader = new ReaderMmap(ctx, readerAlias, database, group, configuredBlockSum);
+        else
+#if defined(LINK_ZLIB) || defined(LINK_ZSTD)
+        if (group == 0)
+            reader = new ReaderCompressed(ctx, readerAlias, database, group, configuredBlockSum);
+        else
+#endif /* LINK_ZLIB || LINK_ZSTD */
+            reader = new ReaderFilesystem(ctx, readerAlias, database, group, configuredBlockSum);
+        reader->initialize();
+
+        ctx->spawnThread(reader);
+        return reader;
     }
 
     void Replicator::checkOnlineRedoLogs() {
@@ -340,12 +575,18 @@ namespace OpenLogReplicator {
     // %a - activation id
     // %d - database id
     // %h - some hash
-    uint64_t Replicator::getSequenceFromFileName(Replicator* replicator, const std::string& file) {
+    uint64_t Replicator::getSequenceFromFileName(Replicator* replicator, const std::string& file, uint16_t& thread) {
         uint64_t sequence = 0;
+        thread = 0;
         uint64_t i = 0;
         uint64_t j = 0;
+        uint64_t length = file.length();
+#if defined(LINK_ZLIB) || defined(LINK_ZSTD)
+        // Compressed file name is matched without the compression extension
+        length -= Decompressor::extensionLength(file);
+#endif /* LINK_ZLIB || LINK_ZSTD */
 
-        while (i < replicator->metadata->logArchiveFormat.length() && j < file.length()) {
+        while (i < replicator->metadata->logArchiveFormat.length() && j < length) {
             if (replicator->metadata->logArchiveFormat[i] == '%') {
                 if (i + 1 >= replicator->metadata->logArchiveFormat.length()) {
                     replicator->ctx->OLR_WARN(60028, "can't get sequence from file: " + file + " log_archive_format: " +
@@ -360,7 +601,7 @@ namespace OpenLogReplicator {
                     replicator->metadata->logArchiveFormat[i + 1] == 'd') {
                     // Some [0-9]*
                     uint64_t number = 0;
-                    while (j < file.length() && file[j] >= '0' && file[j] <= '9') {
+                    while (j < length && file[j] >= '0' && file[j] <= '9') {
                         number = number * 10 + (file[j] - '0');
                         ++j;
                         ++digits;
@@ -368,10 +609,12 @@ namespace OpenLogReplicator {
 
                     if (replicator->metadata->logArchiveFormat[i + 1] == 's' || replicator->metadata->logArchiveFormat[i + 1] == 'S')
                         sequence = number;
+                    else if (replicator->metadata->logArchiveFormat[i + 1] == 't' || replicator->metadata->logArchiveFormat[i + 1] == 'T')
+                        thread = static_cast<uint16_t>(number);
                     i += 2;
                 } else if (replicator->metadata->logArchiveFormat[i + 1] == 'h') {
                     // Some [0-9a-z]*
-                    while (j < file.length() && ((file[j] >= '0' && file[j] <= '9') || (file[j] >= 'a' && file[j] <= 'z'))) {
+                    while (j < length && ((file[j] >= '0' && file[j] <= '9') || (file[j] >= 'a' && file[j] <= 'z'))) {
                         ++j;
                         ++digits;
                     }
@@ -395,7 +638,7 @@ namespace OpenLogReplicator {
             }
         }
 
-        if (i == replicator->metadata->logArchiveFormat.length() && j == file.length())
+        if (i == replicator->metadata->logArchiveFormat.length() && j == length)
             return sequence;
 
         replicator->ctx->OLR_WARN(60028, "OLR_ERROR getting sequence from file: " + file + " log_archive_format: " +
@@ -413,6 +656,10 @@ namespace OpenLogReplicator {
         pathMapping.push_back(targetMapping);
     }
 
+    void Replicator::addFormatBuilder(Builder* formatBuilder) {
+        formatBuilders.push_back(formatBuilder);
+    }
+
     void Replicator::addRedoLogsBatch(const char* path) {
         redoLogsBatch.emplace_back(path);
     }
@@ -464,6 +711,44 @@ namespace OpenLogReplicator {
         if (unlikely(replicator->ctx->trace & Ctx::TRACE_ARCHIVE_LIST))
             replicator->ctx->OLR_TRACE(Ctx::TRACE_ARCHIVE_LIST, "checking path: " + mappedPath);
 
+        if (replicator->ctx->archWatch == 1 && replicator->archWatcher == nullptr)
+            replicator->archWatcher = new ArchiveWatcher(replicator->ctx);
+        ArchiveWatcher* watcher = replicator->archWatcher;
+
+        // Only the files reported by the watcher since the last call
+        if (watcher != nullptr && watcher->isActive() && !watcher->needsRescan() && watcher->getBasePath() == mappedPath) {
+            std::vector<std::string> files;
+            std::vector<std::string> dirs;
+            watcher->read(files, dirs);
+
+            if (!watcher->needsRescan()) {
+                // Files could be created before the watch for a new directory was added
+                for (const std::string& mappedDir: dirs) {
+                    DIR* dir;
+                    if ((dir = opendir(mappedDir.c_str())) == nullptr)
+                        throw RuntimeException(10012, "directory: " + mappedDir + " - can't read");
+
+                    const struct dirent* ent;
+                    while ((ent = readdir(dir)) != nullptr) {
+                        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0)
+                            continue;
+                        replicator->archAddFile(mappedDir + "/" + ent->d_name, ent->d_name);
+                    }
+                    closedir(dir);
+                }
+
+                for (const std::string& fileName: files) {
+                    uint64_t j = fileName.find_last_of('/');
+                    replicator->archAddFile(fileName, fileName.c_str() + j + 1);
+                }
+                return;
+            }
+        }
+
+        // Full scan, the watches are set up before so that no file is missed
+        if (watcher != nullptr)
+            watcher->initialize(mappedPath);
+
         DIR* dir;
         if ((dir = opendir(mappedPath.c_str())) == nullptr)
             throw RuntimeException(10012, "directory: " + mappedPath + " - can't read");
@@ -492,6 +777,9 @@ namespace OpenLogReplicator {
                 replicator->ctx->OLR_TRACE(Ctx::TRACE_ARCHIVE_LIST, "checking path: " + mappedPath + "/" + ent->d_name);
 
             std::string mappedPathWithFile(mappedPath + "/" + ent->d_name);
+            if (watcher != nullptr)
+                watcher->watchDirectory(mappedPathWithFile);
+
             DIR* dir2;
             if ((dir2 = opendir(mappedPathWithFile.c_str())) == nullptr) {
                 closedir(dir);
@@ -503,25 +791,7 @@ namespace OpenLogReplicator {
                 if (strcmp(ent2->d_name, ".") == 0 || strcmp(ent2->d_name, "..") == 0)
                     continue;
 
-                std::string fileName(mappedPath + "/" + ent->d_name + "/" + ent2->d_name);
-                if (unlikely(replicator->ctx->trace & Ctx::TRACE_ARCHIVE_LIST))
-                    replicator->ctx->OLR_TRACE(Ctx::TRACE_ARCHIVE_LIST, "checking path: " + fileName);
-
-                uint64_t sequence = getSequenceFromFileName(replicator, ent2->d_name);
-
-                if (unlikely(replicator->ctx->trace & Ctx::TRACE_ARCHIVE_LIST))
-                    replicator->ctx->OLR_TRACE(Ctx::TRACE_ARCHIVE_LIST, "found seq: " + std::to_string(sequence));
-
-                if (sequence == 0 || sequence < replicator->metadata->sequence)
-                    continue;
-
-                auto parser = new Parser(replicator->ctx, replicator->builder, replicator->metadata,
-                                         replicator->transactionBuffer, 0, fileName);
-
-                parser->firstScn = Ctx::ZERO_SCN;
-                parser->nextScn = Ctx::ZERO_SCN;
-                parser->sequence = sequence;
-                replicator->archiveRedoQueue.push(parser);
+                replicator->archAddFile(mappedPath + "/" + ent->d_name + "/" + ent2->d_name, ent2->d_name);
             }
             closedir(dir2);
 
@@ -562,12 +832,14 @@ namespace OpenLogReplicator {
                         break;
                     --j;
                 }
-                uint64_t sequence = getSequenceFromFileName(replicator, fileName + j);
+                uint16_t thread;
+                uint64_t sequence = getSequenceFromFileName(replicator, fileName + j, thread);
 
                 if (unlikely(replicator->ctx->trace & Ctx::TRACE_ARCHIVE_LIST))
-                    replicator->ctx->OLR_TRACE(Ctx::TRACE_ARCHIVE_LIST, "found seq: " + std::to_string(sequence));
+                    replicator->ctx->OLR_TRACE(Ctx::TRACE_ARCHIVE_LIST, "found seq: " + std::to_string(sequence) + ", thread: " +
+                                                                       std::to_string(thread));
 
-                if (sequence == 0 || sequence < replicator->metadata->sequence)
+                if (sequence == 0 || sequence < replicator->metadata->getThreadSequence(thread))
                     continue;
 
                 auto parser = new Parser(replicator->ctx, replicator->builder, replicator->metadata,
@@ -575,6 +847,7 @@ namespace OpenLogReplicator {
                 parser->firstScn = Ctx::ZERO_SCN;
                 parser->nextScn = Ctx::ZERO_SCN;
                 parser->sequence = sequence;
+                parser->thread = thread;
                 replicator->archiveRedoQueue.push(parser);
                 if (sequenceStart == Ctx::ZERO_SEQ || sequenceStart > sequence)
                     sequenceStart = sequence;
@@ -594,12 +867,14 @@ namespace OpenLogReplicator {
                     if (unlikely(replicator->ctx->trace & Ctx::TRACE_ARCHIVE_LIST))
                         replicator->ctx->OLR_TRACE(Ctx::TRACE_ARCHIVE_LIST, "checking path: " + fileName);
 
-                    uint64_t sequence = getSequenceFromFileName(replicator, ent->d_name);
+                    uint16_t thread;
+                    uint64_t sequence = getSequenceFromFileName(replicator, ent->d_name, thread);
 
                     if (unlikely(replicator->ctx->trace & Ctx::TRACE_ARCHIVE_LIST))
-                        replicator->ctx->OLR_TRACE(Ctx::TRACE_ARCHIVE_LIST, "found seq: " + std::to_string(sequence));
+                        replicator->ctx->OLR_TRACE(Ctx::TRACE_ARCHIVE_LIST, "found seq: " + std::to_string(sequence) + ", thread: " +
+                                                                           std::to_string(thread));
 
-                    if (sequence == 0 || sequence < replicator->metadata->sequence)
+                    if (sequence == 0 || sequence < replicator->metadata->getThreadSequence(thread))
                         continue;
 
                     auto parser = new Parser(replicator->ctx, replicator->builder, replicator->metadata,
@@ -607,6 +882,7 @@ namespace OpenLogReplicator {
                     parser->firstScn = Ctx::ZERO_SCN;
                     parser->nextScn = Ctx::ZERO_SCN;
                     parser->sequence = sequence;
+                    parser->thread = thread;
                     replicator->archiveRedoQueue.push(parser);
                 }
                 closedir(dir);
@@ -619,7 +895,9 @@ namespace OpenLogReplicator {
     }
 
     bool parserCompare::operator()(const Parser* const p1, const Parser* const p2) {
-        return p1->sequence > p2->sequence;
+        if (p1->sequence != p2->sequence)
+            return p1->sequence > p2->sequence;
+        return p1->thread > p2->thread;
     }
 
     void Replicator::updateResetlogs() {
@@ -641,6 +919,8 @@ namespace OpenLogReplicator {
                 metadata->setResetlogs(oi->resetlogs);
                 metadata->sequence = 0;
                 metadata->offset = 0;
+                if (archWatcher != nullptr)
+                    archWatcher->requestRescan();
                 return;
             }
         }
@@ -677,6 +957,10 @@ namespace OpenLogReplicator {
 
         ctx->OLR_INFO(0, "Oracle Replicator for " + database + " in " + getModeName() + " mode is starting" + flagsStr + " from " + starting +
                      startingSeq);
+
+        if (BlockChSum::getRejectedKernelName() != nullptr)
+            ctx->OLR_WARN(70012, "block checksum " + std::string(BlockChSum::getRejectedKernelName()) + " results differ from scalar, using " +
+                          std::string(BlockChSum::getKernelName()));
     }
 
     bool Replicator::processArchivedRedoLogs() {
@@ -694,7 +978,7 @@ namespace OpenLogReplicator {
                     if (unlikely(ctx->trace & Ctx::TRACE_ARCHIVE_LIST))
                         ctx->OLR_TRACE(Ctx::TRACE_ARCHIVE_LIST, "archived redo log missing for seq: " + std::to_string(metadata->sequence) +
                                                                ", sleeping");
-                    usleep(ctx->archReadSleepUs);
+                    archWait(ctx->archReadSleepUs);
                 } else {
                     break;
                 }
@@ -726,7 +1010,7 @@ namespace OpenLogReplicator {
                 } else if (parser->sequence > metadata->sequence) {
                     ctx->OLR_WARN(60027, "couldn't find archive log for seq: " + std::to_string(metadata->sequence) + ", found: " +
                                         std::to_string(parser->sequence) + ", sleeping " + std::to_string(ctx->archReadSleepUs) + " us");
-                    usleep(ctx->archReadSleepUs);
+                    archWait(ctx->archReadSleepUs);
                     cleanArchList();
                     archGetLog(this);
                     continue;
@@ -734,6 +1018,7 @@ namespace OpenLogReplicator {
 
                 logsProcessed = true;
                 parser->reader = archReader;
+                archPrefetchSchedule();
 
                 archReader->fileName = parser->path;
                 uint64_t retry = ctx->archReadTries;
@@ -753,6 +1038,7 @@ namespace OpenLogReplicator {
                     --retry;
                 }
 
+                decodersAttach(parser);
                 ret = parser->parse();
                 metadata->firstScn = parser->firstScn;
                 metadata->nextScn = parser->nextScn;
@@ -789,6 +1075,9 @@ namespace OpenLogReplicator {
                 break;
         }
 
+        if (archPrefetcher != nullptr)
+            archPrefetcher->schedule({});
+
         return logsProcessed;
     }
 
@@ -858,6 +1147,7 @@ namespace OpenLogReplicator {
                 break;
             logsProcessed = true;
 
+            decodersAttach(parser);
             uint64_t ret = parser->parse();
             metadata->setFirstNextScn(parser->firstScn, parser->nextScn);
 
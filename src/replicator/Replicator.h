@@ -32,14 +32,19 @@ along with OpenLogReplicator; see the file LICENSE;  If not see
 #define REPLICATOR_H_
 
 namespace OpenLogReplicator {
+    class ArchivePrefetcher;
+    class ArchiveWatcher;
+    class LwnDecoder;
     class Parser;
     class Builder;
+    class FormatWorker;
     class Metadata;
     class Reader;
     class RedoLogRecord;
     class State;
     class Transaction;
     class TransactionBuffer;
+    class TransactionFlusher;
 
     struct parserCompare {
         bool operator()(const Parser* const p1, const Parser* const p2);
@@ -55,17 +60,33 @@ namespace OpenLogReplicator {
         std::string redoCopyPath;
         // Redo log files
         Reader* archReader;
+        ArchivePrefetcher* archPrefetcher;
+        ArchiveWatcher* archWatcher;
         std::string lastCheckedDay;
         std::priority_queue<Parser*, std::vector<Parser*>, parserCompare> archiveRedoQueue;
         std::set<Parser*> onlineRedoSet;
         std::set<Reader*> readers;
+        std::vector<LwnDecoder*> lwnDecoders;
+        TransactionFlusher* flusher;
+        std::vector<Builder*> formatBuilders;
+        std::vector<FormatWorker*> formatWorkers;
         std::vector<std::string> pathMapping;
         std::vector<std::string> redoLogsBatch;
 
         void cleanArchList();
+        void archAddFile(const std::string& fileName, const char* name);
+        void restoreTransactions();
+        void archWait(uint64_t timeUs);
+        void archPrefetchSchedule();
         void updateOnlineLogs();
         void readerDropAll(void);
-        static uint64_t getSequenceFromFileName(Replicator* replicator, const std::string& file);
+        Reader* readerSpawn(int64_t group, const std::string& readerAlias);
+        void decodersCreate();
+        void decodersDrop();
+        void decodersAttach(Parser* parser);
+        void flusherCreate();
+        void flusherDrop();
+        static uint64_t getSequenceFromFileName(Replicator* replicator, const std::string& file, uint16_t& thread);
         virtual const char* getModeName() const;
         virtual bool checkConnection();
         virtual bool continueWithOnline();
@@ -87,13 +108,14 @@ namespace OpenLogReplicator {
         virtual void goStandby();
         void addPathMapping(const char* source, const char* target);
         void addRedoLogsBatch(const char* path);
+        void addFormatBuilder(Builder* formatBuilder);
         static void archGetLogPath(Replicator* replicator);
         static void archGetLogList(Replicator* replicator);
         void applyMapping(std::string& path);
         void updateResetlogs();
         void wakeUp() override;
         void printStartMsg() const;
-        bool processArchivedRedoLogs();
+        virtual bool processArchivedRedoLogs();
         bool processOnlineRedoLogs();
 
         friend class OpenLogReplicator;
@@ -17,18 +17,262 @@ You should have received a copy of the GNU General Public License
 along with OpenLogReplicator; see the file LICENSE;  If not see
 <http://www.gnu.org/licenses/>.  */
 
+#include <map>
+#include <unistd.h>
+
 #include "../common/exception/RuntimeException.h"
 #include "../metadata/Metadata.h"
 #include "../metadata/Schema.h"
+#include "../parser/Parser.h"
+#include "../reader/Reader.h"
+#include "BatchWorker.h"
 #include "ReplicatorBatch.h"
 
 namespace OpenLogReplicator {
     ReplicatorBatch::ReplicatorBatch(Ctx* newCtx, void (* newArchGetLog)(Replicator* replicator), Builder* newBuilder, Metadata* newMetadata,
-                                     TransactionBuffer* newTransactionBuffer, const std::string& newAlias, const char* newDatabase) :
-            Replicator(newCtx, newArchGetLog, newBuilder, newMetadata, newTransactionBuffer, newAlias, newDatabase) {
+                                     TransactionBuffer* newTransactionBuffer, const std::string& newAlias, const char* newDatabase,
+                                     uint64_t newWorkers) :
+            Replicator(newCtx, newArchGetLog, newBuilder, newMetadata, newTransactionBuffer, newAlias, newDatabase),
+            workers(newWorkers) {
+    }
+
+    ReplicatorBatch::~ReplicatorBatch() {
+        redoThreadsDrop();
+        workersDrop();
+    }
+
+    void ReplicatorBatch::workersCreate(uint64_t count) {
+        if (batchWorkers.size() == count)
+            return;
+
+        // Merging of redo threads needs one worker per thread, the sequential mode the configured number
+        workersDrop();
+
+        // Split the read buffer, so that one reader can't starve the others
+        uint64_t bufferSizeMax = (ctx->readBufferMax / count) * Ctx::MEMORY_CHUNK_SIZE;
+        for (uint64_t num = 0; num < count; ++num) {
+            Reader* reader = readerSpawn(0, alias + "-batch-reader-" + std::to_string(num));
+            reader->setBufferSizeMax(bufferSizeMax);
+            auto batchWorker = new BatchWorker(ctx, alias + "-batch-worker-" + std::to_string(num), builder, metadata, transactionBuffer,
+                                               reader);
+            batchWorkers.push_back(batchWorker);
+            ctx->spawnThread(batchWorker);
+        }
+    }
+
+    void ReplicatorBatch::workersDrop() {
+        for (BatchWorker* batchWorker: batchWorkers)
+            batchWorker->stop();
+
+        for (BatchWorker* batchWorker: batchWorkers) {
+            ctx->finishThread(batchWorker);
+
+            Reader* reader = batchWorker->getReader();
+            while (!reader->finished) {
+                reader->wakeUp();
+                usleep(1000);
+            }
+            ctx->finishThread(reader);
+            delete reader;
+            delete batchWorker;
+        }
+        batchWorkers.clear();
+    }
+
+    bool ReplicatorBatch::redoThreadsCreate() {
+        std::map<uint16_t, RedoThread*> redoThreadMap;
+        while (!archiveRedoQueue.empty()) {
+            Parser* parser = archiveRedoQueue.top();
+            archiveRedoQueue.pop();
+
+            RedoThread* redoThread;
+            auto redoThreadMapIt = redoThreadMap.find(parser->thread);
+            if (redoThreadMapIt != redoThreadMap.end()) {
+                redoThread = redoThreadMapIt->second;
+            } else {
+                redoThread = new RedoThread;
+                redoThread->parser = nullptr;
+                redoThread->batchWorker = nullptr;
+                redoThread->lwnGroup = nullptr;
+                redoThread->sequence = parser->sequence;
+                redoThread->offset = 0;
+                redoThread->thread = parser->thread;
+                redoThreadMap.insert_or_assign(parser->thread, redoThread);
+            }
+            // The queue is ordered by sequence
+            redoThread->parsers.push_back(parser);
+        }
+
+        for (auto redoThreadMapIt: redoThreadMap)
+            redoThreads.push_back(redoThreadMapIt.second);
+
+        // A single redo thread is processed as before
+        if (redoThreads.size() > 1 || !metadata->threadPositions.empty())
+            return true;
+
+        for (RedoThread* redoThread: redoThreads) {
+            for (Parser* parser: redoThread->parsers)
+                archiveRedoQueue.push(parser);
+            redoThread->parsers.clear();
+        }
+        redoThreadsDrop();
+        return false;
+    }
+
+    void ReplicatorBatch::redoThreadsDrop() {
+        for (RedoThread* redoThread: redoThreads) {
+            if (redoThread->lwnGroup != nullptr)
+                redoThread->batchWorker->release(redoThread->lwnGroup);
+            if (redoThread->parser != nullptr)
+                delete redoThread->parser;
+            for (Parser* parser: redoThread->parsers)
+                delete parser;
+            delete redoThread;
+        }
+        redoThreads.clear();
+    }
+
+    void ReplicatorBatch::redoThreadNext(RedoThread* redoThread) {
+        // Finish the redo log being replayed
+        if (redoThread->parser != nullptr) {
+            Parser* parser = redoThread->parser;
+            uint64_t ret = parser->replayEnd(redoThread->batchWorker);
+            metadata->firstScn = parser->firstScn;
+            metadata->nextScn = parser->nextScn;
+            redoThread->batchWorker->done();
+            redoThread->parser = nullptr;
+            delete parser;
+
+            if (ctx->softShutdown || ret == Reader::REDO_STOPPED)
+                return;
+
+            if (ret != Reader::REDO_FINISHED)
+                throw RuntimeException(10047, "archive log processing returned: " + std::string(Reader::REDO_CODE[ret]) + ", code: " +
+                                              std::to_string(ret));
+
+            ++redoThread->sequence;
+            redoThread->offset = 0;
+            {
+                // The oldest open transaction of the thread stays the same
+                std::unique_lock<std::mutex> lck(metadata->mtxCheckpoint);
+                auto checkpointThreadPositionsIt = metadata->checkpointThreadPositions.find(redoThread->thread);
+                if (checkpointThreadPositionsIt != metadata->checkpointThreadPositions.end()) {
+                    checkpointThreadPositionsIt->second.sequence = redoThread->sequence;
+                    checkpointThreadPositionsIt->second.offset = 0;
+                }
+            }
+
+            if (ctx->stopLogSwitches > 0) {
+                --ctx->stopLogSwitches;
+                if (ctx->stopLogSwitches == 0) {
+                    ctx->OLR_INFO(0, "shutdown started - exhausted number of log switches");
+                    ctx->stopSoft();
+                    return;
+                }
+            }
+        }
+
+        // Open the next redo log of the thread
+        while (!redoThread->parsers.empty()) {
+            Parser* parser = redoThread->parsers.front();
+
+            // Skip older archived redo logs and duplicates
+            if (parser->sequence < redoThread->sequence) {
+                redoThread->parsers.pop_front();
+                delete parser;
+                continue;
+            }
+
+            if (parser->sequence > redoThread->sequence) {
+                ctx->OLR_WARN(60039, "couldn't find archive log for thread: " + std::to_string(redoThread->thread) + ", seq: " +
+                                     std::to_string(redoThread->sequence) + ", found: " + std::to_string(parser->sequence) +
+                                     ", thread is not processed further");
+                return;
+            }
+
+            redoThread->parsers.pop_front();
+            metadata->setSeqOffset(redoThread->sequence, redoThread->offset);
+            redoThread->batchWorker->schedule(parser->path, redoThread->offset);
+            parser->reader = redoThread->batchWorker->waitOpened();
+            if (parser->reader == nullptr) {
+                delete parser;
+                return;
+            }
+
+            if (parser->reader->getThread() != redoThread->thread) {
+                uint16_t readerThread = parser->reader->getThread();
+                delete parser;
+                throw RuntimeException(10077, "file: " + redoThread->batchWorker->getReader()->fileName + " - redo thread: " +
+                                              std::to_string(readerThread) + " does not match thread from file name: " +
+                                              std::to_string(redoThread->thread));
+            }
+
+            decodersAttach(parser);
+            parser->mergeThreads = true;
+            parser->replayBegin();
+            redoThread->parser = parser;
+            return;
+        }
     }
 
-    ReplicatorBatch::~ReplicatorBatch() = default;
+    bool ReplicatorBatch::processRedoThreads() {
+        workersCreate(redoThreads.size());
+
+        {
+            std::unique_lock<std::mutex> lck(metadata->mtxCheckpoint);
+            for (RedoThread* redoThread: redoThreads) {
+                // Continue from the checkpoint, new threads from the first redo log
+                auto threadPositionsIt = metadata->threadPositions.find(redoThread->thread);
+                if (threadPositionsIt != metadata->threadPositions.end()) {
+                    redoThread->sequence = threadPositionsIt->second.first;
+                    redoThread->offset = threadPositionsIt->second.second;
+                }
+                metadata->checkpointThreadPositions.insert_or_assign(redoThread->thread, ThreadPosition{redoThread->sequence, redoThread->offset,
+                                                                                                        Ctx::ZERO_SEQ, 0, typeXid()});
+            }
+        }
+
+        ctx->OLR_INFO(0, "merging redo threads: " + std::to_string(redoThreads.size()));
+        for (uint64_t num = 0; num < redoThreads.size(); ++num) {
+            redoThreads[num]->batchWorker = batchWorkers[num];
+            redoThreadNext(redoThreads[num]);
+        }
+
+        // Apply the LWNs of all threads in SCN order, the lower thread goes first for equal SCNs
+        bool logsProcessed = false;
+        while (!ctx->softShutdown) {
+            RedoThread* redoThreadMin = nullptr;
+            for (RedoThread* redoThread: redoThreads) {
+                while (redoThread->parser != nullptr && redoThread->lwnGroup == nullptr && !ctx->softShutdown) {
+                    redoThread->lwnGroup = redoThread->batchWorker->pop();
+                    if (redoThread->lwnGroup == nullptr)
+                        redoThreadNext(redoThread);
+                }
+
+                if (redoThread->lwnGroup != nullptr && (redoThreadMin == nullptr || redoThread->lwnGroup->scn < redoThreadMin->lwnGroup->scn))
+                    redoThreadMin = redoThread;
+            }
+
+            if (redoThreadMin == nullptr)
+                break;
+
+            logsProcessed = true;
+            redoThreadMin->parser->replayLwn(redoThreadMin->lwnGroup);
+            redoThreadMin->batchWorker->release(redoThreadMin->lwnGroup);
+            redoThreadMin->lwnGroup = nullptr;
+        }
+
+        for (RedoThread* redoThread: redoThreads) {
+            if (redoThread->lwnGroup != nullptr) {
+                redoThread->batchWorker->release(redoThread->lwnGroup);
+                redoThread->lwnGroup = nullptr;
+            }
+            if (redoThread->parser != nullptr)
+                redoThreadNext(redoThread);
+        }
+        redoThreadsDrop();
+        return logsProcessed;
+    }
 
     void ReplicatorBatch::positionReader() {
         if (metadata->startSequence != Ctx::ZERO_SEQ)
@@ -53,6 +297,140 @@ namespace OpenLogReplicator {
         // No need to update online redo log data in batch mode
     }
 
+    bool ReplicatorBatch::processArchivedRedoLogs() {
+        // Dump of redo logs needs the files to be read one by one
+        if (ctx->dumpRedoLog > 0)
+            return Replicator::processArchivedRedoLogs();
+
+        // Redo logs of more RAC instances are merged
+        updateResetlogs();
+        archGetLog(this);
+        if (redoThreadsCreate())
+            return processRedoThreads();
+
+        if (workers <= 1)
+            return Replicator::processArchivedRedoLogs();
+
+        uint64_t ret;
+        bool logsProcessed = false;
+
+        while (!ctx->softShutdown) {
+            if (unlikely(ctx->trace & Ctx::TRACE_REDO))
+                ctx->OLR_TRACE(Ctx::TRACE_REDO, "checking archived redo logs, seq: " + std::to_string(metadata->sequence));
+            updateResetlogs();
+            archGetLog(this);
+
+            if (archiveRedoQueue.empty()) {
+                if (ctx->isFlagSet(Ctx::REDO_FLAGS_ARCH_ONLY)) {
+                    if (unlikely(ctx->trace & Ctx::TRACE_ARCHIVE_LIST))
+                        ctx->OLR_TRACE(Ctx::TRACE_ARCHIVE_LIST, "archived redo log missing for seq: " + std::to_string(metadata->sequence) +
+                                                               ", sleeping");
+                    archWait(ctx->archReadSleepUs);
+                } else {
+                    break;
+                }
+            }
+
+            // Take all files with consecutive sequences
+            std::vector<Parser*> parsers;
+            while (!archiveRedoQueue.empty()) {
+                Parser* parser = archiveRedoQueue.top();
+
+                if (unlikely(ctx->trace & Ctx::TRACE_REDO))
+                    ctx->OLR_TRACE(Ctx::TRACE_REDO, parser->path + " is seq: " + std::to_string(parser->sequence) + ", scn: " +
+                                                   std::to_string(parser->firstScn));
+
+                // When no metadata exists start processing from first file
+                if (metadata->sequence == 0) {
+                    std::unique_lock<std::mutex> lck(metadata->mtxCheckpoint);
+                    metadata->sequence = parser->sequence;
+                }
+
+                // Skip older archived redo logs and duplicates
+                if (parser->sequence < metadata->sequence + parsers.size()) {
+                    archiveRedoQueue.pop();
+                    delete parser;
+                    continue;
+                } else if (parser->sequence > metadata->sequence + parsers.size())
+                    break;
+
+                archiveRedoQueue.pop();
+                parsers.push_back(parser);
+            }
+
+            if (parsers.empty()) {
+                if (archiveRedoQueue.empty()) {
+                    if (!logsProcessed)
+                        break;
+                    continue;
+                }
+
+                ctx->OLR_WARN(60027, "couldn't find archive log for seq: " + std::to_string(metadata->sequence) + ", found: " +
+                                    std::to_string(archiveRedoQueue.top()->sequence) + ", sleeping " + std::to_string(ctx->archReadSleepUs) +
+                                    " us");
+                archWait(ctx->archReadSleepUs);
+                cleanArchList();
+                continue;
+            }
+
+            logsProcessed = true;
+            workersCreate(workers);
+
+            // Files are read ahead by the workers, records are analyzed in sequence order by this thread
+            uint64_t scheduled = 0;
+            uint64_t num = 0;
+            for (; num < parsers.size() && !ctx->softShutdown; ++num) {
+                for (; scheduled < parsers.size() && scheduled < num + workers; ++scheduled)
+                    batchWorkers[scheduled % workers]->schedule(parsers[scheduled]->path, scheduled == 0 ? metadata->offset : 0);
+
+                Parser* parser = parsers[num];
+                BatchWorker* batchWorker = batchWorkers[num % workers];
+                parser->reader = batchWorker->waitOpened();
+                if (parser->reader == nullptr)
+                    break;
+
+                decodersAttach(parser);
+                ret = parser->replay(batchWorker);
+                metadata->firstScn = parser->firstScn;
+                metadata->nextScn = parser->nextScn;
+                batchWorker->done();
+
+                if (ctx->softShutdown)
+                    break;
+
+                if (ret != Reader::REDO_FINISHED) {
+                    if (ret == Reader::REDO_STOPPED) {
+                        delete parser;
+                        parsers[num++] = nullptr;
+                        break;
+                    }
+                    throw RuntimeException(10047, "archive log processing returned: " + std::string(Reader::REDO_CODE[ret]) + ", code: " +
+                                                  std::to_string(ret));
+                }
+
+                ++metadata->sequence;
+                delete parser;
+                parsers[num] = nullptr;
+
+                if (ctx->stopLogSwitches > 0) {
+                    --ctx->stopLogSwitches;
+                    if (ctx->stopLogSwitches == 0) {
+                        ctx->OLR_INFO(0, "shutdown started - exhausted number of log switches");
+                        ctx->stopSoft();
+                    }
+                }
+            }
+
+            // Files read ahead are processed again later
+            for (; scheduled > num; --scheduled)
+                batchWorkers[(scheduled - 1) % workers]->done();
+            for (; num < parsers.size(); ++num)
+                archiveRedoQueue.push(parsers[num]);
+        }
+
+        return logsProcessed;
+    }
+
     const char* ReplicatorBatch::getModeName() const {
         return "batch";
     }
@@ -17,23 +17,53 @@ You should have received a copy of the GNU General Public License
 along with OpenLogReplicator; see the file LICENSE;  If not see
 <http://www.gnu.org/licenses/>.  */
 
+#include <deque>
+#include <vector>
+
 #include "Replicator.h"
 
 #ifndef REPLICATOR_BATCH_H_
 #define REPLICATOR_BATCH_H_
 
 namespace OpenLogReplicator {
+    class BatchWorker;
+    struct LwnGroup;
+
+    /*
+        Redo Thread - archived redo logs of one RAC instance, replayed by own worker and merged by LWN SCN.
+    */
+    struct RedoThread {
+        std::deque<Parser*> parsers;
+        Parser* parser;
+        BatchWorker* batchWorker;
+        LwnGroup* lwnGroup;
+        typeSeq sequence;
+        uint64_t offset;
+        uint16_t thread;
+    };
+
     class ReplicatorBatch final : public Replicator {
     protected:
+        uint64_t workers;
+        std::vector<BatchWorker*> batchWorkers;
+        std::vector<RedoThread*> redoThreads;
+
+        void workersCreate(uint64_t count);
+        void workersDrop();
+        bool redoThreadsCreate();
+        void redoThreadsDrop();
+        void redoThreadNext(RedoThread* redoThread);
+        bool processRedoThreads();
         const char* getModeName() const override;
         bool continueWithOnline() override;
         void positionReader() override;
         void createSchema() override;
         virtual void updateOnlineRedoLogData() override;
+        bool processArchivedRedoLogs() override;
 
     public:
         ReplicatorBatch(Ctx* newCtx, void (* newArchGetLog)(Replicator* replicator), Builder* newBuilder, Metadata* newMetadata,
-                        TransactionBuffer* newTransactionBuffer, const std::string& newAlias, const char* newDatabase);
+                        TransactionBuffer* newTransactionBuffer, const std::string& newAlias, const char* newDatabase, uint64_t newWorkers);
         ~ReplicatorBatch() override;
     };
 }
@@ -17,6 +17,7 @@ You should have received a copy of the GNU General Public License
 along with OpenLogReplicator; see the file LICENSE;  If not see
 <http://www.gnu.org/licenses/>.  */
 
+#include <iosfwd>
 #include <set>
 
 #include "../common/types.h"
@@ -41,6 +42,11 @@ namespace OpenLogReplicator {
         [[nodiscard]] virtual bool read(const std::string& name, uint64_t maxSize, std::string& in) = 0;
         virtual void write(const std::string& name, typeScn scn, const std::ostringstream& out) = 0;
         virtual void drop(const std::string& name) = 0;
+
+        // Binary data stored next to the element, the returned stream is deleted by the caller
+        [[nodiscard]] virtual std::istream* readData(const std::string& name) = 0;
+        [[nodiscard]] virtual std::ostream* writeData(const std::string& name) = 0;
+        virtual void dropData(const std::string& name) = 0;
     };
 }
 
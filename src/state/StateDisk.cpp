@@ -111,4 +111,30 @@ namespace OpenLogReplicator {
         if (unlink(fileName.c_str()) != 0)
             throw RuntimeException(10010, "file: " + fileName + " - delete returned: " + strerror(errno));
     }
+
+    std::istream* StateDisk::readData(const std::string& name) {
+        std::string fileName(path + "/" + name + ".bin");
+        auto inputStream = new std::ifstream(fileName.c_str(), std::ios::in | std::ios::binary);
+        if (!inputStream->is_open()) {
+            delete inputStream;
+            throw RuntimeException(10001, "file: " + fileName + " - open for read returned: " + strerror(errno));
+        }
+        return inputStream;
+    }
+
+    std::ostream* StateDisk::writeData(const std::string& name) {
+        std::string fileName(path + "/" + name + ".bin");
+        auto outputStream = new std::ofstream(fileName.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!outputStream->is_open()) {
+            delete outputStream;
+            throw RuntimeException(10006, "file: " + fileName + " - open for write returned: " + strerror(errno));
+        }
+        return outputStream;
+    }
+
+    void StateDisk::dropData(const std::string& name) {
+        std::string fileName(path + "/" + name + ".bin");
+        if (unlink(fileName.c_str()) != 0 && errno != ENOENT)
+            throw RuntimeException(10010, "file: " + fileName + " - delete returned: " + strerror(errno));
+    }
 }
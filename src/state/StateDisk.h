@@ -35,6 +35,9 @@ namespace OpenLogReplicator {
         [[nodiscard]] bool read(const std::string& name, uint64_t maxSize, std::string& in) override;
         void write(const std::string& name, typeScn scn, const std::ostringstream& out) override;
         void drop(const std::string& name) override;
+        [[nodiscard]] std::istream* readData(const std::string& name) override;
+        [[nodiscard]] std::ostream* writeData(const std::string& name) override;
+        void dropData(const std::string& name) override;
     };
 }
 